@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "concurrent_table.h"
+#include "hash_table.h"
+
+/* compares the throughput of `struct concurrent_table` with a `struct hash_table` guarded by a single mutex. each
+ * thread runs a mix of 90% lookups and 10% writes over a shared range of keys */
+
+#define KEY_RANGE (1 << 16)
+#define OPS_PER_THREAD 1000000
+#define WRITE_PERCENT 10
+
+static int cmpr(void const *left, void const *right) {
+  size_t const *l = left;
+  size_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+struct locked_table {
+  pthread_mutex_t lock;
+  struct hash_table table;
+};
+
+struct worker_args {
+  void *table;
+  unsigned seed;
+};
+
+/* a small xorshift generator. rand() isn't required to be thread safe */
+static unsigned next_random(unsigned *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static void *concurrent_worker(void *arg) {
+  struct worker_args *args = arg;
+  struct concurrent_table *table = args->table;
+
+  for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+    unsigned r = next_random(&args->seed);
+    size_t key = r % KEY_RANGE;
+    size_t value = i;
+
+    if ((r >> 20) % 100 < WRITE_PERCENT) {
+      concurrent_table_put(table, &key, &value, NULL);
+    } else {
+      concurrent_table_get(table, &key, &value);
+    }
+  }
+
+  return NULL;
+}
+
+static void *locked_worker(void *arg) {
+  struct worker_args *args = arg;
+  struct locked_table *locked = args->table;
+
+  for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+    unsigned r = next_random(&args->seed);
+    size_t key = r % KEY_RANGE;
+    size_t value = i;
+
+    pthread_mutex_lock(&locked->lock);
+    if ((r >> 20) % 100 < WRITE_PERCENT) {
+      table_put(&locked->table, &key, &value, NULL);
+    } else {
+      table_get(&locked->table, &key, &value);
+    }
+    pthread_mutex_unlock(&locked->lock);
+  }
+
+  return NULL;
+}
+
+/* used internally to run `worker` on `n_threads` threads and get the throughput in operations per second */
+static double run(void *(*worker)(void *), void *table, size_t n_threads) {
+  pthread_t *threads = malloc(n_threads * sizeof *threads);
+  struct worker_args *args = malloc(n_threads * sizeof *args);
+  if (!threads || !args) {
+    free(threads);
+    free(args);
+    return 0;
+  }
+
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+
+  for (size_t i = 0; i < n_threads; i++) {
+    args[i] = (struct worker_args){.table = table, .seed = (unsigned)(i * 2654435761u + 1)};
+    pthread_create(&threads[i], NULL, worker, &args[i]);
+  }
+  for (size_t i = 0; i < n_threads; i++) { pthread_join(threads[i], NULL); }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  free(threads);
+  free(args);
+
+  double seconds = (double)(end.tv_sec - begin.tv_sec) + (double)(end.tv_nsec - begin.tv_nsec) / 1e9;
+  return (double)(n_threads * OPS_PER_THREAD) / seconds;
+}
+
+int main(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cpus > 0 ? (size_t)cpus : 1;
+
+  printf("%8s %20s %20s\n", "threads", "concurrent ops/s", "mutex ops/s");
+  for (size_t n_threads = 1; n_threads <= max_threads;) {
+    struct concurrent_table concurrent = concurrent_table_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL);
+    struct locked_table locked = {.table = table_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL)};
+    pthread_mutex_init(&locked.lock, NULL);
+
+    double concurrent_ops = run(concurrent_worker, &concurrent, n_threads);
+    double locked_ops = run(locked_worker, &locked, n_threads);
+    printf("%8zu %20.0f %20.0f\n", n_threads, concurrent_ops, locked_ops);
+
+    pthread_mutex_destroy(&locked.lock);
+    table_destroy(&locked.table);
+    concurrent_table_destroy(&concurrent);
+
+    // always measure the full thread count as well
+    if (n_threads == max_threads) break;
+    n_threads = n_threads << 1 > max_threads ? max_threads : n_threads << 1;
+  }
+}
@@ -0,0 +1,100 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "hash_table.h"
+#include "int_map.h"
+
+/* compares the throughput of `struct int_map` with `struct hash_table` (the chained and the open addressing engines,
+ * with the default hash) on `uint64_t -> uint64_t` mappings: filling, looking up (all hits, then all misses) and
+ * emptying each of them */
+
+#define KEYS (1 << 20)
+
+static int cmpr(void const *left, void const *right) {
+  uint64_t const *l = left;
+  uint64_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+/* used internally to spread the keys, so that neither map sees them in order */
+static uint64_t key_of(uint64_t i) {
+  return i * 0x9e3779b97f4a7c15ull;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* the phases of a run, in order */
+enum phase { PHASE_PUT, PHASE_HIT, PHASE_MISS, PHASE_REMOVE, PHASE_COUNT };
+
+static char const *const PHASES[PHASE_COUNT] = {"put", "get (hit)", "get (miss)", "remove"};
+
+static uint64_t sink;
+
+/* used internally to run every phase over a `struct hash_table`, and get the time each of them took */
+static void run_table(enum table_engine engine, double *seconds) {
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(uint64_t), sizeof(uint64_t), cmpr, NULL, NULL, NULL, &options);
+  uint64_t value = 0;
+
+  double begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { table_put(&table, &(uint64_t){key_of(i)}, &i, NULL); }
+  seconds[PHASE_PUT] = now() - begin;
+
+  for (int miss = 0; miss <= 1; miss++) {
+    begin = now();
+    for (uint64_t i = 0; i < KEYS; i++) {
+      if (table_get(&table, &(uint64_t){key_of(i) + (uint64_t)miss}, &value) == DS_VALUE_OK) sink += value;
+    }
+    seconds[PHASE_HIT + miss] = now() - begin;
+  }
+
+  begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { table_remove(&table, &(uint64_t){key_of(i)}, NULL); }
+  seconds[PHASE_REMOVE] = now() - begin;
+
+  table_destroy(&table);
+}
+
+static void run_int_map(double *seconds) {
+  struct int_map map = int_map_create(sizeof(uint64_t), UINT64_MAX);
+  uint64_t value = 0;
+
+  double begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { int_map_put(&map, key_of(i), &i, NULL); }
+  seconds[PHASE_PUT] = now() - begin;
+
+  for (int miss = 0; miss <= 1; miss++) {
+    begin = now();
+    for (uint64_t i = 0; i < KEYS; i++) {
+      if (int_map_get(&map, key_of(i) + (uint64_t)miss, &value) == DS_VALUE_OK) sink += value;
+    }
+    seconds[PHASE_HIT + miss] = now() - begin;
+  }
+
+  begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { int_map_remove(&map, key_of(i), NULL); }
+  seconds[PHASE_REMOVE] = now() - begin;
+
+  int_map_destroy(&map);
+}
+
+int main(void) {
+  double chained[PHASE_COUNT], open[PHASE_COUNT], ints[PHASE_COUNT];
+  run_table(TABLE_CHAINED, chained);
+  run_table(TABLE_OPEN_ADDRESSING, open);
+  run_int_map(ints);
+
+  printf("%10s %16s %16s %16s\n", "ns/op", "chained", "open addressing", "int_map");
+  for (int p = 0; p < PHASE_COUNT; p++) {
+    printf("%10s %16.1f %16.1f %16.1f\n", PHASES[p], chained[p] * 1e9 / KEYS, open[p] * 1e9 / KEYS,
+           ints[p] * 1e9 / KEYS);
+  }
+  printf("(checksum %llu)\n", (unsigned long long)sink);
+}
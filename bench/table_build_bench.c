@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hash_table.h"
+
+/* compares building a chained `uint64_t -> uint64_t` table out of arrays of records one `table_put` at a time with
+ * `table_from_arrays`, on the calling thread alone and on several threads. each build is timed a few times and the
+ * best time is reported, as the first build after a table was destroyed also pays for the memory it returned */
+
+#define KEYS (1 << 22)
+#define RUNS 3
+
+static int cmpr(void const *left, void const *right) {
+  uint64_t const *l = left;
+  uint64_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t sink;
+
+/* used internally to look every key up, so that a build can't be told apart by a broken table */
+static void check(struct hash_table *table, uint64_t const *keys) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < KEYS; i += 64) {
+    if (table_get(table, &keys[i], &value) == DS_VALUE_OK) sink += value;
+  }
+  sink += table_size(table);
+}
+
+static double run_puts(uint64_t const *keys, uint64_t const *values) {
+  double begin = now();
+  struct hash_table table = table_create(sizeof(uint64_t), sizeof(uint64_t), cmpr, NULL, NULL, NULL);
+  for (size_t i = 0; i < KEYS; i++) { table_put(&table, &keys[i], &values[i], NULL); }
+  double seconds = now() - begin;
+
+  check(&table, keys);
+  table_destroy(&table);
+  return seconds;
+}
+
+static double run_from_arrays(uint64_t const *keys, uint64_t const *values, size_t threads) {
+  double begin = now();
+  struct hash_table table = table_from_arrays(keys, values, KEYS, sizeof(uint64_t), sizeof(uint64_t), cmpr, NULL, NULL,
+                                              NULL, NULL, threads);
+  double seconds = now() - begin;
+
+  check(&table, keys);
+  table_destroy(&table);
+  return seconds;
+}
+
+int main(void) {
+  uint64_t *keys = malloc(KEYS * sizeof *keys);
+  uint64_t *values = malloc(KEYS * sizeof *values);
+  if (!keys || !values) return 1;
+
+  for (uint64_t i = 0; i < KEYS; i++) {
+    keys[i] = i * 0x9e3779b97f4a7c15ull;
+    values[i] = i;
+  }
+
+  printf("%24s %10s\n", "build of 4M records", "ms");
+  double best = run_puts(keys, values);
+  for (int r = 1; r < RUNS; r++) {
+    double seconds = run_puts(keys, values);
+    if (seconds < best) best = seconds;
+  }
+  printf("%24s %10.1f\n", "table_put", best * 1e3);
+
+  size_t threads[] = {1, 2, 4, 8};
+  for (size_t t = 0; t < sizeof threads / sizeof *threads; t++) {
+    best = run_from_arrays(keys, values, threads[t]);
+    for (int r = 1; r < RUNS; r++) {
+      double seconds = run_from_arrays(keys, values, threads[t]);
+      if (seconds < best) best = seconds;
+    }
+
+    char label[32];
+    snprintf(label, sizeof label, "table_from_arrays (%zu)", threads[t]);
+    printf("%24s %10.1f\n", label, best * 1e3);
+  }
+  printf("(checksum %llu)\n", (unsigned long long)sink);
+
+  free(keys);
+  free(values);
+}
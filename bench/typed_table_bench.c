@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "hash_table.h"
+#include "hash_table_typed.h"
+
+/* compares a `uint64_t -> uint64_t` table generated by `HASH_TABLE_DEFINE` with a `struct hash_table` using the same
+ * (open addressing) engine. both are filled, then looked up (all hits, then all misses) and emptied */
+
+#define KEYS (1 << 20)
+
+HASH_TABLE_DEFINE(u64_table, uint64_t, uint64_t, typed_table_hash_u64, typed_table_eq_u64)
+
+static int cmpr(void const *left, void const *right) {
+  uint64_t const *l = left;
+  uint64_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+static size_t hash_u64(void const *key, size_t size) {
+  (void)size;
+  return (size_t)*(uint64_t const *)key;
+}
+
+/* used internally to spread the keys, so that neither table sees them in order */
+static uint64_t key_of(uint64_t i) {
+  return i * 0x9e3779b97f4a7c15ull;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void report(char const *phase, double generic, double typed) {
+  printf("%10s %14.1f %14.1f %9.2fx\n", phase, generic * 1e9 / KEYS, typed * 1e9 / KEYS, generic / typed);
+}
+
+int main(void) {
+  struct table_options options = {.engine = TABLE_OPEN_ADDRESSING};
+  struct hash_table generic = table_create_ex(sizeof(uint64_t), sizeof(uint64_t), cmpr, hash_u64, NULL, NULL, &options);
+  struct u64_table typed = u64_table_create(NULL, NULL);
+  uint64_t sink = 0;
+
+  printf("%10s %14s %14s %10s\n", "phase", "generic ns/op", "typed ns/op", "speedup");
+
+  double begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { table_put(&generic, &(uint64_t){key_of(i)}, &i, NULL); }
+  double generic_time = now() - begin;
+
+  begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { u64_table_put(&typed, &(uint64_t){key_of(i)}, &i, NULL); }
+  report("put", generic_time, now() - begin);
+
+  for (int miss = 0; miss <= 1; miss++) {
+    uint64_t value = 0;
+
+    begin = now();
+    for (uint64_t i = 0; i < KEYS; i++) {
+      if (table_get(&generic, &(uint64_t){key_of(i) + (uint64_t)miss}, &value) == DS_VALUE_OK) sink += value;
+    }
+    generic_time = now() - begin;
+
+    begin = now();
+    for (uint64_t i = 0; i < KEYS; i++) {
+      if (u64_table_get(&typed, &(uint64_t){key_of(i) + (uint64_t)miss}, &value) == DS_VALUE_OK) sink += value;
+    }
+    report(miss ? "get (miss)" : "get (hit)", generic_time, now() - begin);
+  }
+
+  begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { table_remove(&generic, &(uint64_t){key_of(i)}, NULL); }
+  generic_time = now() - begin;
+
+  begin = now();
+  for (uint64_t i = 0; i < KEYS; i++) { u64_table_remove(&typed, &(uint64_t){key_of(i)}, NULL); }
+  report("remove", generic_time, now() - begin);
+
+  printf("(checksum %llu)\n", (unsigned long long)sink);
+
+  table_destroy(&generic);
+  u64_table_destroy(&typed);
+}
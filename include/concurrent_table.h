@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+
+/**
+ * @file concurrent_table.h
+ * @brief the definition of a thread safe hash table
+ *
+ * the table provides the same semantics as `struct hash_table` (see `hash_table.h`), and may be used concurrently by
+ * any number of threads:
+ * - writers (`put` / `remove`) lock one of a fixed number of stripes. writers of keys on different stripes don't contend
+ * - readers (`get` / `contains`) take no lock at all. removed / replaced entries are reclaimed only once every reader
+ * which might still observe them is done (epoch based reclamation). a replaced value is never modified in place, a
+ * reader sees either the old value or the new one
+ * - resizing is cooperative. once a resize starts, every writer migrates a few buckets before carrying on with its own
+ * operation. readers are never blocked by a resize
+ *
+ * since readers may observe a key / value after it was removed, destructors are called on reclamation, not on removal
+ */
+
+struct concurrent_table_state;
+
+struct concurrent_table {
+  size_t _key_size;
+  size_t _value_size;
+  size_t _key_offset;
+  size_t _value_offset;
+  uint64_t _seed;
+
+  struct concurrent_table_state *_state;
+
+  int (*_cmpr)(void const *key, void const *other);
+  size_t (*_hash)(void const *key, size_t size);
+  void (*_destroy_key)(void *key);
+  void (*_destroy_value)(void *value);
+};
+
+/**
+ * @brief creates a concurrent hash table object `map<K, V>`
+ *
+ * @param[in] key_size  the size of every `key` in bytes
+ * @param[in] value_size  the size of every `value` in bytes
+ * @param[in] cmpr  a function comparing `2` keys. see `table_create`. must be safe to call concurrently
+ * @param[in, optional] hash - a function generating a hash from a key. see `table_create`. must be safe to call
+ * concurrently
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @return `struct concurrent_table` concurrent hash table object. the object itself may be copied (e.g. to share it
+ * between threads), however it must be destroyed exactly once
+ */
+struct concurrent_table concurrent_table_create(size_t key_size,
+                                                size_t value_size,
+                                                int (*cmpr)(void const *, void const *),
+                                                size_t (*hash)(void const *hashable, size_t size),
+                                                void (*destroy_key)(void *),
+                                                void (*destroy_value)(void *));
+
+/**
+ * @brief destroys a concurrent table. no other thread may use the table during (or after) its destruction
+ *
+ * @param[in] table the table to destroy. if the table was supplied destructors for its `key` / `value` - the function
+ * will call them for each `key` / `value` pair
+ */
+void concurrent_table_destroy(struct concurrent_table *table);
+
+/**
+ * @brief returns the number of elements in the table. under concurrent modifications the number is a snapshot which
+ * may be stale by the time it's returned
+ *
+ * @param[in] table
+ * @return `size_t` the number of elements the table contains
+ */
+size_t concurrent_table_size(struct concurrent_table const *table);
+
+/**
+ * @brief inserts `new_value` into the table and returns the `old_value` associated with `key` if there was any. see
+ * `table_put`
+ *
+ * @param[in] table
+ * @param[in] key the mapping for `new_value`
+ * @param[in] new_value the value to insert into the table
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it
+ * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
+ * operation succeded & an old value was replaced and put into `old_value`. `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` otherwise
+ */
+enum ds_error concurrent_table_put(struct concurrent_table *restrict table,
+                                   void const *key,
+                                   void const *new_value,
+                                   void *restrict old_value);
+
+/**
+ * @brief removes the mapping for `key`. see `table_remove`
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out, optional] old_value a pointer to the type of `value`. if such pointer isn't `NULL` the old value will be
+ * copied into it (and the caller takes ownership of it). otherwise the value is destroyed once it's reclaimed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_VALUE_OK` if the operation succeded & the old value
+ * was placed into `old_value`. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error concurrent_table_remove(struct concurrent_table *restrict table,
+                                      void const *restrict key,
+                                      void *restrict old_value);
+
+/**
+ * @brief gets the `value` associated with `key` without taking any lock
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out] value a pointer to the type of `value`. the value will be copied into it
+ * @return `enum ds_error` - `DS_VALUE_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such key. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error concurrent_table_get(struct concurrent_table *restrict table,
+                                   void const *restrict key,
+                                   void *restrict value);
+
+/**
+ * @brief checks if the table contains a mapping for the key `key` without taking any lock
+ *
+ * @param table
+ * @param key
+ * @return true if the table contain said key
+ * @return false if the table doesn't contain said key
+ */
+bool concurrent_table_contains(struct concurrent_table *restrict table, void const *restrict key);
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+#include "hash_table.h"
+
+/**
+ * @file expiring_map.h
+ * @brief the definition of a map whose entries expire at a deadline
+ *
+ * the map maps keys to values like `struct hash_table` does (see the notes in `hash_table.h`), while every entry is
+ * given a deadline on insertion. time is an abstract, caller supplied `uint64_t` (e.g. milliseconds since some epoch),
+ * which only moves forward through `expiring_map_advance`. an entry expires once the map's time reaches its deadline.
+ *
+ * the entries are scheduled on a hierarchical timer wheel of `EXPIRING_MAP_LEVELS` levels of `64` slots each. level
+ * `l` slices time into slots of `64^l` units. an entry is placed on the level of the highest `6` bit group in which its
+ * deadline differs from the current time, and moves down a level whenever its slot comes due, until it expires on the
+ * lowest one. advancing the time only visits non empty slots (tracked by a bitmap per level), hence its work is
+ * proportional to the number of entries which expire or move down, never to the number of live entries.
+ *
+ * expiration is also checked lazily: `expiring_map_get` / `expiring_map_contains` are passed the caller's current time
+ * and expire an entry which is due by then, even if the map's time hasn't reached its deadline yet
+ */
+
+#define EXPIRING_MAP_LEVELS 11  // ceil(64 / 6) levels of 64 slots cover every `uint64_t` deadline
+
+struct expiring_timer;
+
+/* construction parameters of `expiring_map_create`. a zero initialized object is the default */
+struct expiring_map_options {
+  // called on every expired entry prior to its destruction. `context` is passed as is. it may not modify the map
+  void (*on_expire)(void const *key, void *value, void *context);
+  void *context;
+};
+
+struct expiring_map {
+  uint64_t _now;
+
+  size_t _key_size;
+  size_t _value_size;
+  size_t _key_offset;  // the offsets of the key / value within a timer
+  size_t _value_offset;
+
+  struct expiring_map_options _options;
+
+  struct hash_table _table;                 // key -> its timer
+  struct expiring_timer **_wheel;           // `EXPIRING_MAP_LEVELS * 64` lists of timers
+  uint64_t _occupied[EXPIRING_MAP_LEVELS];  // a bit per non empty slot of every level
+
+  void (*_destroy_key)(void *);
+  void (*_destroy_value)(void *);
+};
+
+/**
+ * @brief creates an expiring map object `map<K, V>`
+ *
+ * @param[in] key_size the size of every `key` in bytes
+ * @param[in] value_size the size of every `value` in bytes
+ * @param[in] cmpr a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash a function generating a hash from a key. see `table_create`
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @param[in] now the initial time of the map
+ * @param[in, optional] options see `struct expiring_map_options`. `NULL` is the default
+ * @return `struct expiring_map` map object. a zero initialized object if the parameters are invalid
+ */
+struct expiring_map expiring_map_create(size_t key_size,
+                                        size_t value_size,
+                                        int (*cmpr)(void const *, void const *),
+                                        size_t (*hash)(void const *hashable, size_t size),
+                                        void (*destroy_key)(void *),
+                                        void (*destroy_value)(void *),
+                                        uint64_t now,
+                                        struct expiring_map_options const *options);
+
+/**
+ * @brief destroys a map
+ *
+ * @param[in] map the map to destroy. if the map was supplied destructors for its `key` / `value` - the function will
+ * call them for each `key` / `value` pair. `on_expire` isn't called
+ */
+void expiring_map_destroy(struct expiring_map *map);
+
+/**
+ * @brief returns the number of entries in the map, including the ones which are due but weren't expired yet
+ *
+ * @param[in] map
+ * @return `size_t` the number of entries the map contains
+ */
+size_t expiring_map_size(struct expiring_map const *map);
+
+/**
+ * @brief returns the current time of the map
+ *
+ * @param[in] map
+ * @return `uint64_t` the time the map was last advanced to
+ */
+uint64_t expiring_map_now(struct expiring_map const *map);
+
+/**
+ * @brief inserts `new_value` into the map, to expire at `deadline`. if `key` is already mapped its value is replaced
+ * and its entry is rescheduled
+ *
+ * @param[in] map
+ * @param[in] key the mapping for `new_value`
+ * @param[in] new_value the value to insert into the map
+ * @param[in] deadline the time the entry expires at. must be later than the current time of the map
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it. otherwise the
+ * old value is destroyed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
+ * operation succeded & an old value was replaced and put into `old_value`. `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` otherwise, e.g. if the deadline has already passed
+ */
+enum ds_error expiring_map_put(struct expiring_map *restrict map,
+                               void const *key,
+                               void const *new_value,
+                               uint64_t deadline,
+                               void *restrict old_value);
+
+/**
+ * @brief gets the `value` associated with `key`. an entry which is due by `now` is expired instead
+ *
+ * @param[in] map
+ * @param[in] key
+ * @param[in] now the caller's current time. the time of the map is left as is
+ * @param[out] value a pointer to the type of `value`. the value will be copied into it
+ * @return `enum ds_error` - `DS_VALUE_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such key, or if it
+ * has expired. `DS_ERROR` otherwise
+ */
+enum ds_error expiring_map_get(struct expiring_map *restrict map,
+                               void const *restrict key,
+                               uint64_t now,
+                               void *restrict value);
+
+/**
+ * @brief checks if the map contains a live mapping for the key `key`. an entry which is due by `now` is expired instead
+ *
+ * @param map
+ * @param key
+ * @param now the caller's current time. the time of the map is left as is
+ * @return true if the map contain said key
+ * @return false if the map doesn't contain said key
+ */
+bool expiring_map_contains(struct expiring_map *restrict map, void const *restrict key, uint64_t now);
+
+/**
+ * @brief removes the mapping for `key`. `on_expire` isn't called
+ *
+ * @param[in] map
+ * @param[in] key
+ * @param[out, optional] old_value a pointer to the type of `value`. if such pointer isn't `NULL` the old value will be
+ * copied into it. otherwise the value is destroyed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_VALUE_OK` if the operation succeded & the old value
+ * was placed into `old_value`. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error expiring_map_remove(struct expiring_map *restrict map,
+                                  void const *restrict key,
+                                  void *restrict old_value);
+
+/**
+ * @brief advances the time of the map to `now`, expiring every entry whose deadline is at or before it. the work done
+ * is proportional to the number of entries expired (or moved down the wheel), not to the size of the map
+ *
+ * @param[in] map
+ * @param[in] now the new time of the map. a time earlier than the current one is ignored
+ * @return `size_t` the number of entries expired
+ */
+size_t expiring_map_advance(struct expiring_map *map, uint64_t now);
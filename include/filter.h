@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+
+/**
+ * @file filter.h
+ * @brief the definitions of approximate membership filters
+ *
+ * a filter answers whether it may hold a key: `false` is definite, while `true` is wrong with a small probability (a
+ * false positive). the filters don't store keys, merely a few bits of their hashes, hence they're given hashes rather
+ * than keys. any hash will do, e.g. the one `table_hash` computes, as the filters mix it further.
+ *
+ * - `struct bloom_filter` - a blocked (split block) bloom filter. a key sets `8` bits, one in each word of a single
+ * `64` byte block, hence a lookup touches a single cache line. keys can't be removed from it.
+ * - `struct cuckoo_filter` - keeps a `16` bit fingerprint of every key in one of `2` buckets of `4` fingerprints each.
+ * keys can be removed from it (only keys which were added, otherwise another key's fingerprint might be removed), and
+ * its false positive rate is lower than a bloom filter's of the same size. adding fails once the filter is full.
+ *
+ * a `struct hash_table` can own a filter of either kind in front of its lookups. see `table_attach_filter`
+ */
+
+struct bloom_filter {
+  size_t _n_elem;
+  size_t _n_blocks;  // a power of 2
+  uint64_t *_blocks;
+  void *_allocation;  // `_blocks` is aligned within it to a cache line
+};
+
+struct cuckoo_filter {
+  size_t _n_elem;
+  size_t _n_buckets;  // a power of 2
+  uint16_t *_buckets;
+  uint64_t _rng;  // picks the fingerprints kicked out of a full bucket
+
+  // a fingerprint which was kicked out and found no other place. while there's one, the filter is full
+  bool _has_victim;
+  uint16_t _victim;
+  size_t _victim_bucket;
+};
+
+/**
+ * @brief creates a bloom filter object
+ *
+ * @param[in] capacity the number of keys the filter is sized for. more keys may be added, at the cost of a higher
+ * false positive rate
+ * @param[in] bits_per_key the number of bits spent on each key. `0` picks `10` (a false positive rate of about `1%`)
+ * @return `struct bloom_filter` filter object. a zero initialized object on allocation failure
+ */
+struct bloom_filter bloom_filter_create(size_t capacity, size_t bits_per_key);
+
+/**
+ * @brief destroys a bloom filter
+ *
+ * @param[in] filter the filter to destroy
+ */
+void bloom_filter_destroy(struct bloom_filter *filter);
+
+/**
+ * @brief returns the number of hashes added to the filter
+ *
+ * @param[in] filter
+ * @return `size_t` the number of hashes added
+ */
+size_t bloom_filter_size(struct bloom_filter const *filter);
+
+/**
+ * @brief adds a hash to the filter
+ *
+ * @param[in] filter
+ * @param[in] hash the hash of the key
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error bloom_filter_add(struct bloom_filter *filter, size_t hash);
+
+/**
+ * @brief checks if the filter may contain a hash
+ *
+ * @param[in] filter
+ * @param[in] hash the hash of the key
+ * @return true if the hash may have been added to the filter
+ * @return false if the hash definitely wasn't added to the filter
+ */
+bool bloom_filter_contains(struct bloom_filter const *filter, size_t hash);
+
+/**
+ * @brief removes every hash from the filter
+ *
+ * @param[in] filter
+ */
+void bloom_filter_clear(struct bloom_filter *filter);
+
+/**
+ * @brief creates a cuckoo filter object
+ *
+ * @param[in] capacity the number of keys the filter is sized for. the filter may fill up before holding as many
+ * @return `struct cuckoo_filter` filter object. a zero initialized object on allocation failure
+ */
+struct cuckoo_filter cuckoo_filter_create(size_t capacity);
+
+/**
+ * @brief destroys a cuckoo filter
+ *
+ * @param[in] filter the filter to destroy
+ */
+void cuckoo_filter_destroy(struct cuckoo_filter *filter);
+
+/**
+ * @brief returns the number of hashes in the filter
+ *
+ * @param[in] filter
+ * @return `size_t` the number of hashes added and not removed
+ */
+size_t cuckoo_filter_size(struct cuckoo_filter const *filter);
+
+/**
+ * @brief adds a hash to the filter. a hash may be added several times (and is then removed as many times)
+ *
+ * @param[in] filter
+ * @param[in] hash the hash of the key
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` if the filter is full (the filter is left
+ * unchanged) or otherwise
+ */
+enum ds_error cuckoo_filter_add(struct cuckoo_filter *filter, size_t hash);
+
+/**
+ * @brief checks if the filter may contain a hash
+ *
+ * @param[in] filter
+ * @param[in] hash the hash of the key
+ * @return true if the hash may be in the filter
+ * @return false if the hash definitely isn't in the filter
+ */
+bool cuckoo_filter_contains(struct cuckoo_filter const *filter, size_t hash);
+
+/**
+ * @brief removes a hash from the filter. the hash must have been added to the filter
+ *
+ * @param[in] filter
+ * @param[in] hash the hash of the key
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such hash. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error cuckoo_filter_remove(struct cuckoo_filter *filter, size_t hash);
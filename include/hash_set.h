@@ -0,0 +1,139 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "defines.h"
+#include "hash_table.h"
+
+/**
+ * @file hash_set.h
+ * @brief the definition of a hash set
+ *
+ * the set stores _copies_ of the keys passed into it, same as `struct hash_table` (see the notes in `hash_table.h`).
+ * keys are stored inline, densely packed in one flat array of slots (the open addressing engine of the hash table),
+ * with no value storage at all. inserting a key never allocates per key
+ */
+
+struct hash_set {
+  struct hash_table _table;
+};
+
+/**
+ * @brief creates a hash set object `set<K>`
+ *
+ * @param[in] key_size the size of every `key` in bytes
+ * @param[in] cmpr a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash a function generating a hash from a key. see `table_create`
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @return `struct hash_set` hash set object
+ */
+struct hash_set set_create(size_t key_size,
+                           int (*cmpr)(void const *, void const *),
+                           size_t (*hash)(void const *hashable, size_t size),
+                           void (*destroy_key)(void *));
+
+/**
+ * @brief destroys a set
+ *
+ * @param[in] set the set to destroy. if the set was supplied a destructor for its keys - the function will call it for
+ * each key
+ */
+void set_destroy(struct hash_set *set);
+
+/**
+ * @brief returns the number of keys in the set
+ *
+ * @param[in] set
+ * @return `size_t` the number of keys the set contains
+ */
+size_t set_size(struct hash_set const *set);
+
+/**
+ * @brief returns the state of the set
+ *
+ * @param[in] set
+ * @return `true` if there are no keys in the set
+ * @return `false` if there's at least one key in the set
+ */
+bool set_empty(struct hash_set const *set);
+
+/**
+ * @brief inserts `key` into the set
+ *
+ * @param[in] set
+ * @param[in] key the key to insert
+ * @return `enum ds_error` - `DS_OK` if the key was inserted (the set takes ownership of it). `DS_VALUE_OK` if the set
+ * already contains such key (the set doesn't take ownership of `key`). `DS_NO_MEM` on allocation failure. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error set_insert(struct hash_set *restrict set, void const *restrict key);
+
+/**
+ * @brief checks if the set contains `key`
+ *
+ * @param[in] set
+ * @param[in] key
+ * @return `true` if the set contains said key
+ * @return `false` if the set doesn't contain said key
+ */
+bool set_contains(struct hash_set *restrict set, void const *restrict key);
+
+/**
+ * @brief removes `key` from the set. the key stored in the set is destroyed if the set was supplied a destructor
+ *
+ * @param[in] set
+ * @param[in] key
+ * @return `enum ds_error` - `DS_OK` if the key was removed. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error set_remove(struct hash_set *restrict set, void const *restrict key);
+
+/**
+ * @brief adds every key of `other` to `set`. the keys are copied shallowly, hence sets which own their keys (i.e. were
+ * supplied `destroy_key`) can't be united, as both would end up owning the copied keys. both sets must hold the same
+ * type of keys
+ *
+ * @param[in] set the set to add the keys to
+ * @param[in] other
+ * @return `enum ds_error` - `DS_OK` on success. `DS_NO_MEM` on allocation failure, in which case some of the keys may
+ * have been added. `DS_ERROR` if either set owns its keys, or otherwise
+ */
+enum ds_error set_union(struct hash_set *restrict set, struct hash_set *restrict other);
+
+/**
+ * @brief removes every key of `set` which `other` doesn't contain. the removed keys are destroyed
+ *
+ * @param[in] set the set to remove the keys from
+ * @param[in] other
+ * @return `size_t` the number of keys removed
+ */
+size_t set_intersect(struct hash_set *restrict set, struct hash_set *restrict other);
+
+/**
+ * @brief removes every key of `set` which `other` contains as well. the removed keys are destroyed
+ *
+ * @param[in] set the set to remove the keys from
+ * @param[in] other
+ * @return `size_t` the number of keys removed
+ */
+size_t set_difference(struct hash_set *restrict set, struct hash_set *restrict other);
+
+/* iterator related functions. an iterator is a pointer to a key in the set, and is invalidated by any modification of
+ * the set. the iteration order is unspecified */
+
+/**
+ * @brief returns an iterator to the first key of the set
+ *
+ * @param[in] set
+ * @return `void const *` a pointer to the first key. `NULL` if the set is empty or `NULL`
+ */
+void const *set_iter_begin(struct hash_set *set);
+
+/**
+ * @brief advances the iterator to the next key of the set
+ *
+ * @param[in] set the set to iterate over
+ * @param[in] iter a valid iterator
+ * @return `void const *` a pointer to the next key. `NULL` once there are no more keys
+ */
+void const *set_iter_next(struct hash_set *set, void const *iter);
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "defines.h"
 #include "vec.h"
@@ -20,19 +22,207 @@
  * }```
  *
  * storing a ptr into the table means the table take ownership of said ptr
+ *
+ * the table can be backed by one of the following engines (see `table_create_ex`):
+ * - `TABLE_CHAINED` (the default) - each entry is a doubly linked list of heap allocated nodes. each node holds its key
+ * and value inline, right after the links
+ * - `TABLE_OPEN_ADDRESSING` - a swiss table. keys and values are stored inline in one flat array of slots, accompanied
+ * by an array of control bytes (one per slot) holding `7` bits of each key's hash. lookups match `16` control bytes at
+ * a time (using SSE2 where available) and only call `cmpr` on slots whose control byte matches. pointers into the table
+ * storage aren't stable across insertions
+ * - `TABLE_DENSE` - keys and values are stored contiguously in one array, chained through an array of bucket indices.
+ * iterating over the table is a linear scan of said array. removing an element moves the last element into its place,
+ * hence pointers into the table storage aren't stable across insertions nor removals
+ * - `TABLE_ORDERED` - an insertion ordered table, in the spirit of CPython's compact dict. keys and values are appended
+ * to one array of records, which a sparse index of `1`, `2`, `4` or `8` byte slots (as narrow as the capacity allows)
+ * maps hashes into. iterating over the table visits the elements in the order they were inserted. removing an element
+ * leaves a hole in the records which is compacted away later on, hence pointers into the table storage are stable
+ * across removals, not insertions. reinserting a removed key appends it anew
+ * - `TABLE_FROZEN` - a read only minimal perfect hash. a table can't be created as such, but is rather converted into
+ * one by `table_freeze`. see `table_freeze`
+ *
+ * a `TABLE_CHAINED` table may be created as a multimap (see `struct table_options`), which keeps every value put under
+ * a key rather than replacing it. the pairs of a key are linked next to each other, hence its values are a single run
+ * of its entry's list (see `table_get_all`)
+ *
+ * a table of any engine may own an approximate membership filter (see `filter.h`), which every lookup consults before
+ * the table itself. a key the filter rejects is known to be missing without touching the table's storage, which spares
+ * misses the chain walk / probing and the `cmpr` calls. see `table_attach_filter`
+ */
+
+enum table_engine {
+  TABLE_CHAINED,
+  TABLE_OPEN_ADDRESSING,
+  TABLE_DENSE,
+  TABLE_ORDERED,
+  TABLE_FROZEN,
+};
+
+/* the kinds of filters a table may own. see `table_attach_filter` */
+enum table_filter_kind {
+  TABLE_FILTER_NONE,
+  TABLE_FILTER_BLOOM,
+  TABLE_FILTER_CUCKOO,
+};
+
+struct table_filter;
+
+/**
+ * @brief optional construction parameters for `table_create_ex`. a zero initialized object yields the same table
+ * `table_create` does
  */
+struct table_options {
+  enum table_engine engine;
+
+  // the seed of the default hash function. `0` picks a random seed. tables sharing a seed hash keys identically
+  uint64_t seed;
+
+  // `TABLE_CHAINED` only. spread each resize over the following operations instead of relinking all the entries at
+  // once. see `table_rehashing`
+  bool incremental_resize;
+
+  // `TABLE_CHAINED` only. keep every `key / value` pair put into the table, duplicate keys included (a multimap). see
+  // `table_get_all`
+  bool multimap;
+
+  // the number of elements the table can hold before it first resizes. `0` picks a small default
+  size_t initial_capacity;
+
+  // the table grows once `size > capacity * max_load_factor`. `0` picks the engine's default (`0.7` for
+  // `TABLE_CHAINED` / `TABLE_DENSE`, `0.875` for `TABLE_OPEN_ADDRESSING`, `2 / 3` for `TABLE_ORDERED`).
+  // `TABLE_OPEN_ADDRESSING` / `TABLE_ORDERED` require a factor below `1`
+  double max_load_factor;
+
+  // the table shrinks once `size < capacity * min_load_factor`, though never below its initial capacity. `0` (the
+  // default) never shrinks automatically. must be below `max_load_factor / growth_factor`
+  double min_load_factor;
+
+  // the factor the capacity is multiplied by on growth. must be a power of `2`. `0` picks `2`
+  size_t growth_factor;
+};
+
+#ifdef DS_TABLE_STATS
+/* the counters behind `table_stats`. present only when the library is built with DS_TABLE_STATS (the cmake option of
+ * the same name), which must then be defined for every translation unit including this header */
+struct table_counters {
+  size_t _probes;  // examined by the lookup in progress, attributed to its operation once it completes
+  size_t _lookups[3];
+  size_t _lookup_probes[3];
+  size_t _hits;
+  size_t _misses;
+  size_t _resizes;
+  uint64_t _resize_ns;
+};
+#endif
 
 struct hash_table {
   size_t _n_elem;
   size_t _key_size;
   size_t _value_size;
 
+  enum table_engine _engine;
+  uint64_t _seed;
+
+  // TABLE_CHAINED: one `struct entry` per bucket. TABLE_OPEN_ADDRESSING: one slot per bucket. TABLE_DENSE: the index of
+  // the first record of each bucket. TABLE_ORDERED: the sparse index into the records
   struct vec _entries;
 
+  // where the key / value live within a record (a chained node or an open addressing slot)
+  size_t _key_offset;
+  size_t _value_offset;
+
+  // TABLE_CHAINED with incremental resizing only. the previous entries, and how many of them were migrated so far
+  bool _incremental;
+  struct vec _old_entries;
+  size_t _migrated;
+
+  // TABLE_CHAINED only. see `struct table_options`
+  bool _multimap;
+
+  // TABLE_CHAINED built by `table_from_arrays` only. the nodes the table was built with, allocated at once. a node
+  // within the slab isn't freed on its own
+  void *_slab;
+  size_t _slab_size;
+
+  // the filter in front of the lookups, if any. see `table_attach_filter`
+  struct table_filter *_filter;
+
+  // the resize policy. see `struct table_options`. `_growth` is the log2 of the growth factor, and `_min_capacity` the
+  // capacity automatic shrinking stops at
+  double _max_load;
+  double _min_load;
+  size_t _growth;
+  size_t _min_capacity;
+
+  // TABLE_OPEN_ADDRESSING only
+  unsigned char *_ctrl;
+  size_t _n_deleted;
+
+  // TABLE_DENSE / TABLE_ORDERED / TABLE_FROZEN only. the records, contiguously. a frozen table keeps the pilot of each
+  // of its buckets in `_entries`
+  struct vec _records;
+
+  // TABLE_FROZEN opened by `table_open_mapped` only. `_entries` and `_records` are views into the mapping
+  void *_mapping;
+  size_t _mapping_size;
+
   int (*_cmpr)(void const *key, void const *other);
   size_t (*_hash)(void const *key, size_t size);
   void (*_destroy_key)(void *key);
   void (*_destroy_value)(void *value);
+
+#ifdef DS_TABLE_STATS
+  struct table_counters _stats;
+#endif
+};
+
+/* the pairs of a single key, as found by `table_get_all`. see `table_range_next` */
+struct table_range {
+  void *_next;
+  size_t _left;
+};
+
+// the number of chain lengths `struct table_stats` tells apart
+#define TABLE_STATS_CHAINS 16
+
+/**
+ * @brief a report of the table's shape and, when the library is built with DS_TABLE_STATS, of its activity. see
+ * `table_stats`
+ */
+struct table_stats {
+  size_t size;
+  size_t capacity;
+
+  // the bytes the table allocated for its entries / slots / records (including the spare ones), and for its nodes.
+  // allocator overhead isn't included. a mapped table reports the size of its mapping
+  size_t bytes;
+
+  // `chain_lengths[i]` counts the chains of length `i`, the last counter counting every longer chain as well.
+  // `TABLE_CHAINED` / `TABLE_DENSE`: a chain is a bucket and its length the number of elements it holds (empty buckets
+  // are counted at `0`). `TABLE_OPEN_ADDRESSING` / `TABLE_ORDERED`: a chain is the probe sequence of an element and its
+  // length the number of groups (index slots for `TABLE_ORDERED`) a lookup of the element visits. `TABLE_FROZEN`: every
+  // element is found by a single probe
+  size_t chain_lengths[TABLE_STATS_CHAINS];
+  size_t max_chain_length;
+
+  // DS_TABLE_STATS only, `0` otherwise. lookups are counted per operation: gets (`table_get`, `table_get_ref`,
+  // `table_contains`, `table_get_many`), puts (`table_put`, `table_emplace`, `table_put_many` etc) and removes. a probe
+  // is a node / record examined (`TABLE_CHAINED` / `TABLE_DENSE`), a group of slots (`TABLE_OPEN_ADDRESSING`) or an
+  // index slot (`TABLE_ORDERED`)
+  size_t gets;
+  size_t puts;
+  size_t removes;
+  double avg_get_probes;
+  double avg_put_probes;
+  double avg_remove_probes;
+
+  // the lookups of any operation which found / didn't find their key
+  size_t hits;
+  size_t misses;
+
+  // every resize, growing, shrinking, or rehashing in place (`TABLE_OPEN_ADDRESSING`), and the time spent in them
+  size_t resizes;
+  uint64_t resize_ns;
 };
 
 /**
@@ -42,8 +232,9 @@ struct hash_table {
  * @param[in] value_size  the size of every `value` in bytes
  * @param[in] cmpr  a function comparing `2` keys. the function must return a positive integer if the `left key > right
  * key`, negative integer if `left key < right key` or `0` if `left key == right key`
- * @param[in, optional] hash - a function generating a hash from a key. the function may be `NULL` in which case
- * `http://www.cse.yorku.ca/~oz/hash.html` will be used
+ * @param[in, optional] hash - a function generating a hash from a key. the function may be `NULL` in which case a
+ * seeded, word at a time hash (in the spirit of wyhash) will be used. a user supplied hash is further mixed by the
+ * table, as the table only relies on some of its bits
  * @param[in, optional] destroy_key a destructor for `key`
  * @param[in, optional] destroy_value a destructor for `value`
  * @return `struct hash_table` hash table object
@@ -55,6 +246,64 @@ struct hash_table table_create(size_t key_size,
                                void (*destroy_key)(void *),
                                void (*destroy_value)(void *));
 
+/**
+ * @brief creates a hash table object `map<K, V>` with non default construction parameters
+ *
+ * @param[in] key_size  the size of every `key` in bytes
+ * @param[in] value_size  the size of every `value` in bytes
+ * @param[in] cmpr  a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash - a function generating a hash from a key. see `table_create`
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @param[in, optional] options the construction parameters. `NULL` is equivalent to a zero initialized object
+ * @return `struct hash_table` hash table object. a zero initialized object if `options` are invalid
+ */
+struct hash_table table_create_ex(size_t key_size,
+                                  size_t value_size,
+                                  int (*cmpr)(void const *, void const *),
+                                  size_t (*hash)(void const *hashable, size_t size),
+                                  void (*destroy_key)(void *),
+                                  void (*destroy_value)(void *),
+                                  struct table_options const *options);
+
+/**
+ * @brief creates a hash table object `map<K, V>` holding `count` `key / value` pairs, as if they were put into an empty
+ * table one after the other (i.e. a later value of a duplicate key replaces an earlier one, unless the table is a
+ * multimap)
+ *
+ * the table is sized once for all the pairs. a `TABLE_CHAINED` table places all of its nodes in a single allocation (a
+ * slab), which is released along with the table. the node of a pair removed later on isn't reused. other engines put
+ * the pairs as `table_put_many` does
+ *
+ * @param[in] keys an array of `count` keys
+ * @param[in] values an array of `count` values. `values[i]` is mapped to `keys[i]`
+ * @param[in] count the number of pairs
+ * @param[in] key_size  the size of every `key` in bytes
+ * @param[in] value_size  the size of every `value` in bytes
+ * @param[in] cmpr  a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash - a function generating a hash from a key. see `table_create`
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @param[in, optional] options the construction parameters. see `table_create_ex`
+ * @param[in] threads the number of threads (the calling one included) a `TABLE_CHAINED` table is built by. the keys
+ * are hashed in parallel, and each thread then links the pairs of its own range of buckets. `0` / `1` builds the
+ * table on the calling thread alone, as does a library built without pthreads. `hash`, `cmpr` and `destroy_value`
+ * must be safe to call concurrently
+ * @return `struct hash_table` hash table object. a zero initialized object if the parameters are invalid or on
+ * allocation failure
+ */
+struct hash_table table_from_arrays(void const *keys,
+                                    void const *values,
+                                    size_t count,
+                                    size_t key_size,
+                                    size_t value_size,
+                                    int (*cmpr)(void const *, void const *),
+                                    size_t (*hash)(void const *hashable, size_t size),
+                                    void (*destroy_key)(void *),
+                                    void (*destroy_value)(void *),
+                                    struct table_options const *options,
+                                    size_t threads);
+
 /**
  * @brief destroys a table
  *
@@ -63,6 +312,23 @@ struct hash_table table_create(size_t key_size,
  */
 void table_destroy(struct hash_table *table);
 
+/**
+ * @brief puts a filter of the kind `kind` in front of the table's lookups, replacing the current one, if any
+ *
+ * the table owns the filter and keeps it in sync with its keys: a key is added to the filter when it's inserted and
+ * (for `TABLE_FILTER_CUCKOO`) removed from it when it's removed. a key the filter rejects is reported missing right
+ * away. a bloom filter can't forget removed keys, and either filter fills up as keys are inserted, hence the table
+ * rebuilds the filter out of its keys once the filter outgrows the number of keys it was sized for.
+ *
+ * a filter pays off when most lookups miss. otherwise it's mere overhead, touching another cache line on every lookup
+ *
+ * @param[in] table
+ * @param[in] kind the kind of filter. `TABLE_FILTER_NONE` detaches the current filter
+ * @return `enum ds_error` - `DS_OK` on success. `DS_NO_MEM` on allocation failure, in which case the current filter
+ * is left in place. `DS_ERROR` otherwise
+ */
+enum ds_error table_attach_filter(struct hash_table *table, enum table_filter_kind kind);
+
 /**
  * @brief returns the state of the table
  *
@@ -84,17 +350,83 @@ size_t table_size(struct hash_table const *table);
  * @brief returns the number of entries in the table
  *
  * @param table
- * @return `size_t` the number of entries in the table
+ * @return `size_t` the number of entries (buckets for `TABLE_CHAINED` / `TABLE_DENSE`, slots for
+ * `TABLE_OPEN_ADDRESSING`, index slots for `TABLE_ORDERED`) in the table
  */
 size_t table_capacity(struct hash_table const *table);
 
+/**
+ * @brief makes room for at least `count` elements, such that inserting up to `count` elements won't resize the table.
+ * the table never shrinks as a result of this call. an incremental resize which is in progress is completed
+ *
+ * @param[in] table
+ * @param[in] count the number of elements the table should be able to hold
+ * @return `size_t` the new capacity of the table. on failure the capacity is left unchanged
+ */
+size_t table_reserve(struct hash_table *table, size_t count);
+
+/**
+ * @brief shrinks the table to the smallest capacity which holds its elements within the max load factor. an
+ * incremental resize which is in progress is completed
+ *
+ * @param[in] table
+ * @return `size_t` the new capacity of the table. on failure the capacity is left unchanged
+ */
+size_t table_shrink_to_fit(struct hash_table *table);
+
+/**
+ * @brief converts the table into a read only minimal perfect hash (`TABLE_FROZEN`). the keys and values are moved into
+ * one contiguous array holding exactly `size` records, and a small array of displacements (about `2` bytes per key)
+ * maps every key to its record. a lookup of a frozen table is a single probe followed by a single `cmpr` call.
+ * modifying a frozen table (`table_put`, `table_remove`, `table_emplace` etc) fails with `DS_ERROR`, though values may
+ * still be modified in place (e.g. through `table_get_ref`)
+ *
+ * @param[in] table the table to freeze. on failure the table is left as is
+ * @return `enum ds_error` - `DS_OK` on success (or if the table is already frozen). `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` if the table is invalid or a multimap, or if distinct keys share their hash (hence can't be told apart)
+ */
+enum ds_error table_freeze(struct hash_table *table);
+
+/**
+ * @brief writes a snapshot of the table into `fd`. the snapshot holds the layout of a frozen table (see `table_freeze`)
+ * and can be mapped back by `table_open_mapped` with no deserialization. the snapshot stores the raw bytes of the keys
+ * and values, hence is only meaningful for keys / values which hold no pointers. the snapshot is portable between
+ * processes, not between platforms of different word size or byte order. snapshots are only supported on unix like
+ * platforms (which provide `mmap`), elsewhere `table_save` and `table_open_mapped` fail
+ *
+ * @param[in] table the table to save. the table isn't modified, though an incremental resize in progress is completed
+ * @param[in] fd a file descriptor of a regular file, open for writing. the snapshot overwrites the whole file: it's
+ * written from the start of the file (regardless of the descriptor's offset, which is left as is), and the file is
+ * truncated to the snapshot's size
+ * @return `enum ds_error` - `DS_OK` on success. `DS_NO_MEM` on allocation failure. `DS_ERROR` if the table is invalid,
+ * can't be frozen or on a write failure
+ */
+enum ds_error table_save(struct hash_table *table, int fd);
+
+/**
+ * @brief maps a snapshot written by `table_save` and serves it as a frozen table (see `table_freeze`). lookups read the
+ * mapping directly, pages are loaded on demand. modifying values in place (e.g. through `table_get_ref`) affects the
+ * calling process only. `table_destroy` unmaps the snapshot
+ *
+ * @param[in] path the snapshot's path
+ * @param[in] cmpr a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash the hash function the saved table was created with. `NULL` if it used the default hash (the
+ * seed is stored in the snapshot)
+ * @return `struct hash_table` a frozen table with no key / value destructors. a zero initialized object if the file
+ * can't be mapped, isn't a valid snapshot, or if `hash` doesn't match the hash the table was saved with
+ */
+struct hash_table table_open_mapped(char const *path,
+                                    int (*cmpr)(void const *, void const *),
+                                    size_t (*hash)(void const *hashable, size_t size));
+
 /**
  * @brief inserts `new_value` into the table and returns the `old_value` associated with `key` if there was any
  *
  * @param[in] table
  * @param[in] key the mapping for `new_value`
  * @param[in] new_value the value to insert into the table
- * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it. a multimap
+ * never replaces values, it adds another `key / value` pair
  * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
  * operation succeded & an old value was replaced and put into `old_value`. `DS_ERROR` otherwise
  */
@@ -104,7 +436,8 @@ enum ds_error table_put(struct hash_table *restrict table,
                         void *restrict old_value);
 
 /**
- * @brief removed the mapping for `key` (deletes a `key / value` pair)
+ * @brief removed the mapping for `key` (deletes a `key / value` pair). a multimap removes one of the pairs of `key`.
+ * see `table_remove_all`
  *
  * @param[in] table
  * @param[in] key
@@ -136,4 +469,291 @@ enum ds_error table_get(struct hash_table *restrict table, void const *restrict
  */
 bool table_contains(struct hash_table *restrict table, void const *restrict key);
 
+/**
+ * @brief finds all the `key / value` pairs of `key`. in a multimap they're adjacent, so walking them doesn't involve
+ * any other key. a table which isn't a multimap holds at most one pair per key
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out] range the pairs found. walked by `table_range_next`. valid until the table is modified
+ * @return `size_t` the number of pairs found
+ */
+size_t table_get_all(struct hash_table *restrict table, void const *restrict key, struct table_range *restrict range);
+
+/**
+ * @brief advances a range found by `table_get_all` and returns its next pair, in an unspecified order
+ *
+ * @param[in] range
+ * @return `void *` an iterator pointing at the pair (see `table_iter_key` / `table_iter_value`). `NULL` once every
+ * pair of the range was visited
+ */
+void *table_range_next(struct table_range *range);
+
+/**
+ * @brief returns the number of `key / value` pairs of `key`
+ *
+ * @param[in] table
+ * @param[in] key
+ * @return `size_t` the number of pairs. at most `1` unless the table is a multimap
+ */
+size_t table_count(struct hash_table *restrict table, void const *restrict key);
+
+/**
+ * @brief removes every `key / value` pair of `key`. the destructors are called on every removed key and value
+ *
+ * @param[in] table
+ * @param[in] key
+ * @return `size_t` the number of pairs removed
+ */
+size_t table_remove_all(struct hash_table *restrict table, void const *restrict key);
+
+/**
+ * @brief returns a pointer to the `value` associated with `key`, within the table's own storage. unlike `table_get`
+ * nothing is copied. the pointer is valid until the next operation which modifies the table (put / emplace / remove
+ * etc)
+ *
+ * @param[in] table
+ * @param[in] key
+ * @return `void *` a pointer to the value associated with `key`. `NULL` if there's no such key
+ */
+void *table_get_ref(struct hash_table *restrict table, void const *restrict key);
+
+/**
+ * @brief maps `key` to a value the caller constructs in place. if `key` is new a copy of it is inserted into the table
+ * and `value` is set to point at the _uninitialized_ storage of its value. if `key` is already mapped `value` is set to
+ * point at the existing value and the table is left untouched. either way the pointer is valid until the next operation
+ * which modifies the table, and a new value must be fully written before said operation
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out] value set to point at the storage of the value associated with `key`
+ * @return `enum ds_error` - `DS_OK` if `key` was inserted. `DS_VALUE_OK` if `key` was already mapped. `DS_NO_MEM` on
+ * allocation failure. `DS_ERROR` otherwise
+ */
+enum ds_error table_emplace(struct hash_table *restrict table, void const *restrict key, void **restrict value);
+
+/**
+ * @brief inserts or updates the value associated with `key` in place. `update` is called exactly once with a pointer to
+ * the value's storage: the existing value if `key` is already mapped (`exists == true`), or the uninitialized storage
+ * of a new value otherwise (`exists == false`), in which case `update` must fully initialize it
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[in] update the function updating / initializing the value
+ * @param[in, optional] context passed as is to `update`
+ * @return `enum ds_error` - `DS_OK` if `key` was inserted. `DS_VALUE_OK` if an existing value was updated.
+ * `DS_NO_MEM` on allocation failure. `DS_ERROR` otherwise
+ */
+enum ds_error table_upsert_with(struct hash_table *restrict table,
+                                void const *restrict key,
+                                void (*update)(void *value, bool exists, void *context),
+                                void *context);
+
+/**
+ * @brief gets the values associated with a batch of keys. the keys are hashed and their memory prefetched ahead of the
+ * lookups themselves, so the cache misses of many lookups overlap. prefer it over a loop of `table_get` when looking up
+ * many keys at once
+ *
+ * @param[in] table
+ * @param[in] keys an array of `count` keys
+ * @param[in] count the number of keys
+ * @param[out] values an array of `count` values. the value associated with `keys[i]` is copied into `values[i]`. the
+ * values of keys which aren't in the table are left untouched
+ * @param[out, optional] status an array of `count` results. `status[i]` is set to `DS_VALUE_OK` if `keys[i]` was found,
+ * `DS_NOT_FOUND` otherwise
+ * @return `size_t` the number of keys found
+ */
+size_t table_get_many(struct hash_table *restrict table,
+                      void const *restrict keys,
+                      size_t count,
+                      void *restrict values,
+                      enum ds_error *restrict status);
+
+/**
+ * @brief puts a batch of `key / value` pairs into the table, prefetching ahead the same way `table_get_many` does.
+ * replaced values are destroyed (if the table was supplied a destructor for `value`), as with `table_put` with no
+ * `old_value`
+ *
+ * @param[in] table
+ * @param[in] keys an array of `count` keys
+ * @param[in] values an array of `count` values. `values[i]` is mapped to `keys[i]`
+ * @param[in] count the number of pairs
+ * @param[out, optional] status an array of `count` results. `status[i]` is set to `DS_OK` if `keys[i]` was inserted,
+ * `DS_VALUE_OK` if the value of `keys[i]` was replaced, or to an error
+ * @return `size_t` the number of keys inserted (not including replaced ones)
+ */
+size_t table_put_many(struct hash_table *restrict table,
+                      void const *restrict keys,
+                      void const *restrict values,
+                      size_t count,
+                      enum ds_error *restrict status);
+
+/* prehashed operations. `table_hash` returns the hash a table computes for a key, which the `_hashed` variants of
+ * `table_put`, `table_get`, `table_remove` and `table_contains` take in place of hashing the key themselves. hence a key
+ * can be hashed once and looked up in several tables, as long as they hash keys identically: they were created with
+ * the same `hash` function, or with the default hash and the same seed (see `struct table_options`). passing a hash
+ * the table didn't compute for said key is undefined */
+
+/**
+ * @brief returns the hash the table computes for `key`. the hash is only meaningful to tables which hash keys
+ * identically to `table`
+ *
+ * @param[in] table
+ * @param[in] key
+ * @return `size_t` the hash of `key`. `0` if either argument is `NULL`
+ */
+size_t table_hash(struct hash_table const *restrict table, void const *restrict key);
+
+/**
+ * @brief `table_put` with the hash of `key` already known
+ *
+ * @param[in] table
+ * @param[in] hash the hash of `key`, as returned by `table_hash`
+ * @param[in] key
+ * @param[in] new_value
+ * @param[out, optional] old_value
+ * @return `enum ds_error` see `table_put`
+ */
+enum ds_error table_put_hashed(struct hash_table *restrict table,
+                               size_t hash,
+                               void const *key,
+                               void const *new_value,
+                               void *old_value);
+
+/**
+ * @brief `table_get` with the hash of `key` already known
+ *
+ * @param[in] table
+ * @param[in] hash the hash of `key`, as returned by `table_hash`
+ * @param[in] key
+ * @param[out] value
+ * @return `enum ds_error` see `table_get`
+ */
+enum ds_error table_get_hashed(struct hash_table *restrict table,
+                               size_t hash,
+                               void const *restrict key,
+                               void *restrict value);
+
+/**
+ * @brief `table_remove` with the hash of `key` already known
+ *
+ * @param[in] table
+ * @param[in] hash the hash of `key`, as returned by `table_hash`
+ * @param[in] key
+ * @param[out, optional] old_value
+ * @return `enum ds_error` see `table_remove`
+ */
+enum ds_error table_remove_hashed(struct hash_table *restrict table,
+                                  size_t hash,
+                                  void const *restrict key,
+                                  void *restrict old_value);
+
+/**
+ * @brief `table_contains` with the hash of `key` already known
+ *
+ * @param[in] table
+ * @param[in] hash the hash of `key`, as returned by `table_hash`
+ * @param[in] key
+ * @return `true` if the table contains said key
+ * @return `false` if the table doesn't contain said key
+ */
+bool table_contains_hashed(struct hash_table *restrict table, size_t hash, void const *restrict key);
+
 void print_table(struct hash_table *table, void (*print)(void const *, void const *, size_t));
+
+/* iterator related functions. an iterator is a pointer to an element of the table, and is invalidated by any
+ * modification of the table (e.g. `table_put`, `table_remove`, `table_get`, which may advance an incremental resize).
+ * the iteration order is unspecified */
+
+/**
+ * @brief returns an iterator to the first element of the table. an incremental resize which is in progress is completed
+ *
+ * @param[in] table
+ * @return `void *` the iterator. `NULL` if the table is empty or `NULL`
+ */
+void *table_iter_begin(struct hash_table *table);
+
+/**
+ * @brief advances the iterator to the next element of the table
+ *
+ * @param[in] table the table to iterate over
+ * @param[in] iter a valid iterator
+ * @return `void *` the new iterator. `NULL` once there are no more elements
+ */
+void *table_iter_next(struct hash_table *table, void *iter);
+
+/**
+ * @brief returns the key of the element an iterator points at
+ *
+ * @param[in] table
+ * @param[in] iter a valid iterator
+ * @return `void const *` a pointer to the key. the key must not be modified
+ */
+void const *table_iter_key(struct hash_table const *table, void *iter);
+
+/**
+ * @brief returns the value of the element an iterator points at
+ *
+ * @param[in] table
+ * @param[in] iter a valid iterator
+ * @return `void *` a pointer to the value. the value may be modified in place
+ */
+void *table_iter_value(struct hash_table const *table, void *iter);
+
+/**
+ * @brief calls `fn` on every element of the table. `fn` must not modify the table, though it may modify the values in
+ * place. an incremental resize which is in progress is completed
+ *
+ * @param[in] table
+ * @param[in] fn the function to call for each element
+ * @param[in, optional] context passed as is to `fn`
+ */
+void table_for_each(struct hash_table *table, void (*fn)(void const *key, void *value, void *context), void *context);
+
+/**
+ * @brief returns whether the table is in the middle of an incremental resize. i.e. some of its elements still reside in
+ * the entries it had prior to the resize. every `table_put`, `table_get`, `table_remove` and `table_contains` migrates
+ * a few of these entries
+ *
+ * @param[in] table
+ * @return `true` if there are entries left to migrate
+ * @return `false` otherwise, or if the table doesn't resize incrementally
+ */
+bool table_rehashing(struct hash_table const *table);
+
+/**
+ * @brief returns the number of entries an incremental resize has yet to migrate
+ *
+ * @param[in] table
+ * @return `size_t` the number of entries left to migrate. `0` if the table isn't in the middle of a resize
+ */
+size_t table_rehash_pending(struct hash_table const *table);
+
+/**
+ * @brief migrates up to `count` entries of an incremental resize. this allows one to push the migration forward on
+ * their own terms (e.g. when idle)
+ *
+ * @param[in] table
+ * @param[in] count the maximal number of entries to migrate. `SIZE_MAX` completes the migration
+ * @return `size_t` the number of entries left to migrate
+ */
+size_t table_rehash_step(struct hash_table *table, size_t count);
+
+/**
+ * @brief reports the shape of the table (its size, memory footprint and chain lengths). when the library is built with
+ * DS_TABLE_STATS, the lookups, probes and resizes since the table was created (or last reset) are reported as well.
+ * building the report walks the whole table
+ *
+ * @param[in] table
+ * @param[out] stats the report
+ * @return `enum ds_error` - `DS_OK` on success. `DS_ERROR` if the table is invalid
+ */
+enum ds_error table_stats(struct hash_table *restrict table, struct table_stats *restrict stats);
+
+/**
+ * @brief zeroes the counters of the table (its lookups, probes and resizes). does nothing unless the library is built
+ * with DS_TABLE_STATS
+ *
+ * @param[in] table
+ */
+void table_stats_reset(struct hash_table *table);
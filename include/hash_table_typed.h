@@ -0,0 +1,396 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "defines.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TYPED_TABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file hash_table_typed.h
+ * @brief type specialized hash tables, generated by `HASH_TABLE_DEFINE`
+ *
+ * `struct hash_table` is generic: every key is hashed and compared through a function pointer and copied with
+ * `memcpy` of a runtime size. `HASH_TABLE_DEFINE(name, K, V, hash_fn, eq_fn)` generates a table specialized for keys
+ * of type `K` and values of type `V`, in which hashing and comparing are inlined and keys / values are copied by
+ * assignment. the table uses the open addressing engine of `struct hash_table` (see `TABLE_OPEN_ADDRESSING`), with the
+ * same load factor, growth and hash mixing, and its functions keep the semantics of their `table_*` counterparts:
+ *
+ * - `struct name name_create(void (*destroy_key)(K *), void (*destroy_value)(V *))` - see `table_create`. a zero
+ *   initialized object on allocation failure
+ * - `void name_destroy(struct name *)` - see `table_destroy`
+ * - `size_t name_size(struct name const *)`, `size_t name_capacity(struct name const *)`
+ * - `size_t name_reserve(struct name *, size_t count)` - see `table_reserve`
+ * - `enum ds_error name_put(struct name *, K const *key, V const *new_value, V *old_value)` - see `table_put`
+ * - `enum ds_error name_get(struct name *, K const *key, V *value)` - see `table_get`
+ * - `V *name_get_ref(struct name *, K const *key)` - see `table_get_ref`
+ * - `bool name_contains(struct name *, K const *key)` - see `table_contains`
+ * - `enum ds_error name_remove(struct name *, K const *key, V *old_value)` - see `table_remove`
+ * - `struct name_slot *name_iter_begin(struct name *)`, `struct name_slot *name_iter_next(struct name *, struct
+ *   name_slot *)` - iterate over the elements (`slot->key`, `slot->value`) in an unspecified order. `NULL` once done.
+ *   modifying the table invalidates the iterator
+ *
+ * `hash_fn` is called as `size_t hash_fn(K const *key)` and `eq_fn` as `bool eq_fn(K const *left, K const *right)`.
+ * either may be a function or a function like macro. as with `table_create`, the hash is mixed before use, hence a
+ * weak hash (e.g. the identity of an integer) is fine. `typed_table_hash_u64` & `typed_table_eq_u64` serve integer
+ * keys. the generated functions are `static inline`, so the macro may be expanded once per translation unit
+ */
+
+#define TYPED_TABLE_GROUP_WIDTH 16
+#define TYPED_TABLE_INIT_CAPACITY 32
+#define TYPED_TABLE_EMPTY 0x80
+#define TYPED_TABLE_DELETED 0xfe
+
+static inline size_t typed_table_hash_u64(uint64_t const *key) {
+  return (size_t)*key;
+}
+
+static inline bool typed_table_eq_u64(uint64_t const *left, uint64_t const *right) {
+  return *left == *right;
+}
+
+/* used internally to spread the bits of a hash, the way `struct hash_table` mixes a user supplied hash */
+static inline size_t typed_table_mix(size_t hash) {
+  uint64_t a = (uint64_t)hash ^ 0xa0761d6478bd642full;
+  uint64_t b = 0xe7037ed1a0b428dbull;
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 typed_table_u128;
+  typed_table_u128 r = (typed_table_u128)a * b;
+  return (size_t)((uint64_t)r ^ (uint64_t)(r >> 64));
+#else
+  uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), carry = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  return (size_t)(lo ^ (rh + (rm0 >> 32) + (rm1 >> 32) + carry));
+#endif
+}
+
+static inline unsigned char typed_table_h2(size_t hash) {
+  return (unsigned char)(hash & 0x7f);
+}
+
+static inline size_t typed_table_h1(size_t hash) {
+  return hash >> 7;
+}
+
+/* used internally to get the number of elements a table of `capacity` slots may hold (a load factor of 0.875) */
+static inline size_t typed_table_max_elements(size_t capacity) {
+  return capacity - capacity / 8;
+}
+
+#ifdef TYPED_TABLE_SSE2
+/* used internally to get a bitmask of all the control bytes in a group which equal `byte` */
+static inline uint32_t typed_table_match(unsigned char const *group, unsigned char byte) {
+  __m128i ctrl = _mm_loadu_si128((__m128i const *)group);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+}
+
+/* used internally to get a bitmask of all the empty or deleted slots in a group (i.e. their msb is set) */
+static inline uint32_t typed_table_match_available(unsigned char const *group) {
+  return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)group));
+}
+#else
+static inline uint32_t typed_table_match(unsigned char const *group, unsigned char byte) {
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < TYPED_TABLE_GROUP_WIDTH; i++) { mask |= (uint32_t)(group[i] == byte) << i; }
+  return mask;
+}
+
+static inline uint32_t typed_table_match_available(unsigned char const *group) {
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < TYPED_TABLE_GROUP_WIDTH; i++) { mask |= (uint32_t)(group[i] >> 7) << i; }
+  return mask;
+}
+#endif
+
+/* used internally to get the index of the lowest set bit. the function assumes mask != 0 */
+static inline unsigned typed_table_first_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctz(mask);
+#else
+  unsigned idx = 0;
+  for (; !(mask & 1); mask >>= 1) idx++;
+  return idx;
+#endif
+}
+
+/* used internally to find the first empty / deleted slot on the probe sequence of `hash`. the function assumes there's
+ * at least one such slot */
+static inline size_t typed_table_find_available(unsigned char const *ctrl, size_t capacity, size_t hash) {
+  size_t groups_mask = capacity / TYPED_TABLE_GROUP_WIDTH - 1;
+  size_t group = typed_table_h1(hash) & groups_mask;
+
+  // triangular probing visits every group exactly once when the number of groups is a power of 2
+  for (size_t step = 1;; step++) {
+    uint32_t available = typed_table_match_available(ctrl + group * TYPED_TABLE_GROUP_WIDTH);
+    if (available) return group * TYPED_TABLE_GROUP_WIDTH + typed_table_first_bit(available);
+
+    group = (group + step) & groups_mask;
+  }
+}
+
+/**
+ * @brief defines `struct name` - a hash table `map<K, V>` - and its functions (see the top of the file)
+ *
+ * @param name the name of the table type, and the prefix of its functions
+ * @param K the type of the keys. copied by assignment
+ * @param V the type of the values. copied by assignment
+ * @param hash_fn `size_t hash_fn(K const *key)`
+ * @param eq_fn `bool eq_fn(K const *left, K const *right)`
+ */
+#define HASH_TABLE_DEFINE(name, K, V, hash_fn, eq_fn)                                                                 \
+  struct name##_slot {                                                                                                 \
+    K key;                                                                                                             \
+    V value;                                                                                                           \
+  };                                                                                                                   \
+                                                                                                                       \
+  struct name {                                                                                                        \
+    size_t _n_elem;                                                                                                    \
+    size_t _n_deleted;                                                                                                 \
+    size_t _capacity;                                                                                                  \
+                                                                                                                       \
+    unsigned char *_ctrl;                                                                                              \
+    struct name##_slot *_slots;                                                                                        \
+                                                                                                                       \
+    void (*_destroy_key)(K *key);                                                                                      \
+    void (*_destroy_value)(V *value);                                                                                  \
+  };                                                                                                                   \
+                                                                                                                       \
+  static inline size_t name##_hash(K const *key) {                                                                     \
+    return typed_table_mix((size_t)hash_fn(key));                                                                      \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to allocate the (empty) storage of `capacity` slots */                                            \
+  static inline bool name##_alloc(struct name *table, size_t capacity) {                                               \
+    if (capacity > SIZE_MAX / sizeof(struct name##_slot)) return false;                                                \
+                                                                                                                       \
+    unsigned char *ctrl = malloc(capacity);                                                                            \
+    struct name##_slot *slots = malloc(capacity * sizeof *slots);                                                      \
+    if (!ctrl || !slots) {                                                                                             \
+      free(ctrl);                                                                                                      \
+      free(slots);                                                                                                     \
+      return false;                                                                                                    \
+    }                                                                                                                  \
+    memset(ctrl, TYPED_TABLE_EMPTY, capacity);                                                                         \
+                                                                                                                       \
+    table->_ctrl = ctrl;                                                                                               \
+    table->_slots = slots;                                                                                             \
+    table->_capacity = capacity;                                                                                       \
+    table->_n_deleted = 0;                                                                                             \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline struct name name##_create(void (*destroy_key)(K *key), void (*destroy_value)(V *value)) {              \
+    struct name table = {._destroy_key = destroy_key, ._destroy_value = destroy_value};                                \
+    if (!name##_alloc(&table, TYPED_TABLE_INIT_CAPACITY)) return (struct name){0};                                     \
+    return table;                                                                                                      \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline void name##_destroy(struct name *table) {                                                              \
+    if (!table || !table->_ctrl) return;                                                                               \
+                                                                                                                       \
+    for (size_t pos = 0; pos < table->_capacity; pos++) {                                                              \
+      if (table->_ctrl[pos] & TYPED_TABLE_EMPTY) continue;                                                             \
+      if (table->_destroy_key) table->_destroy_key(&table->_slots[pos].key);                                           \
+      if (table->_destroy_value) table->_destroy_value(&table->_slots[pos].value);                                     \
+    }                                                                                                                  \
+                                                                                                                       \
+    free(table->_ctrl);                                                                                                \
+    free(table->_slots);                                                                                               \
+    *table = (struct name){0};                                                                                         \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline size_t name##_size(struct name const *table) {                                                         \
+    return table ? table->_n_elem : 0;                                                                                 \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline size_t name##_capacity(struct name const *table) {                                                     \
+    return table ? table->_capacity : 0;                                                                               \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to find the slot of `key`. NULL if there's no such key */                                         \
+  static inline struct name##_slot *name##_find(struct name *table, size_t hash, K const *key) {                       \
+    size_t groups_mask = table->_capacity / TYPED_TABLE_GROUP_WIDTH - 1;                                               \
+    size_t group = typed_table_h1(hash) & groups_mask;                                                                 \
+    unsigned char tag = typed_table_h2(hash);                                                                          \
+                                                                                                                       \
+    for (size_t step = 1; step <= groups_mask + 1; step++) {                                                           \
+      unsigned char const *ctrl = table->_ctrl + group * TYPED_TABLE_GROUP_WIDTH;                                      \
+      for (uint32_t match = typed_table_match(ctrl, tag); match; match &= match - 1) {                                 \
+        struct name##_slot *slot = &table->_slots[group * TYPED_TABLE_GROUP_WIDTH + typed_table_first_bit(match)];     \
+        if (eq_fn(key, &slot->key)) return slot;                                                                       \
+      }                                                                                                                \
+      if (typed_table_match(ctrl, TYPED_TABLE_EMPTY)) return NULL;                                                     \
+                                                                                                                       \
+      group = (group + step) & groups_mask;                                                                            \
+    }                                                                                                                  \
+                                                                                                                       \
+    return NULL;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to move every element into a new storage of `capacity` slots */                                   \
+  static inline bool name##_resize(struct name *table, size_t capacity) {                                              \
+    struct name resized = *table;                                                                                      \
+    if (!name##_alloc(&resized, capacity)) return false;                                                               \
+                                                                                                                       \
+    for (size_t pos = 0; pos < table->_capacity; pos++) {                                                              \
+      if (table->_ctrl[pos] & TYPED_TABLE_EMPTY) continue;                                                             \
+                                                                                                                       \
+      size_t hash = name##_hash(&table->_slots[pos].key);                                                              \
+      size_t new_pos = typed_table_find_available(resized._ctrl, capacity, hash);                                      \
+      resized._ctrl[new_pos] = typed_table_h2(hash);                                                                   \
+      resized._slots[new_pos] = table->_slots[pos];                                                                    \
+    }                                                                                                                  \
+                                                                                                                       \
+    free(table->_ctrl);                                                                                                \
+    free(table->_slots);                                                                                               \
+    *table = resized;                                                                                                  \
+    return true;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to claim a slot for a new key with the hash `hash`. the function assumes the key is absent */     \
+  static inline struct name##_slot *name##_insert(struct name *table, size_t hash) {                                   \
+    size_t max_elements = typed_table_max_elements(table->_capacity);                                                  \
+    if (table->_n_elem + 1 > max_elements) {                                                                           \
+      if (table->_capacity > SIZE_MAX / 2 || !name##_resize(table, table->_capacity * 2)) return NULL;                 \
+    } else if (table->_n_elem + table->_n_deleted + 1 > max_elements) {                                                \
+      /* the deleted slots are reclaimed in place */                                                                   \
+      if (!name##_resize(table, table->_capacity)) return NULL;                                                        \
+    }                                                                                                                  \
+                                                                                                                       \
+    size_t pos = typed_table_find_available(table->_ctrl, table->_capacity, hash);                                     \
+    if (table->_ctrl[pos] == TYPED_TABLE_DELETED) table->_n_deleted--;                                                 \
+    table->_ctrl[pos] = typed_table_h2(hash);                                                                          \
+    table->_n_elem++;                                                                                                  \
+    return &table->_slots[pos];                                                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to free the slot of a removed key */                                                              \
+  static inline void name##_erase(struct name *table, struct name##_slot *slot) {                                      \
+    size_t pos = (size_t)(slot - table->_slots);                                                                       \
+    size_t group = pos / TYPED_TABLE_GROUP_WIDTH * TYPED_TABLE_GROUP_WIDTH;                                            \
+                                                                                                                       \
+    /* a group which has never been full ends every probe sequence passing through it */                               \
+    if (typed_table_match(table->_ctrl + group, TYPED_TABLE_EMPTY)) {                                                  \
+      table->_ctrl[pos] = TYPED_TABLE_EMPTY;                                                                           \
+    } else {                                                                                                           \
+      table->_ctrl[pos] = TYPED_TABLE_DELETED;                                                                         \
+      table->_n_deleted++;                                                                                             \
+    }                                                                                                                  \
+    table->_n_elem--;                                                                                                  \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline size_t name##_reserve(struct name *table, size_t count) {                                              \
+    if (!table || !table->_ctrl) return 0;                                                                             \
+                                                                                                                       \
+    size_t capacity = table->_capacity;                                                                                \
+    while (typed_table_max_elements(capacity) < count) {                                                               \
+      if (capacity > SIZE_MAX / 2) return table->_capacity;                                                            \
+      capacity *= 2;                                                                                                   \
+    }                                                                                                                  \
+                                                                                                                       \
+    if (capacity > table->_capacity) name##_resize(table, capacity);                                                   \
+    return table->_capacity;                                                                                           \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline enum ds_error name##_put(struct name *restrict table,                                                  \
+                                         K const *restrict key,                                                        \
+                                         V const *restrict new_value,                                                  \
+                                         V *restrict old_value) {                                                      \
+    if (!table || !table->_ctrl) return DS_ERROR;                                                                      \
+    if (!key || !new_value) return DS_ERROR;                                                                           \
+                                                                                                                       \
+    size_t hash = name##_hash(key);                                                                                    \
+    struct name##_slot *slot = name##_find(table, hash, key);                                                          \
+    if (slot) {                                                                                                        \
+      if (old_value) {                                                                                                 \
+        *old_value = slot->value;                                                                                      \
+        slot->value = *new_value;                                                                                      \
+        return DS_VALUE_OK;                                                                                            \
+      }                                                                                                                \
+                                                                                                                       \
+      if (table->_destroy_value) table->_destroy_value(&slot->value);                                                  \
+      slot->value = *new_value;                                                                                        \
+      return DS_OK;                                                                                                    \
+    }                                                                                                                  \
+                                                                                                                       \
+    slot = name##_insert(table, hash);                                                                                 \
+    if (!slot) return DS_NO_MEM;                                                                                       \
+                                                                                                                       \
+    slot->key = *key;                                                                                                  \
+    slot->value = *new_value;                                                                                          \
+    return DS_OK;                                                                                                      \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline enum ds_error name##_get(struct name *restrict table, K const *restrict key, V *restrict value) {      \
+    if (!table || !table->_ctrl) return DS_ERROR;                                                                      \
+    if (!key || !value) return DS_ERROR;                                                                               \
+                                                                                                                       \
+    struct name##_slot *slot = name##_find(table, name##_hash(key), key);                                              \
+    if (!slot) return DS_NOT_FOUND;                                                                                    \
+                                                                                                                       \
+    *value = slot->value;                                                                                              \
+    return DS_VALUE_OK;                                                                                                \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline V *name##_get_ref(struct name *restrict table, K const *restrict key) {                                \
+    if (!table || !table->_ctrl || !key) return NULL;                                                                  \
+                                                                                                                       \
+    struct name##_slot *slot = name##_find(table, name##_hash(key), key);                                              \
+    return slot ? &slot->value : NULL;                                                                                 \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline bool name##_contains(struct name *restrict table, K const *restrict key) {                             \
+    if (!table || !table->_ctrl || !key) return false;                                                                 \
+                                                                                                                       \
+    return name##_find(table, name##_hash(key), key) != NULL;                                                          \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline enum ds_error name##_remove(struct name *restrict table,                                               \
+                                            K const *restrict key,                                                     \
+                                            V *restrict old_value) {                                                   \
+    if (!table || !table->_ctrl) return DS_ERROR;                                                                      \
+    if (!key) return DS_ERROR;                                                                                         \
+                                                                                                                       \
+    struct name##_slot *slot = name##_find(table, name##_hash(key), key);                                              \
+    if (!slot) return DS_NOT_FOUND;                                                                                    \
+                                                                                                                       \
+    enum ds_error ret = DS_OK;                                                                                         \
+    if (old_value) {                                                                                                   \
+      *old_value = slot->value;                                                                                        \
+      ret = DS_VALUE_OK;                                                                                               \
+    } else if (table->_destroy_value) {                                                                                \
+      table->_destroy_value(&slot->value);                                                                             \
+    }                                                                                                                  \
+                                                                                                                       \
+    if (table->_destroy_key) table->_destroy_key(&slot->key);                                                          \
+    name##_erase(table, slot);                                                                                         \
+    return ret;                                                                                                        \
+  }                                                                                                                    \
+                                                                                                                       \
+  /* used internally to get the first full slot at or after `pos`. NULL if there's none */                             \
+  static inline struct name##_slot *name##_first_from(struct name *table, size_t pos) {                                \
+    for (; pos < table->_capacity; pos++) {                                                                            \
+      if (!(table->_ctrl[pos] & TYPED_TABLE_EMPTY)) return &table->_slots[pos];                                        \
+    }                                                                                                                  \
+    return NULL;                                                                                                       \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline struct name##_slot *name##_iter_begin(struct name *table) {                                            \
+    if (!table || !table->_ctrl) return NULL;                                                                          \
+    return name##_first_from(table, 0);                                                                                \
+  }                                                                                                                    \
+                                                                                                                       \
+  static inline struct name##_slot *name##_iter_next(struct name *table, struct name##_slot *iter) {                   \
+    if (!table || !table->_ctrl || !iter) return NULL;                                                                 \
+    return name##_first_from(table, (size_t)(iter - table->_slots) + 1);                                               \
+  }
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+
+/**
+ * @file int_map.h
+ * @brief the definition of an integer keyed hash map
+ *
+ * the map is an integer keyed flat map which sits alongside `struct hash_table`, for integer keys (e.g. `uint32_t` /
+ * `uint64_t` ids). it's a structure of its own, sharing no code with `struct hash_table`. keys are `uint64_t`, stored
+ * in one flat array apart from the values, and compared as integers - no comparator or hash function is involved. a key is placed by a multiplicative (fibonacci) hash and collisions are resolved by linear
+ * probing, scanning `4` keys at a time (with SSE2, where available).
+ *
+ * an empty slot is marked by a reserved key (`empty_key`), picked when the map is created, which may not be inserted
+ * into the map. removing a key shifts the keys following it backwards, hence the map never accumulates tombstones.
+ *
+ * values are copied in and out of the map (see the notes in `hash_table.h`). the map doesn't own its values, i.e. it
+ * has no destructors
+ */
+
+struct int_map {
+  size_t _n_elem;
+  size_t _capacity;
+  unsigned _shift;  // 64 - log2(_capacity), reduces a hash into a position
+
+  size_t _value_size;
+  uint64_t _empty_key;
+
+  uint64_t *_keys;
+  unsigned char *_values;
+};
+
+/**
+ * @brief creates an integer keyed map object `map<uint64_t, V>`
+ *
+ * @param[in] value_size the size of every `value` in bytes. may be `0` (a set of integers)
+ * @param[in] empty_key the key which marks an empty slot. it can't be used as a key (e.g. `UINT64_MAX`, or `0` if ids
+ * start at `1`)
+ * @return `struct int_map` map object. a zero initialized object on allocation failure
+ */
+struct int_map int_map_create(size_t value_size, uint64_t empty_key);
+
+/**
+ * @brief destroys a map
+ *
+ * @param[in] map the map to destroy
+ */
+void int_map_destroy(struct int_map *map);
+
+/**
+ * @brief returns the number of keys in the map
+ *
+ * @param[in] map
+ * @return `size_t` the number of keys the map contains
+ */
+size_t int_map_size(struct int_map const *map);
+
+/**
+ * @brief returns the number of slots in the map
+ *
+ * @param[in] map
+ * @return `size_t` the number of slots
+ */
+size_t int_map_capacity(struct int_map const *map);
+
+/**
+ * @brief makes room for at least `count` keys, such that inserting up to `count` keys won't resize the map. the map
+ * never shrinks as a result of this call
+ *
+ * @param[in] map
+ * @param[in] count the number of keys the map should be able to hold
+ * @return `size_t` the new capacity of the map. on failure the capacity is left unchanged
+ */
+size_t int_map_reserve(struct int_map *map, size_t count);
+
+/**
+ * @brief inserts `new_value` into the map and returns the `old_value` associated with `key` if there was any
+ *
+ * @param[in] map
+ * @param[in] key the mapping for `new_value`. may not be the map's `empty_key`
+ * @param[in] new_value the value to insert into the map. may be `NULL` if the size of a value is `0`
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it
+ * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
+ * operation succeded & an old value was replaced and put into `old_value`. `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` otherwise
+ */
+enum ds_error int_map_put(struct int_map *restrict map,
+                          uint64_t key,
+                          void const *restrict new_value,
+                          void *restrict old_value);
+
+/**
+ * @brief gets the `value` associated with `key`
+ *
+ * @param[in] map
+ * @param[in] key
+ * @param[out] value a pointer to the type of `value`. the value will be copied into it
+ * @return `enum ds_error` - `DS_VALUE_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such key. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error int_map_get(struct int_map *restrict map, uint64_t key, void *restrict value);
+
+/**
+ * @brief gets a pointer to the `value` associated with `key`. the pointer is valid until the map is modified
+ *
+ * @param[in] map
+ * @param[in] key
+ * @return `void *` a pointer to the value, which may be modified in place. `NULL` if there's no such key, or if the
+ * size of a value is `0`
+ */
+void *int_map_get_ref(struct int_map *map, uint64_t key);
+
+/**
+ * @brief checks if the map contains a mapping for the key `key`
+ *
+ * @param map
+ * @param key
+ * @return true if the map contain said key
+ * @return false if the map doesn't contain said key
+ */
+bool int_map_contains(struct int_map *map, uint64_t key);
+
+/**
+ * @brief removes the mapping for `key`
+ *
+ * @param[in] map
+ * @param[in] key
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_VALUE_OK` if the operation succeded & the old value
+ * was placed into `old_value`. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error int_map_remove(struct int_map *restrict map, uint64_t key, void *restrict old_value);
+
+/**
+ * @brief calls `fn` on every element of the map, in an unspecified order. `fn` must not modify the map, though it may
+ * modify the values in place
+ *
+ * @param[in] map
+ * @param[in] fn the function to call for each element. `value` is `NULL` if the size of a value is `0`
+ * @param[in, optional] context passed as is to `fn`
+ */
+void int_map_for_each(struct int_map *map, void (*fn)(uint64_t key, void *value, void *context), void *context);
@@ -204,3 +204,68 @@ void *list_iter_end(struct list *list);
  * @return `void *` a double pointer to the the last element on the list. `NULL` if the list is empty
  */
 void *list_iter_next(struct list *restrict list, void *restrict iter);
+
+/**
+ * @brief prepends a copy of an element to the beginning of a list and returns its node. a node is the index of an
+ * element within the list's pool of nodes, which is stable until the element is removed (unlike its position). the
+ * `list_*_node` functions operate on an element through its node in `O(1)`
+ *
+ * @param[in] list
+ * @param[in] data the data to prepend
+ * @return `intmax_t` the node of the new element. `-1` if the operation failed
+ */
+intmax_t list_prepend_node(struct list *restrict list, void const *restrict data);
+
+/**
+ * @brief returns the node of the first element on a list
+ *
+ * @param[in] list
+ * @return `intmax_t` the node of the first element. `-1` if the list is empty
+ */
+intmax_t list_first_node(struct list const *list);
+
+/**
+ * @brief returns the node of the last element on a list
+ *
+ * @param[in] list
+ * @return `intmax_t` the node of the last element. `-1` if the list is empty
+ */
+intmax_t list_last_node(struct list const *list);
+
+/**
+ * @brief returns the node of the element preceding the element of `node`
+ *
+ * @param[in] list
+ * @param[in] node a node of an element on the list
+ * @return `intmax_t` the node of the previous element. `-1` if `node` is the first element or isn't valid
+ */
+intmax_t list_prev_node(struct list const *list, intmax_t node);
+
+/**
+ * @brief returns a pointer to the element of `node`
+ *
+ * @param[in] list
+ * @param[in] node a node of an element on the list
+ * @return `void *` a pointer to the element. `NULL` if `node` isn't valid
+ */
+void *list_node_data(struct list const *list, intmax_t node);
+
+/**
+ * @brief moves the element of `node` to the beginning of a list
+ *
+ * @param[in] list
+ * @param[in] node a node of an element on the list
+ * @return `true` if the operation succeeded
+ * @return `false` if `node` isn't valid
+ */
+bool list_move_first(struct list *list, intmax_t node);
+
+/**
+ * @brief removes the element of `node` from a list. the node may be reused by the elements inserted next
+ *
+ * @param[in] list
+ * @param[in] node a node of an element on the list
+ * @return `void *` a pointer to the old (removed) element. `NULL` if `node` isn't valid. said pointer must be `free`d by
+ * the caller
+ */
+void *list_remove_node(struct list *list, intmax_t node);
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+#include "hash_table.h"
+#include "list.h"
+
+/**
+ * @file lru_cache.h
+ * @brief the definition of a bounded (LRU / CLOCK) cache
+ *
+ * the cache maps keys to values like `struct hash_table` does (see the notes in `hash_table.h`), while keeping the
+ * total weight of its entries within a fixed capacity. every entry lives in a `struct list` ordered by recency, and the
+ * cache's `struct hash_table` maps each key to the node of its entry, hence getting, putting and evicting an entry are
+ * all `O(1)`. once an entry doesn't fit, the least recently used entries are evicted to make room for it.
+ *
+ * by default an entry weighs `1` (i.e. the capacity is a number of entries). a `weigh` function turns the capacity
+ * into an arbitrary budget, e.g. of bytes.
+ *
+ * `CACHE_LRU` moves an entry to the front of the list on every hit. `CACHE_CLOCK` (second chance) merely marks it as
+ * referenced. eviction then skips (and clears) the marked entries, moving them to the front instead. a hit doesn't
+ * modify the list at all, which suits read heavy workloads
+ */
+
+enum cache_policy {
+  CACHE_LRU,
+  CACHE_CLOCK,
+};
+
+/* construction parameters of `lru_cache_create`. a zero initialized object is the default */
+struct cache_options {
+  enum cache_policy policy;
+
+  // the weight of an entry. `NULL` weighs every entry as `1`
+  size_t (*weigh)(void const *key, void const *value);
+
+  // called on every entry evicted to make room for another, prior to its destruction. `context` is passed as is
+  void (*on_evict)(void const *key, void *value, void *context);
+  void *context;
+};
+
+struct lru_cache {
+  size_t _capacity;
+  size_t _weight;  // the total weight of the entries
+
+  size_t _key_size;
+  size_t _value_size;
+  size_t _key_offset;  // the offsets of the key / value within an entry
+  size_t _value_offset;
+
+  struct cache_options _options;
+
+  struct hash_table _table;  // key -> the node of its entry
+  struct list _entries;      // most recently used first
+  void *_scratch;            // an entry is built here before it's copied into the list
+
+  void (*_destroy_key)(void *);
+  void (*_destroy_value)(void *);
+};
+
+/**
+ * @brief creates a cache object `cache<K, V>`
+ *
+ * @param[in] capacity the maximal total weight of the entries. must be positive
+ * @param[in] key_size the size of every `key` in bytes
+ * @param[in] value_size the size of every `value` in bytes
+ * @param[in] cmpr a function comparing `2` keys. see `table_create`
+ * @param[in, optional] hash a function generating a hash from a key. see `table_create`
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @param[in, optional] options see `struct cache_options`. `NULL` is the default
+ * @return `struct lru_cache` cache object. a zero initialized object if the parameters are invalid
+ */
+struct lru_cache lru_cache_create(size_t capacity,
+                                  size_t key_size,
+                                  size_t value_size,
+                                  int (*cmpr)(void const *, void const *),
+                                  size_t (*hash)(void const *hashable, size_t size),
+                                  void (*destroy_key)(void *),
+                                  void (*destroy_value)(void *),
+                                  struct cache_options const *options);
+
+/**
+ * @brief destroys a cache
+ *
+ * @param[in] cache the cache to destroy. if the cache was supplied destructors for its `key` / `value` - the function
+ * will call them for each `key` / `value` pair. `on_evict` isn't called
+ */
+void lru_cache_destroy(struct lru_cache *cache);
+
+/**
+ * @brief returns the number of entries in the cache
+ *
+ * @param[in] cache
+ * @return `size_t` the number of entries the cache contains
+ */
+size_t lru_cache_size(struct lru_cache const *cache);
+
+/**
+ * @brief returns the total weight of the entries in the cache
+ *
+ * @param[in] cache
+ * @return `size_t` the total weight of the entries. never above the capacity
+ */
+size_t lru_cache_weight(struct lru_cache const *cache);
+
+/**
+ * @brief inserts `new_value` into the cache, evicting the least recently used entries until it fits. the entry of
+ * `key` becomes the most recently used
+ *
+ * @param[in] cache
+ * @param[in] key the mapping for `new_value`
+ * @param[in] new_value the value to insert into the cache
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it. otherwise the
+ * old value is destroyed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
+ * operation succeded & an old value was replaced and put into `old_value`. `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` otherwise, e.g. if the entry weighs more than the capacity of the cache
+ */
+enum ds_error lru_cache_put(struct lru_cache *restrict cache,
+                            void const *key,
+                            void const *new_value,
+                            void *restrict old_value);
+
+/**
+ * @brief gets the `value` associated with `key`. the entry of `key` becomes the most recently used
+ *
+ * @param[in] cache
+ * @param[in] key
+ * @param[out] value a pointer to the type of `value`. the value will be copied into it
+ * @return `enum ds_error` - `DS_VALUE_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such key. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error lru_cache_get(struct lru_cache *restrict cache, void const *restrict key, void *restrict value);
+
+/**
+ * @brief checks if the cache contains a mapping for the key `key`. the recency of the entry is left as is
+ *
+ * @param cache
+ * @param key
+ * @return true if the cache contain said key
+ * @return false if the cache doesn't contain said key
+ */
+bool lru_cache_contains(struct lru_cache *restrict cache, void const *restrict key);
+
+/**
+ * @brief removes the mapping for `key`. `on_evict` isn't called
+ *
+ * @param[in] cache
+ * @param[in] key
+ * @param[out, optional] old_value a pointer to the type of `value`. if such pointer isn't `NULL` the old value will be
+ * copied into it. otherwise the value is destroyed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_VALUE_OK` if the operation succeded & the old value
+ * was placed into `old_value`. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error lru_cache_remove(struct lru_cache *restrict cache, void const *restrict key, void *restrict old_value);
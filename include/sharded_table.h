@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+#include "hash_table.h"
+
+/**
+ * @file sharded_table.h
+ * @brief the definition of a sharded hash table
+ *
+ * the table splits its keys between a fixed number of shards, each a `struct hash_table` guarded by its own lock. the
+ * top bits of a key's hash pick its shard, the shard's table uses the low ones. a key is hashed exactly once per
+ * operation. threads operating on keys of different shards don't contend, and whole table operations (bulk insertion,
+ * iteration) are carried out shard by shard, taking each lock once.
+ *
+ * the table provides the same semantics as `struct hash_table` (see `hash_table.h`). unlike `struct concurrent_table`
+ * readers lock as well, though a lookup is a plain `struct hash_table` lookup once the lock is taken
+ */
+
+struct sharded_table_shard;
+
+struct sharded_table {
+  size_t _n_shards;
+  size_t _shard_bits;  // log2 of `_n_shards`
+
+  size_t _key_size;
+  size_t _value_size;
+  uint64_t _seed;
+
+  struct sharded_table_shard *_shards;
+
+  size_t (*_hash)(void const *key, size_t size);
+};
+
+/**
+ * @brief creates a sharded hash table object `map<K, V>`
+ *
+ * @param[in] n_shards the number of shards. must be a power of `2`, no larger than `1024`. `0` picks the number of
+ * online processors (rounded up to a power of `2`)
+ * @param[in] key_size  the size of every `key` in bytes
+ * @param[in] value_size  the size of every `value` in bytes
+ * @param[in] cmpr  a function comparing `2` keys. see `table_create`. must be safe to call concurrently
+ * @param[in, optional] hash - a function generating a hash from a key. see `table_create`. must be safe to call
+ * concurrently
+ * @param[in, optional] destroy_key a destructor for `key`
+ * @param[in, optional] destroy_value a destructor for `value`
+ * @param[in, optional] options the construction parameters of every shard. see `table_create_ex`. the shards always
+ * share their seed, hence `options->seed == 0` picks a single random seed for all of them. `initial_capacity` is the
+ * capacity of each shard
+ * @return `struct sharded_table` sharded hash table object. the object itself may be copied (e.g. to share it between
+ * threads), however it must be destroyed exactly once. a zero initialized object if the parameters are invalid
+ */
+struct sharded_table sharded_table_create(size_t n_shards,
+                                          size_t key_size,
+                                          size_t value_size,
+                                          int (*cmpr)(void const *, void const *),
+                                          size_t (*hash)(void const *hashable, size_t size),
+                                          void (*destroy_key)(void *),
+                                          void (*destroy_value)(void *),
+                                          struct table_options const *options);
+
+/**
+ * @brief destroys a sharded table. no other thread may use the table during (or after) its destruction
+ *
+ * @param[in] table the table to destroy. if the table was supplied destructors for its `key` / `value` - the function
+ * will call them for each `key` / `value` pair
+ */
+void sharded_table_destroy(struct sharded_table *table);
+
+/**
+ * @brief returns the number of elements in the table. under concurrent modifications the number is a snapshot which
+ * may be stale by the time it's returned
+ *
+ * @param[in] table
+ * @return `size_t` the number of elements the table contains
+ */
+size_t sharded_table_size(struct sharded_table const *table);
+
+/**
+ * @brief inserts `new_value` into the table and returns the `old_value` associated with `key` if there was any. see
+ * `table_put`
+ *
+ * @param[in] table
+ * @param[in] key the mapping for `new_value`
+ * @param[in] new_value the value to insert into the table
+ * @param[out, optional] old_value a pointer to the type of `value`. the old value will be copied into it
+ * @return `enum ds_error` - `DS_OK` if the operation succeded without replacing any old values. `DS_VALUE_OK` if the
+ * operation succeded & an old value was replaced and put into `old_value`. `DS_NO_MEM` on allocation failure.
+ * `DS_ERROR` otherwise
+ */
+enum ds_error sharded_table_put(struct sharded_table *restrict table,
+                                void const *key,
+                                void const *new_value,
+                                void *restrict old_value);
+
+/**
+ * @brief removes the mapping for `key`. see `table_remove`
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out, optional] old_value a pointer to the type of `value`. if such pointer isn't `NULL` the old value will be
+ * copied into it. otherwise the value is destroyed
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_VALUE_OK` if the operation succeded & the old value
+ * was placed into `old_value`. `DS_NOT_FOUND` if there's no such key. `DS_ERROR` otherwise
+ */
+enum ds_error sharded_table_remove(struct sharded_table *restrict table,
+                                   void const *restrict key,
+                                   void *restrict old_value);
+
+/**
+ * @brief gets the `value` associated with `key`
+ *
+ * @param[in] table
+ * @param[in] key
+ * @param[out] value a pointer to the type of `value`. the value will be copied into it
+ * @return `enum ds_error` - `DS_VALUE_OK` if the operation succeded. `DS_NOT_FOUND` if there's no such key. `DS_ERROR`
+ * otherwise
+ */
+enum ds_error sharded_table_get(struct sharded_table *restrict table, void const *restrict key, void *restrict value);
+
+/**
+ * @brief checks if the table contains a mapping for the key `key`
+ *
+ * @param table
+ * @param key
+ * @return true if the table contain said key
+ * @return false if the table doesn't contain said key
+ */
+bool sharded_table_contains(struct sharded_table *restrict table, void const *restrict key);
+
+/**
+ * @brief puts a batch of keys / values. the keys are hashed and grouped by their shard up front, then each shard is
+ * locked once and fed all of its keys. see `table_put_many`
+ *
+ * @param[in] table
+ * @param[in] keys an array of `count` keys
+ * @param[in] values an array of `count` values. `values[i]` is mapped to `keys[i]`. existing values are replaced (and
+ * destroyed)
+ * @param[in] count the number of keys
+ * @param[out, optional] status an array of `count` results. `status[i]` is set to `DS_OK` if `keys[i]` was inserted,
+ * `DS_VALUE_OK` if it replaced an existing value, `DS_NO_MEM` on allocation failure
+ * @return `size_t` the number of keys inserted (not counting the replaced values)
+ */
+size_t sharded_table_put_many(struct sharded_table *restrict table,
+                              void const *restrict keys,
+                              void const *restrict values,
+                              size_t count,
+                              enum ds_error *restrict status);
+
+/**
+ * @brief calls `fn` on every element of the table, visiting the shards in parallel: one thread per shard, each holding
+ * its shard's lock for the duration of its visit. the order of the elements is unspecified
+ *
+ * @param[in] table
+ * @param[in] fn the function to call. `fn` is called concurrently from different threads (on elements of different
+ * shards), and must not operate on the table
+ * @param[in, optional] context passed as is to `fn`
+ * @return `enum ds_error` - `DS_OK` once every element was visited. shards whose thread couldn't be started are visited
+ * by the calling thread. `DS_ERROR` if the table is invalid
+ */
+enum ds_error sharded_table_for_each(struct sharded_table *table,
+                                     void (*fn)(void const *key, void *value, void *context),
+                                     void *context);
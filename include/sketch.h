@@ -0,0 +1,187 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "defines.h"
+
+/**
+ * @file sketch.h
+ * @brief the definitions of fixed memory sketches of a stream of keys
+ *
+ * a sketch summarizes a stream of keys in memory which is set on creation and never grows, whatever the length of the
+ * stream, at the cost of approximate answers. keys are hashed with the default hash of `struct hash_table` under the
+ * sketch's seed. a hash computed elsewhere (e.g. by `table_hash`) may be given instead, as long as it's well mixed.
+ *
+ * - `struct hyperloglog` - estimates the number of distinct keys (cardinality). it keeps `2^precision` `1` byte
+ * registers, and its relative standard error is about `1.04 / sqrt(2^precision)`.
+ * - `struct count_min` - estimates the number of times each key occurred (frequency). it keeps `depth` rows of `width`
+ * counters. an estimate is never below the true count, and exceeds it by at most `e / width` of the total count with a
+ * probability of at least `1 - e^-depth`.
+ *
+ * sketches of the same dimensions and seed are mergeable: the merge of two sketches is the sketch of both streams. a
+ * stream may hence be split between threads, each adding to a sketch of its own, which are merged afterwards
+ */
+
+#define HYPERLOGLOG_MIN_PRECISION 4
+#define HYPERLOGLOG_MAX_PRECISION 18
+
+struct hyperloglog {
+  unsigned _precision;
+  uint64_t _seed;
+  uint8_t *_registers;  // `2^_precision` registers, each the highest rank seen among the hashes mapped to it
+};
+
+struct count_min {
+  size_t _width;  // a power of 2
+  size_t _depth;
+  uint64_t _seed;
+  uint64_t _total;
+  uint64_t *_counters;  // `_depth` rows of `_width` counters
+};
+
+/**
+ * @brief creates a hyperloglog object
+ *
+ * @param[in] precision the log2 of the number of registers, between `HYPERLOGLOG_MIN_PRECISION` and
+ * `HYPERLOGLOG_MAX_PRECISION`. `0` picks `14` (`16` KiB, a standard error of about `0.8%`)
+ * @param[in] seed the seed keys are hashed with
+ * @return `struct hyperloglog` sketch object. a zero initialized object on allocation failure or an invalid precision
+ */
+struct hyperloglog hyperloglog_create(unsigned precision, uint64_t seed);
+
+/**
+ * @brief destroys a hyperloglog
+ *
+ * @param[in] hll the sketch to destroy
+ */
+void hyperloglog_destroy(struct hyperloglog *hll);
+
+/**
+ * @brief adds a key to the sketch
+ *
+ * @param[in] hll
+ * @param[in] key the key
+ * @param[in] key_size the size of `key` in bytes
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error hyperloglog_add(struct hyperloglog *restrict hll, void const *restrict key, size_t key_size);
+
+/**
+ * @brief adds a key whose hash is already known to the sketch
+ *
+ * @param[in] hll
+ * @param[in] hash the hash of the key
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error hyperloglog_add_hashed(struct hyperloglog *hll, uint64_t hash);
+
+/**
+ * @brief estimates the number of distinct keys added to the sketch
+ *
+ * @param[in] hll
+ * @return `double` the estimated cardinality
+ */
+double hyperloglog_estimate(struct hyperloglog const *hll);
+
+/**
+ * @brief merges `src` into `dst`, such that `dst` becomes the sketch of the keys added to either
+ *
+ * @param[in] dst
+ * @param[in] src a sketch of the same precision and seed as `dst`. left as is
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error hyperloglog_merge(struct hyperloglog *restrict dst, struct hyperloglog const *restrict src);
+
+/**
+ * @brief removes every key from the sketch
+ *
+ * @param[in] hll
+ */
+void hyperloglog_clear(struct hyperloglog *hll);
+
+/**
+ * @brief creates a count-min sketch object
+ *
+ * @param[in] width the number of counters of each row, rounded up to a power of 2. the error of an estimate is about
+ * `e / width` of the total count
+ * @param[in] depth the number of rows. the probability an estimate errs by more than the above is about `e^-depth`
+ * @param[in] seed the seed keys are hashed with
+ * @return `struct count_min` sketch object. a zero initialized object on allocation failure or a `0` width / depth
+ */
+struct count_min count_min_create(size_t width, size_t depth, uint64_t seed);
+
+/**
+ * @brief destroys a count-min sketch
+ *
+ * @param[in] sketch the sketch to destroy
+ */
+void count_min_destroy(struct count_min *sketch);
+
+/**
+ * @brief adds `count` occurrences of a key to the sketch
+ *
+ * @param[in] sketch
+ * @param[in] key the key
+ * @param[in] key_size the size of `key` in bytes
+ * @param[in] count the number of occurrences
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error count_min_add(struct count_min *restrict sketch,
+                            void const *restrict key,
+                            size_t key_size,
+                            uint64_t count);
+
+/**
+ * @brief adds `count` occurrences of a key whose hash is already known to the sketch
+ *
+ * @param[in] sketch
+ * @param[in] hash the hash of the key
+ * @param[in] count the number of occurrences
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error count_min_add_hashed(struct count_min *sketch, uint64_t hash, uint64_t count);
+
+/**
+ * @brief estimates the number of occurrences of a key
+ *
+ * @param[in] sketch
+ * @param[in] key the key
+ * @param[in] key_size the size of `key` in bytes
+ * @return `uint64_t` the estimated count. never below the true one
+ */
+uint64_t count_min_estimate(struct count_min const *restrict sketch, void const *restrict key, size_t key_size);
+
+/**
+ * @brief estimates the number of occurrences of a key whose hash is already known
+ *
+ * @param[in] sketch
+ * @param[in] hash the hash of the key
+ * @return `uint64_t` the estimated count. never below the true one
+ */
+uint64_t count_min_estimate_hashed(struct count_min const *sketch, uint64_t hash);
+
+/**
+ * @brief returns the total number of occurrences added to the sketch
+ *
+ * @param[in] sketch
+ * @return `uint64_t` the sum of every `count` added
+ */
+uint64_t count_min_total(struct count_min const *sketch);
+
+/**
+ * @brief merges `src` into `dst`, such that `dst` becomes the sketch of the occurrences added to either
+ *
+ * @param[in] dst
+ * @param[in] src a sketch of the same width, depth and seed as `dst`. left as is
+ * @return `enum ds_error` - `DS_OK` if the operation succeded. `DS_ERROR` otherwise
+ */
+enum ds_error count_min_merge(struct count_min *restrict dst, struct count_min const *restrict src);
+
+/**
+ * @brief removes every occurrence from the sketch
+ *
+ * @param[in] sketch
+ */
+void count_min_clear(struct count_min *sketch);
@@ -0,0 +1,594 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent_table.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+
+#define CT_STRIPES 64
+#define CT_INIT_CAPACITY 64  // must be at least CT_STRIPES
+#define CT_EPOCH_SLOTS 64
+#define CT_MIGRATION_CHUNK 16
+#define CT_RECLAIM_THRESHOLD 128
+#define CACHE_LINE 64
+
+// a resize starts once a stripe holds more than 3/4 of an element per bucket it covers
+#define CT_LOAD_NUM 3
+#define CT_LOAD_DEN 4
+
+#define ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ATOMIC_LOAD_SC(ptr) __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE_SC(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define ATOMIC_ADD(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_SEQ_CST)
+#define ATOMIC_SUB(ptr, val) __atomic_fetch_sub((ptr), (val), __ATOMIC_SEQ_CST)
+
+/* a node. the key is placed at concurrent_table::_key_offset and the value at concurrent_table::_value_offset. nodes
+ * are never modified once published (except for their `next` link), a replaced value gets a new node */
+struct ct_node {
+  struct ct_node *next;
+  struct ct_node *retired_next;
+  size_t hash;
+
+  // set when the node is retired. whether reclaiming the node should destroy its key / value
+  bool destroy_key;
+  bool destroy_value;
+};
+
+/* a bucket array. during a resize `next` points at the array being migrated into, and migrated buckets point at
+ * ct_forward */
+struct ct_array {
+  size_t mask;
+  struct ct_array *next;
+  struct ct_array *retired_next;
+
+  size_t cursor;    // the next bucket to be claimed for migration
+  size_t migrated;  // the number of buckets migrated so far
+  bool stalled;     // set once a claimed bucket was left unmigrated, for lack of memory
+
+  struct ct_node *buckets[];
+};
+
+struct ct_stripe {
+  pthread_mutex_t lock;
+  size_t n_elem;
+};
+
+union ct_padded_stripe {
+  struct ct_stripe stripe;
+  char pad[CACHE_LINE * ((sizeof(struct ct_stripe) + CACHE_LINE - 1) / CACHE_LINE)];
+};
+
+/* the number of readers / writers inside a critical section, per epoch parity. threads are spread across the slots to
+ * avoid contending on a single counter */
+union ct_epoch_slot {
+  unsigned long active[2];
+  char pad[CACHE_LINE];
+};
+
+struct concurrent_table_state {
+  struct ct_array *current;
+  unsigned long epoch;
+
+  union ct_epoch_slot slots[CT_EPOCH_SLOTS];
+  union ct_padded_stripe stripes[CT_STRIPES];
+
+  pthread_mutex_t resize_lock;
+  pthread_mutex_t reclaim_lock;  // serializes reclamations
+
+  pthread_mutex_t retire_lock;  // guards the retired lists
+  struct ct_node *retired_nodes;
+  struct ct_array *retired_arrays;
+  size_t n_retired;
+};
+
+static struct ct_node ct_forward;
+#define CT_FORWARD (&ct_forward)
+
+static inline size_t ct_hash(struct concurrent_table const *table, void const *key) {
+  return table->_hash ? mix_hash(table->_hash(key, table->_key_size))
+                      : (size_t)default_hash(key, table->_key_size, table->_seed);
+}
+
+static inline void *node_key(struct concurrent_table const *table, struct ct_node *node) {
+  return (char *)node + table->_key_offset;
+}
+
+static inline void *node_value(struct concurrent_table const *table, struct ct_node *node) {
+  return (char *)node + table->_value_offset;
+}
+
+static inline struct ct_stripe *stripe_of(struct concurrent_table_state *state, size_t hash) {
+  return &state->stripes[hash & (CT_STRIPES - 1)].stripe;
+}
+
+/* epoch based reclamation. a thread enters a critical section by announcing itself on the counter of the current
+ * epoch's parity. reclaiming flips the epoch, and waits for the counters of the previous parity to drain: from that
+ * point on no thread can still observe what was retired before the flip */
+
+static unsigned long epoch_enter(struct concurrent_table_state *state) {
+  char local;  // threads run on different stacks, which makes for a cheap thread identifier
+  size_t slot = mix_hash((size_t)((uintptr_t)&local >> 16)) & (CT_EPOCH_SLOTS - 1);
+
+  for (;;) {
+    unsigned long epoch = ATOMIC_LOAD_SC(&state->epoch);
+    ATOMIC_ADD(&state->slots[slot].active[epoch & 1], 1);
+
+    // the epoch flipped in the meantime. a reclamation might not have waited for this thread
+    if (ATOMIC_LOAD_SC(&state->epoch) == epoch) return slot << 1 | (epoch & 1);
+
+    ATOMIC_SUB(&state->slots[slot].active[epoch & 1], 1);
+  }
+}
+
+static void epoch_exit(struct concurrent_table_state *state, unsigned long token) {
+  ATOMIC_SUB(&state->slots[token >> 1].active[token & 1], 1);
+}
+
+/* used internally to wait until every critical section which started prior to the call is done. the caller must hold
+ * concurrent_table_state::reclaim_lock and must not be inside a critical section */
+static void epoch_synchronize(struct concurrent_table_state *state) {
+  unsigned long epoch = ATOMIC_LOAD_SC(&state->epoch);
+  ATOMIC_STORE_SC(&state->epoch, epoch + 1);
+
+  for (size_t slot = 0; slot < CT_EPOCH_SLOTS; slot++) {
+    while (ATOMIC_LOAD_SC(&state->slots[slot].active[epoch & 1])) sched_yield();
+  }
+}
+
+static void node_destroy(struct concurrent_table *table, struct ct_node *node) {
+  if (node->destroy_key && table->_destroy_key) table->_destroy_key(node_key(table, node));
+  if (node->destroy_value && table->_destroy_value) table->_destroy_value(node_value(table, node));
+  free(node);
+}
+
+static void retire_node(struct concurrent_table_state *state, struct ct_node *node) {
+  pthread_mutex_lock(&state->retire_lock);
+  node->retired_next = state->retired_nodes;
+  state->retired_nodes = node;
+  ATOMIC_STORE(&state->n_retired, state->n_retired + 1);
+  pthread_mutex_unlock(&state->retire_lock);
+}
+
+static void retire_array(struct concurrent_table_state *state, struct ct_array *array) {
+  pthread_mutex_lock(&state->retire_lock);
+  array->retired_next = state->retired_arrays;
+  state->retired_arrays = array;
+  ATOMIC_STORE(&state->n_retired, state->n_retired + 1);
+  pthread_mutex_unlock(&state->retire_lock);
+}
+
+/* used internally to free whatever was retired, once it's safe to do so. unless `force` is set the function returns
+ * right away if there isn't much to reclaim or if another thread is already reclaiming */
+static void reclaim(struct concurrent_table *table, bool force) {
+  struct concurrent_table_state *state = table->_state;
+  if (!force && ATOMIC_LOAD(&state->n_retired) < CT_RECLAIM_THRESHOLD) return;
+
+  if (force) {
+    pthread_mutex_lock(&state->reclaim_lock);
+  } else if (pthread_mutex_trylock(&state->reclaim_lock) != 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&state->retire_lock);
+  struct ct_node *nodes = state->retired_nodes;
+  struct ct_array *arrays = state->retired_arrays;
+  state->retired_nodes = NULL;
+  state->retired_arrays = NULL;
+  ATOMIC_STORE(&state->n_retired, 0);
+  pthread_mutex_unlock(&state->retire_lock);
+
+  epoch_synchronize(state);
+
+  while (nodes) {
+    struct ct_node *next = nodes->retired_next;
+    node_destroy(table, nodes);
+    nodes = next;
+  }
+
+  while (arrays) {
+    struct ct_array *next = arrays->retired_next;
+    free(arrays);
+    arrays = next;
+  }
+
+  pthread_mutex_unlock(&state->reclaim_lock);
+}
+
+static struct ct_array *array_create(size_t capacity) {
+  struct ct_array *array = calloc(1, sizeof *array + capacity * sizeof(struct ct_node *));
+  if (!array) return NULL;
+
+  array->mask = capacity - 1;
+  return array;
+}
+
+/* used internally to create a node holding copies of `key` and `value` */
+static struct ct_node *node_create(struct concurrent_table const *table,
+                                   size_t hash,
+                                   void const *key,
+                                   void const *value) {
+  struct ct_node *node = malloc(table->_value_offset + table->_value_size);
+  if (!node) return NULL;
+
+  *node = (struct ct_node){.hash = hash};
+  memcpy(node_key(table, node), key, table->_key_size);
+  if (table->_value_size) memcpy(node_value(table, node), value, table->_value_size);
+  return node;
+}
+
+/* used internally to migrate a single bucket of `array` into `array::next`. the nodes are copied rather than relinked,
+ * as readers might be traversing the old chain. returns `DS_OK` if the bucket was migrated, `DS_NOT_FOUND` if it was
+ * migrated already, or `DS_NO_MEM` if there's no memory to copy its nodes, in which case the bucket is left as is */
+static enum ds_error migrate_bucket(struct concurrent_table *table, struct ct_array *array, size_t pos) {
+  struct concurrent_table_state *state = table->_state;
+  struct ct_array *next = ATOMIC_LOAD(&array->next);
+  struct ct_stripe *stripe = stripe_of(state, pos);
+
+  pthread_mutex_lock(&stripe->lock);
+  if (ATOMIC_LOAD(&array->buckets[pos]) == CT_FORWARD) {
+    pthread_mutex_unlock(&stripe->lock);
+    return DS_NOT_FOUND;
+  }
+
+  struct ct_node *low = NULL, *high = NULL;
+  bool success = true;
+  for (struct ct_node *node = ATOMIC_LOAD(&array->buckets[pos]); node; node = ATOMIC_LOAD(&node->next)) {
+    struct ct_node *copy = node_create(table, node->hash, node_key(table, node), node_value(table, node));
+    if (!copy) {
+      success = false;
+      break;
+    }
+
+    struct ct_node **target = node->hash & (array->mask + 1) ? &high : &low;
+    copy->next = *target;
+    *target = copy;
+  }
+
+  if (success) {
+    // nothing reads the new buckets before the old one is forwarded
+    ATOMIC_STORE(&next->buckets[pos], low);
+    ATOMIC_STORE(&next->buckets[pos + array->mask + 1], high);
+
+    struct ct_node *old = ATOMIC_LOAD(&array->buckets[pos]);
+    ATOMIC_STORE(&array->buckets[pos], CT_FORWARD);
+
+    // ownership of the keys / values moved to the copies
+    while (old) {
+      struct ct_node *old_next = old->next;
+      retire_node(state, old);
+      old = old_next;
+    }
+  }
+
+  pthread_mutex_unlock(&stripe->lock);
+  if (success) return DS_OK;
+
+  // out of memory. release the copies made so far, the bucket remains in the old array
+  struct ct_node *chains[] = {low, high};
+  for (size_t i = 0; i < 2; i++) {
+    while (chains[i]) {
+      struct ct_node *tmp = chains[i]->next;
+      free(chains[i]);
+      chains[i] = tmp;
+    }
+  }
+  return DS_NO_MEM;
+}
+
+/* used internally to migrate a chunk of buckets if a resize is in progress. whoever migrates the last bucket publishes
+ * the new array. a helper which runs out of memory abandons the rest of its chunk (the table remains consistent, the
+ * abandoned buckets are merely not forwarded yet) and marks the migration as stalled. once every chunk was claimed, the
+ * helpers of a stalled migration pick up the abandoned buckets instead. the caller must be inside a critical section
+ * and must not hold any stripe lock */
+static void help_resize(struct concurrent_table *table) {
+  struct concurrent_table_state *state = table->_state;
+  struct ct_array *array = ATOMIC_LOAD(&state->current);
+  if (!ATOMIC_LOAD(&array->next)) return;
+
+  size_t capacity = array->mask + 1;
+  size_t start = ATOMIC_ADD(&array->cursor, CT_MIGRATION_CHUNK);
+  size_t end = capacity;
+  if (start < capacity) {
+    if (capacity - start > CT_MIGRATION_CHUNK) end = start + CT_MIGRATION_CHUNK;
+  } else if (ATOMIC_LOAD(&array->stalled)) {
+    start = 0;
+  } else {
+    return;
+  }
+
+  size_t migrated = 0;
+  for (size_t pos = start; pos < end && migrated < CT_MIGRATION_CHUNK; pos++) {
+    if (ATOMIC_LOAD(&array->buckets[pos]) == CT_FORWARD) continue;
+
+    enum ds_error ret = migrate_bucket(table, array, pos);
+    if (ret == DS_NO_MEM) {
+      ATOMIC_STORE(&array->stalled, true);
+      break;
+    }
+    if (ret == DS_OK) migrated++;
+  }
+
+  if (migrated && ATOMIC_ADD(&array->migrated, migrated) + migrated == capacity) {
+    ATOMIC_STORE(&state->current, ATOMIC_LOAD(&array->next));
+    retire_array(state, array);
+  }
+}
+
+/* used internally to start a resize, unless one is already in progress */
+static void begin_resize(struct concurrent_table *table) {
+  struct concurrent_table_state *state = table->_state;
+  if (pthread_mutex_trylock(&state->resize_lock) != 0) return;
+
+  struct ct_array *array = ATOMIC_LOAD(&state->current);
+  if (!ATOMIC_LOAD(&array->next) && (SIZE_MAX >> 1) / sizeof(struct ct_node *) > (array->mask + 1) << 1) {
+    struct ct_array *next = array_create((array->mask + 1) << 1);
+    if (next) ATOMIC_STORE(&array->next, next);
+  }
+
+  pthread_mutex_unlock(&state->resize_lock);
+}
+
+/* used internally to get the bucket `hash` maps to, following forwarded buckets. the caller must hold the stripe lock of
+ * `hash`, which keeps the bucket from being migrated */
+static struct ct_node **locate_bucket(struct concurrent_table_state *state, size_t hash, struct ct_array **array) {
+  struct ct_array *curr = ATOMIC_LOAD(&state->current);
+
+  for (;;) {
+    struct ct_node **bucket = &curr->buckets[hash & curr->mask];
+    if (ATOMIC_LOAD(bucket) != CT_FORWARD) {
+      *array = curr;
+      return bucket;
+    }
+
+    curr = ATOMIC_LOAD(&curr->next);
+  }
+}
+
+/* used internally to find the link pointing at the node holding `key`. returns NULL if there's no such node */
+static struct ct_node **find_link(struct concurrent_table *table, struct ct_node **bucket, size_t hash, void const *key) {
+  for (struct ct_node **link = bucket; *link; link = &(*link)->next) {
+    struct ct_node *node = *link;
+    if (node->hash == hash && table->_cmpr(key, node_key(table, node)) == 0) return link;
+  }
+
+  return NULL;
+}
+
+struct concurrent_table concurrent_table_create(size_t key_size,
+                                                size_t value_size,
+                                                int (*cmpr)(void const *, void const *),
+                                                size_t (*hash)(void const *hashable, size_t size),
+                                                void (*destroy_key)(void *),
+                                                void (*destroy_value)(void *)) {
+  if (!key_size) goto empty_table;
+  if (!cmpr) goto empty_table;
+
+  struct concurrent_table_state *state = NULL;
+  if (posix_memalign((void **)&state, CACHE_LINE, sizeof *state) != 0) goto empty_table;
+  memset(state, 0, sizeof *state);
+
+  state->current = array_create(CT_INIT_CAPACITY);
+  if (!state->current) {
+    free(state);
+    goto empty_table;
+  }
+
+  pthread_mutex_init(&state->resize_lock, NULL);
+  pthread_mutex_init(&state->reclaim_lock, NULL);
+  pthread_mutex_init(&state->retire_lock, NULL);
+  for (size_t i = 0; i < CT_STRIPES; i++) { pthread_mutex_init(&state->stripes[i].stripe.lock, NULL); }
+
+  size_t key_offset = table_align(sizeof(struct ct_node));
+  return (struct concurrent_table){._cmpr = cmpr,
+                                   ._destroy_key = destroy_key,
+                                   ._destroy_value = destroy_value,
+                                   ._hash = hash,
+                                   ._key_offset = key_offset,
+                                   ._key_size = key_size,
+                                   ._seed = table_random_seed(),
+                                   ._state = state,
+                                   ._value_offset = key_offset + table_align(key_size),
+                                   ._value_size = value_size};
+
+empty_table:
+  return (struct concurrent_table){0};
+}
+
+static void chain_destroy(struct concurrent_table *table, struct ct_node *node) {
+  while (node) {
+    struct ct_node *next = node->next;
+    node->destroy_key = node->destroy_value = true;
+    node_destroy(table, node);
+    node = next;
+  }
+}
+
+void concurrent_table_destroy(struct concurrent_table *table) {
+  if (!table || !table->_state) return;
+
+  struct concurrent_table_state *state = table->_state;
+  reclaim(table, true);
+
+  for (struct ct_array *array = state->current; array;) {
+    for (size_t pos = 0; pos <= array->mask; pos++) {
+      if (array->buckets[pos] != CT_FORWARD) chain_destroy(table, array->buckets[pos]);
+    }
+
+    struct ct_array *next = array->next;
+    free(array);
+    array = next;
+  }
+
+  pthread_mutex_destroy(&state->resize_lock);
+  pthread_mutex_destroy(&state->reclaim_lock);
+  pthread_mutex_destroy(&state->retire_lock);
+  for (size_t i = 0; i < CT_STRIPES; i++) { pthread_mutex_destroy(&state->stripes[i].stripe.lock); }
+
+  free(state);
+  table->_state = NULL;
+}
+
+size_t concurrent_table_size(struct concurrent_table const *table) {
+  if (!table || !table->_state) return 0;
+
+  size_t n_elem = 0;
+  for (size_t i = 0; i < CT_STRIPES; i++) { n_elem += ATOMIC_LOAD(&table->_state->stripes[i].stripe.n_elem); }
+  return n_elem;
+}
+
+enum ds_error concurrent_table_put(struct concurrent_table *restrict table,
+                                   void const *key,
+                                   void const *new_value,
+                                   void *restrict old_value) {
+  if (!table || !table->_state) return DS_ERROR;
+  if (!key || (!new_value && table->_value_size)) return DS_ERROR;
+
+  struct concurrent_table_state *state = table->_state;
+  size_t hash = ct_hash(table, key);
+
+  unsigned long token = epoch_enter(state);
+  help_resize(table);
+
+  struct ct_stripe *stripe = stripe_of(state, hash);
+  pthread_mutex_lock(&stripe->lock);
+
+  struct ct_array *array;
+  struct ct_node **bucket = locate_bucket(state, hash, &array);
+  struct ct_node **link = find_link(table, bucket, hash, key);
+
+  enum ds_error ret = DS_OK;
+  bool grow = false;
+  if (link) {
+    // the value is replaced by a new node. readers of the old node keep seeing the old value
+    struct ct_node *old = *link;
+    struct ct_node *node = node_create(table, hash, node_key(table, old), new_value);
+    if (!node) {
+      ret = DS_NO_MEM;
+    } else {
+      node->next = old->next;
+      ATOMIC_STORE(link, node);
+
+      if (old_value) {
+        if (table->_value_size) memcpy(old_value, node_value(table, old), table->_value_size);
+        ret = DS_VALUE_OK;
+      } else {
+        old->destroy_value = table->_value_size != 0;
+      }
+      retire_node(state, old);
+    }
+  } else {
+    struct ct_node *node = node_create(table, hash, key, new_value);
+    if (!node) {
+      ret = DS_NO_MEM;
+    } else {
+      node->next = *bucket;
+      ATOMIC_STORE(bucket, node);
+      ATOMIC_STORE(&stripe->n_elem, stripe->n_elem + 1);
+
+      size_t stripe_buckets = (array->mask + 1) / CT_STRIPES;
+      grow = stripe->n_elem * CT_LOAD_DEN > stripe_buckets * CT_LOAD_NUM;
+    }
+  }
+
+  pthread_mutex_unlock(&stripe->lock);
+
+  if (grow) begin_resize(table);
+  epoch_exit(state, token);
+  reclaim(table, false);
+
+  return ret;
+}
+
+enum ds_error concurrent_table_remove(struct concurrent_table *restrict table,
+                                      void const *restrict key,
+                                      void *restrict old_value) {
+  if (!table || !table->_state) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  struct concurrent_table_state *state = table->_state;
+  size_t hash = ct_hash(table, key);
+
+  unsigned long token = epoch_enter(state);
+  help_resize(table);
+
+  struct ct_stripe *stripe = stripe_of(state, hash);
+  pthread_mutex_lock(&stripe->lock);
+
+  struct ct_array *array;
+  struct ct_node **link = find_link(table, locate_bucket(state, hash, &array), hash, key);
+
+  enum ds_error ret = DS_NOT_FOUND;
+  if (link) {
+    struct ct_node *removed = *link;
+    ATOMIC_STORE(link, removed->next);
+    ATOMIC_STORE(&stripe->n_elem, stripe->n_elem - 1);
+
+    removed->destroy_key = true;
+    if (old_value) {
+      if (table->_value_size) memcpy(old_value, node_value(table, removed), table->_value_size);
+      ret = DS_VALUE_OK;
+    } else {
+      removed->destroy_value = table->_value_size != 0;
+      ret = DS_OK;
+    }
+    retire_node(state, removed);
+  }
+
+  pthread_mutex_unlock(&stripe->lock);
+  epoch_exit(state, token);
+  reclaim(table, false);
+
+  return ret;
+}
+
+/* used internally to find the node holding `key` without locking. the caller must be inside a critical section */
+static struct ct_node *lockless_find(struct concurrent_table *table, size_t hash, void const *key) {
+  struct ct_array *array = ATOMIC_LOAD(&table->_state->current);
+
+  struct ct_node *node = ATOMIC_LOAD(&array->buckets[hash & array->mask]);
+  while (node == CT_FORWARD) {
+    array = ATOMIC_LOAD(&array->next);
+    node = ATOMIC_LOAD(&array->buckets[hash & array->mask]);
+  }
+
+  for (; node; node = ATOMIC_LOAD(&node->next)) {
+    if (node->hash == hash && table->_cmpr(key, node_key(table, node)) == 0) return node;
+  }
+
+  return NULL;
+}
+
+enum ds_error concurrent_table_get(struct concurrent_table *restrict table,
+                                   void const *restrict key,
+                                   void *restrict value) {
+  if (!table || !table->_state) return DS_ERROR;
+  if (!key || !value) return DS_ERROR;
+
+  size_t hash = ct_hash(table, key);
+
+  unsigned long token = epoch_enter(table->_state);
+  struct ct_node *node = lockless_find(table, hash, key);
+  if (node && table->_value_size) memcpy(value, node_value(table, node), table->_value_size);
+  epoch_exit(table->_state, token);
+
+  return node ? DS_VALUE_OK : DS_NOT_FOUND;
+}
+
+bool concurrent_table_contains(struct concurrent_table *restrict table, void const *restrict key) {
+  if (!table || !table->_state) return false;
+  if (!key) return false;
+
+  size_t hash = ct_hash(table, key);
+
+  unsigned long token = epoch_enter(table->_state);
+  bool found = lockless_find(table, hash, key) != NULL;
+  epoch_exit(table->_state, token);
+
+  return found;
+}
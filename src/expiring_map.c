@@ -0,0 +1,316 @@
+#include "expiring_map.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+/* an entry, as scheduled on the wheel. the key and the value follow it (at `_key_offset` and `_value_offset`) */
+struct expiring_timer {
+  struct expiring_timer *next;
+  struct expiring_timer *prev;
+  uint64_t deadline;
+  size_t slot;  // `level * WHEEL_SLOTS + slot` of the list holding the timer
+};
+
+static inline void *timer_key(struct expiring_map const *map, struct expiring_timer *timer) {
+  return (char *)timer + map->_key_offset;
+}
+
+static inline void *timer_value(struct expiring_map const *map, struct expiring_timer *timer) {
+  return (char *)timer + map->_value_offset;
+}
+
+/* used internally to get the index of the highest set bit. the function assumes bits != 0 */
+static inline unsigned high_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - (unsigned)__builtin_clzll(bits);
+#else
+  unsigned idx = 0;
+  for (; bits >>= 1;) idx++;
+  return idx;
+#endif
+}
+
+/* used internally to get the index of the lowest set bit. the function assumes bits != 0 */
+static inline unsigned low_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(bits);
+#else
+  unsigned idx = 0;
+  for (; !(bits & 1); bits >>= 1) idx++;
+  return idx;
+#endif
+}
+
+/* used internally to link `timer` into the slot its deadline falls into, relative to the current time. the function
+ * assumes the deadline is later than the current time */
+static void schedule(struct expiring_map *map, struct expiring_timer *timer) {
+  unsigned level = high_bit(timer->deadline ^ map->_now) / WHEEL_BITS;
+  size_t slot = (size_t)(timer->deadline >> (level * WHEEL_BITS) & WHEEL_MASK);
+
+  timer->slot = level * WHEEL_SLOTS + slot;
+  timer->prev = NULL;
+  timer->next = map->_wheel[timer->slot];
+  if (timer->next) timer->next->prev = timer;
+
+  map->_wheel[timer->slot] = timer;
+  map->_occupied[level] |= 1ull << slot;
+}
+
+/* used internally to unlink `timer` from its slot */
+static void unschedule(struct expiring_map *map, struct expiring_timer *timer) {
+  if (timer->prev) {
+    timer->prev->next = timer->next;
+  } else {
+    map->_wheel[timer->slot] = timer->next;
+  }
+  if (timer->next) timer->next->prev = timer->prev;
+
+  if (!map->_wheel[timer->slot]) map->_occupied[timer->slot / WHEEL_SLOTS] &= ~(1ull << (timer->slot & WHEEL_MASK));
+}
+
+/* used internally to release a timer which was removed from both the table and the wheel. the value is either copied
+ * into `old_value` or destroyed */
+static enum ds_error release_timer(struct expiring_map *map, struct expiring_timer *timer, void *old_value) {
+  enum ds_error ret = DS_OK;
+  if (old_value) {
+    if (map->_value_size) memcpy(old_value, timer_value(map, timer), map->_value_size);
+    ret = DS_VALUE_OK;
+  } else if (map->_destroy_value) {
+    map->_destroy_value(timer_value(map, timer));
+  }
+
+  if (map->_destroy_key) map->_destroy_key(timer_key(map, timer));
+
+  free(timer);
+  return ret;
+}
+
+/* used internally to expire a timer which was already unlinked from the wheel */
+static void expire(struct expiring_map *map, struct expiring_timer *timer) {
+  if (map->_options.on_expire) {
+    map->_options.on_expire(timer_key(map, timer), timer_value(map, timer), map->_options.context);
+  }
+
+  table_remove(&map->_table, timer_key(map, timer), NULL);
+  release_timer(map, timer, NULL);
+}
+
+/* used internally to find the time the next non empty slot comes due at. every non empty slot of a level lies past the
+ * current time's slot on said level, within the same slot of the level above it */
+static bool next_due(struct expiring_map const *map, uint64_t *due) {
+  bool found = false;
+  for (unsigned level = 0; level < EXPIRING_MAP_LEVELS; level++) {
+    unsigned shift = level * WHEEL_BITS;
+    unsigned pos = (unsigned)(map->_now >> shift & WHEEL_MASK);
+    uint64_t later = pos == WHEEL_MASK ? 0 : map->_occupied[level] & ~0ull << (pos + 1);
+    if (!later) continue;
+
+    uint64_t base = shift + WHEEL_BITS < 64 ? map->_now >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS) : 0;
+    uint64_t at = base | (uint64_t)low_bit(later) << shift;
+    if (!found || at < *due) *due = at;
+    found = true;
+  }
+
+  return found;
+}
+
+/* used internally to empty every slot which comes due at the current time, from the highest level down. a timer is
+ * either expired or moved to a lower level, which is emptied right after if it's due as well */
+static size_t fire(struct expiring_map *map) {
+  size_t expired = 0;
+  for (unsigned level = EXPIRING_MAP_LEVELS; level-- > 0;) {
+    unsigned shift = level * WHEEL_BITS;
+    if (map->_now & ((1ull << shift) - 1)) continue;  // the slots of a level start at the multiples of `64^level`
+
+    size_t slot = (size_t)(map->_now >> shift & WHEEL_MASK);
+    if (!(map->_occupied[level] >> slot & 1)) continue;
+
+    struct expiring_timer *timer = map->_wheel[level * WHEEL_SLOTS + slot];
+    map->_wheel[level * WHEEL_SLOTS + slot] = NULL;
+    map->_occupied[level] &= ~(1ull << slot);
+
+    while (timer) {
+      struct expiring_timer *next = timer->next;
+      if (timer->deadline <= map->_now) {
+        expire(map, timer);
+        expired++;
+      } else {
+        schedule(map, timer);
+      }
+      timer = next;
+    }
+  }
+
+  return expired;
+}
+
+/* used internally to get the timer of `key`. a timer which is due by `now` is expired on the spot */
+static struct expiring_timer *find_live(struct expiring_map *map, void const *key, uint64_t now) {
+  struct expiring_timer *timer = NULL;
+  if (table_get(&map->_table, key, &timer) != DS_VALUE_OK) return NULL;
+  if (timer->deadline > now) return timer;
+
+  unschedule(map, timer);
+  expire(map, timer);
+  return NULL;
+}
+
+struct expiring_map expiring_map_create(size_t key_size,
+                                        size_t value_size,
+                                        int (*cmpr)(void const *, void const *),
+                                        size_t (*hash)(void const *hashable, size_t size),
+                                        void (*destroy_key)(void *),
+                                        void (*destroy_value)(void *),
+                                        uint64_t now,
+                                        struct expiring_map_options const *options) {
+  if (!key_size) goto empty_map;
+  if (!cmpr) goto empty_map;
+
+  size_t key_offset = table_align(sizeof(struct expiring_timer));
+  size_t value_offset = key_offset + table_align(key_size);
+
+  // the table holds the keys and their timers. the timers own the keys
+  struct hash_table table = table_create(key_size, sizeof(struct expiring_timer *), cmpr, hash, NULL, NULL);
+  struct expiring_timer **wheel = calloc(EXPIRING_MAP_LEVELS * WHEEL_SLOTS, sizeof *wheel);
+  if (!vec_data(&table._entries) || !wheel) {
+    table_destroy(&table);
+    free(wheel);
+    goto empty_map;
+  }
+
+  return (struct expiring_map){._destroy_key = destroy_key,
+                               ._destroy_value = destroy_value,
+                               ._key_offset = key_offset,
+                               ._key_size = key_size,
+                               ._now = now,
+                               ._options = options ? *options : (struct expiring_map_options){0},
+                               ._table = table,
+                               ._value_offset = value_offset,
+                               ._value_size = value_size,
+                               ._wheel = wheel};
+
+empty_map:
+  return (struct expiring_map){0};
+}
+
+void expiring_map_destroy(struct expiring_map *map) {
+  if (!map || !map->_wheel) return;
+
+  for (size_t slot = 0; slot < EXPIRING_MAP_LEVELS * WHEEL_SLOTS; slot++) {
+    for (struct expiring_timer *timer = map->_wheel[slot], *next; timer; timer = next) {
+      next = timer->next;
+      release_timer(map, timer, NULL);
+    }
+  }
+
+  table_destroy(&map->_table);
+  free(map->_wheel);
+  *map = (struct expiring_map){0};
+}
+
+size_t expiring_map_size(struct expiring_map const *map) {
+  return map && map->_wheel ? table_size(&map->_table) : 0;
+}
+
+uint64_t expiring_map_now(struct expiring_map const *map) {
+  return map ? map->_now : 0;
+}
+
+enum ds_error expiring_map_put(struct expiring_map *restrict map,
+                               void const *key,
+                               void const *new_value,
+                               uint64_t deadline,
+                               void *restrict old_value) {
+  if (!map || !map->_wheel) return DS_ERROR;
+  if (!key || (!new_value && map->_value_size)) return DS_ERROR;
+  if (deadline <= map->_now) return DS_ERROR;
+
+  struct expiring_timer *timer = NULL;
+  if (table_get(&map->_table, key, &timer) == DS_VALUE_OK) {
+    enum ds_error ret = DS_OK;
+    if (old_value) {
+      if (map->_value_size) memcpy(old_value, timer_value(map, timer), map->_value_size);
+      ret = DS_VALUE_OK;
+    } else if (map->_destroy_value) {
+      map->_destroy_value(timer_value(map, timer));
+    }
+    if (map->_value_size) memcpy(timer_value(map, timer), new_value, map->_value_size);
+
+    unschedule(map, timer);
+    timer->deadline = deadline;
+    schedule(map, timer);
+    return ret;
+  }
+
+  timer = malloc(map->_value_offset + map->_value_size);
+  if (!timer) return DS_NO_MEM;
+
+  timer->deadline = deadline;
+  memcpy(timer_key(map, timer), key, map->_key_size);
+  if (map->_value_size) memcpy(timer_value(map, timer), new_value, map->_value_size);
+
+  enum ds_error ret = table_put(&map->_table, key, &timer, NULL);
+  if (ret != DS_OK) {
+    free(timer);
+    return ret;
+  }
+
+  schedule(map, timer);
+  return DS_OK;
+}
+
+enum ds_error expiring_map_get(struct expiring_map *restrict map,
+                               void const *restrict key,
+                               uint64_t now,
+                               void *restrict value) {
+  if (!map || !map->_wheel) return DS_ERROR;
+  if (!key || (!value && map->_value_size)) return DS_ERROR;
+
+  struct expiring_timer *timer = find_live(map, key, now);
+  if (!timer) return DS_NOT_FOUND;
+
+  if (map->_value_size) memcpy(value, timer_value(map, timer), map->_value_size);
+  return DS_VALUE_OK;
+}
+
+bool expiring_map_contains(struct expiring_map *restrict map, void const *restrict key, uint64_t now) {
+  if (!map || !map->_wheel) return false;
+  if (!key) return false;
+
+  return find_live(map, key, now) != NULL;
+}
+
+enum ds_error expiring_map_remove(struct expiring_map *restrict map,
+                                  void const *restrict key,
+                                  void *restrict old_value) {
+  if (!map || !map->_wheel) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  struct expiring_timer *timer = NULL;
+  if (table_remove(&map->_table, key, &timer) != DS_VALUE_OK) return DS_NOT_FOUND;
+
+  unschedule(map, timer);
+  return release_timer(map, timer, old_value);
+}
+
+size_t expiring_map_advance(struct expiring_map *map, uint64_t now) {
+  if (!map || !map->_wheel) return 0;
+
+  // every slot due in between is emptied in order, skipping the empty ones
+  size_t expired = 0;
+  uint64_t due = 0;
+  while (map->_now < now && next_due(map, &due) && due <= now) {
+    map->_now = due;
+    expired += fire(map);
+  }
+
+  if (now > map->_now) map->_now = now;
+  return expired;
+}
@@ -0,0 +1,247 @@
+#include "filter.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+#define BLOOM_WORDS 8  // the words of a block, a single bit is set in each
+#define BLOOM_BLOCK_BITS (BLOOM_WORDS * 64)
+#define BLOOM_DEFAULT_BITS 10
+
+#define CUCKOO_SLOTS 4      // the fingerprints of a bucket
+#define CUCKOO_MAX_LOAD 0.9  // the fraction of the slots the filter is sized to fill
+#define CUCKOO_MAX_KICKS 500
+
+/* odd multipliers, each picking the bit a key sets in one word of a block */
+static uint32_t const BLOOM_SALTS[BLOOM_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+/* used internally to spread the bits of a hash. a table only relies on some of its hash's bits (e.g. the low ones),
+ * whereas a filter needs all of them */
+static inline uint64_t filter_mix(size_t hash) {
+  uint64_t h = (uint64_t)hash;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+/* used internally to get the smallest power of 2 which isn't below `count`. returns 0 if there's no such power */
+static size_t power_of_2_for(size_t count) {
+  size_t power = 1;
+  while (power < count) {
+    if (power > SIZE_MAX / 2) return 0;
+    power <<= 1;
+  }
+
+  return power;
+}
+
+struct bloom_filter bloom_filter_create(size_t capacity, size_t bits_per_key) {
+  if (!bits_per_key) bits_per_key = BLOOM_DEFAULT_BITS;
+  if (capacity && bits_per_key > SIZE_MAX / capacity) goto empty_filter;
+
+  size_t n_blocks = power_of_2_for(capacity * bits_per_key / BLOOM_BLOCK_BITS + 1);
+  if (!n_blocks || n_blocks > (SIZE_MAX - CACHE_LINE) / CACHE_LINE) goto empty_filter;
+
+  // the blocks are aligned by hand, as C99 has no aligned allocation
+  void *allocation = calloc(1, n_blocks * CACHE_LINE + CACHE_LINE);
+  if (!allocation) goto empty_filter;
+
+  uintptr_t aligned = ((uintptr_t)allocation + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+  return (struct bloom_filter){._allocation = allocation, ._blocks = (uint64_t *)aligned, ._n_blocks = n_blocks};
+
+empty_filter:
+  return (struct bloom_filter){0};
+}
+
+void bloom_filter_destroy(struct bloom_filter *filter) {
+  if (!filter) return;
+
+  free(filter->_allocation);
+  *filter = (struct bloom_filter){0};
+}
+
+size_t bloom_filter_size(struct bloom_filter const *filter) {
+  return filter ? filter->_n_elem : 0;
+}
+
+/* used internally to get the block of a mixed hash. the high bits pick the block, the low ones the bits within it */
+static inline uint64_t *bloom_block(struct bloom_filter const *filter, uint64_t h) {
+  return filter->_blocks + ((size_t)(h >> 32) & (filter->_n_blocks - 1)) * BLOOM_WORDS;
+}
+
+enum ds_error bloom_filter_add(struct bloom_filter *filter, size_t hash) {
+  if (!filter || !filter->_blocks) return DS_ERROR;
+
+  uint64_t h = filter_mix(hash);
+  uint64_t *block = bloom_block(filter, h);
+  for (size_t w = 0; w < BLOOM_WORDS; w++) { block[w] |= 1ull << ((uint32_t)h * BLOOM_SALTS[w] >> 26); }
+
+  filter->_n_elem++;
+  return DS_OK;
+}
+
+bool bloom_filter_contains(struct bloom_filter const *filter, size_t hash) {
+  if (!filter || !filter->_blocks) return false;
+
+  uint64_t h = filter_mix(hash);
+  uint64_t const *block = bloom_block(filter, h);
+
+  // every word is checked, without branching on each of them
+  uint64_t missing = 0;
+  for (size_t w = 0; w < BLOOM_WORDS; w++) { missing |= ~block[w] & 1ull << ((uint32_t)h * BLOOM_SALTS[w] >> 26); }
+  return !missing;
+}
+
+void bloom_filter_clear(struct bloom_filter *filter) {
+  if (!filter || !filter->_blocks) return;
+
+  memset(filter->_blocks, 0, filter->_n_blocks * CACHE_LINE);
+  filter->_n_elem = 0;
+}
+
+struct cuckoo_filter cuckoo_filter_create(size_t capacity) {
+  size_t n_buckets = power_of_2_for((size_t)((double)capacity / (CUCKOO_SLOTS * CUCKOO_MAX_LOAD)) + 1);
+  if (!n_buckets || n_buckets > SIZE_MAX / (CUCKOO_SLOTS * sizeof(uint16_t))) goto empty_filter;
+
+  uint16_t *buckets = calloc(n_buckets * CUCKOO_SLOTS, sizeof *buckets);
+  if (!buckets) goto empty_filter;
+
+  return (struct cuckoo_filter){._buckets = buckets, ._n_buckets = n_buckets, ._rng = 0x9e3779b97f4a7c15ull};
+
+empty_filter:
+  return (struct cuckoo_filter){0};
+}
+
+void cuckoo_filter_destroy(struct cuckoo_filter *filter) {
+  if (!filter) return;
+
+  free(filter->_buckets);
+  *filter = (struct cuckoo_filter){0};
+}
+
+size_t cuckoo_filter_size(struct cuckoo_filter const *filter) {
+  return filter ? filter->_n_elem : 0;
+}
+
+/* used internally to get the fingerprint of a mixed hash. `0` marks an empty slot, hence it's never a fingerprint */
+static inline uint16_t fingerprint_of(uint64_t h) {
+  uint16_t fingerprint = (uint16_t)(h >> 48);
+  return fingerprint ? fingerprint : 1;
+}
+
+/* used internally to get the other bucket of a fingerprint. it's derived from the fingerprint alone, so that a
+ * fingerprint can be moved between its buckets without knowing its key */
+static inline size_t alternate_bucket(struct cuckoo_filter const *filter, size_t bucket, uint16_t fingerprint) {
+  return (bucket ^ (size_t)((uint32_t)fingerprint * 0x5bd1e995u)) & (filter->_n_buckets - 1);
+}
+
+/* used internally to place a fingerprint in an empty slot of a bucket. returns false if the bucket is full */
+static inline bool bucket_insert(struct cuckoo_filter *filter, size_t bucket, uint16_t fingerprint) {
+  uint16_t *slots = filter->_buckets + bucket * CUCKOO_SLOTS;
+  for (size_t s = 0; s < CUCKOO_SLOTS; s++) {
+    if (!slots[s]) {
+      slots[s] = fingerprint;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* used internally to find a fingerprint in a bucket. returns its slot, or NULL if there's no such fingerprint */
+static inline uint16_t *bucket_find(struct cuckoo_filter const *filter, size_t bucket, uint16_t fingerprint) {
+  uint16_t *slots = filter->_buckets + bucket * CUCKOO_SLOTS;
+  for (size_t s = 0; s < CUCKOO_SLOTS; s++) {
+    if (slots[s] == fingerprint) return &slots[s];
+  }
+  return NULL;
+}
+
+/* used internally to place a fingerprint in one of its buckets, kicking other fingerprints into their alternate
+ * buckets as needed. the last fingerprint kicked out, which found no place, becomes the victim */
+static void cuckoo_place(struct cuckoo_filter *filter, size_t bucket, uint16_t fingerprint) {
+  size_t other = alternate_bucket(filter, bucket, fingerprint);
+  if (bucket_insert(filter, bucket, fingerprint) || bucket_insert(filter, other, fingerprint)) return;
+
+  for (size_t kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+    // xorshift64
+    filter->_rng ^= filter->_rng << 13;
+    filter->_rng ^= filter->_rng >> 7;
+    filter->_rng ^= filter->_rng << 17;
+
+    if (kick == 0 && filter->_rng & CUCKOO_SLOTS) bucket = other;
+    uint16_t *slot = filter->_buckets + bucket * CUCKOO_SLOTS + (filter->_rng & (CUCKOO_SLOTS - 1));
+    uint16_t kicked = *slot;
+    *slot = fingerprint;
+
+    fingerprint = kicked;
+    bucket = alternate_bucket(filter, bucket, fingerprint);
+    if (bucket_insert(filter, bucket, fingerprint)) return;
+  }
+
+  filter->_has_victim = true;
+  filter->_victim = fingerprint;
+  filter->_victim_bucket = bucket;
+}
+
+enum ds_error cuckoo_filter_add(struct cuckoo_filter *filter, size_t hash) {
+  if (!filter || !filter->_buckets) return DS_ERROR;
+  if (filter->_has_victim) return DS_ERROR;  // full
+
+  uint64_t h = filter_mix(hash);
+  cuckoo_place(filter, (size_t)h & (filter->_n_buckets - 1), fingerprint_of(h));
+  filter->_n_elem++;
+  return DS_OK;
+}
+
+/* used internally to check whether the victim is a fingerprint of either of `bucket` / `other` */
+static inline bool victim_matches(struct cuckoo_filter const *filter, size_t bucket, size_t other, uint16_t fp) {
+  return filter->_has_victim && filter->_victim == fp &&
+         (filter->_victim_bucket == bucket || filter->_victim_bucket == other);
+}
+
+bool cuckoo_filter_contains(struct cuckoo_filter const *filter, size_t hash) {
+  if (!filter || !filter->_buckets) return false;
+
+  uint64_t h = filter_mix(hash);
+  uint16_t fingerprint = fingerprint_of(h);
+  size_t bucket = (size_t)h & (filter->_n_buckets - 1);
+  size_t other = alternate_bucket(filter, bucket, fingerprint);
+
+  return bucket_find(filter, bucket, fingerprint) || bucket_find(filter, other, fingerprint) ||
+         victim_matches(filter, bucket, other, fingerprint);
+}
+
+enum ds_error cuckoo_filter_remove(struct cuckoo_filter *filter, size_t hash) {
+  if (!filter || !filter->_buckets) return DS_ERROR;
+
+  uint64_t h = filter_mix(hash);
+  uint16_t fingerprint = fingerprint_of(h);
+  size_t bucket = (size_t)h & (filter->_n_buckets - 1);
+  size_t other = alternate_bucket(filter, bucket, fingerprint);
+
+  if (victim_matches(filter, bucket, other, fingerprint)) {
+    filter->_has_victim = false;
+    filter->_n_elem--;
+    return DS_OK;
+  }
+
+  uint16_t *slot = bucket_find(filter, bucket, fingerprint);
+  if (!slot) slot = bucket_find(filter, other, fingerprint);
+  if (!slot) return DS_NOT_FOUND;
+
+  *slot = 0;
+  filter->_n_elem--;
+
+  // the freed slot may make room for the victim
+  if (filter->_has_victim) {
+    filter->_has_victim = false;
+    cuckoo_place(filter, filter->_victim_bucket, filter->_victim);
+  }
+  return DS_OK;
+}
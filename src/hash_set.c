@@ -0,0 +1,100 @@
+#include "hash_set.h"
+
+#include "hash_table.h"
+
+/* the set is a hash table with no value storage, backed by the open addressing engine. an open addressing slot holds
+ * its key at offset 0, so a slot and its key are the same pointer */
+
+struct hash_set set_create(size_t key_size,
+                           int (*cmpr)(void const *, void const *),
+                           size_t (*hash)(void const *hashable, size_t size),
+                           void (*destroy_key)(void *)) {
+  struct table_options options = {.engine = TABLE_OPEN_ADDRESSING};
+  return (struct hash_set){._table = table_create_ex(key_size, 0, cmpr, hash, destroy_key, NULL, &options)};
+}
+
+void set_destroy(struct hash_set *set) {
+  if (!set) return;
+
+  table_destroy(&set->_table);
+}
+
+size_t set_size(struct hash_set const *set) {
+  return set ? table_size(&set->_table) : 0;
+}
+
+bool set_empty(struct hash_set const *set) {
+  return set ? table_empty(&set->_table) : true;
+}
+
+enum ds_error set_insert(struct hash_set *restrict set, void const *restrict key) {
+  if (!set) return DS_ERROR;
+
+  void *slot = NULL;
+  return table_emplace(&set->_table, key, &slot);
+}
+
+bool set_contains(struct hash_set *restrict set, void const *restrict key) {
+  if (!set) return false;
+
+  return table_contains(&set->_table, key);
+}
+
+enum ds_error set_remove(struct hash_set *restrict set, void const *restrict key) {
+  if (!set) return DS_ERROR;
+
+  return table_remove(&set->_table, key, NULL);
+}
+
+enum ds_error set_union(struct hash_set *restrict set, struct hash_set *restrict other) {
+  if (!set || !other) return DS_ERROR;
+  if (set->_table._key_size != other->_table._key_size) return DS_ERROR;
+  // a shallow copy of an owned key would be destroyed by both sets
+  if (set->_table._destroy_key || other->_table._destroy_key) return DS_ERROR;
+
+  for (void *iter = table_iter_begin(&other->_table); iter; iter = table_iter_next(&other->_table, iter)) {
+    enum ds_error ret = set_insert(set, iter);
+    if (ret != DS_OK && ret != DS_VALUE_OK) return ret;
+  }
+
+  return DS_OK;
+}
+
+/* used internally to remove every key of `set` whose membership in `other` equals `member`. removing a key never moves
+ * the other slots (nor shrinks the table, as sets never shrink automatically), so the iteration carries on */
+static size_t remove_if(struct hash_set *restrict set, struct hash_set *restrict other, bool member) {
+  if (!set || !other) return 0;
+  if (set->_table._key_size != other->_table._key_size) return 0;
+
+  size_t removed = 0;
+  for (void *iter = table_iter_begin(&set->_table); iter;) {
+    void *next = table_iter_next(&set->_table, iter);
+    if (table_contains(&other->_table, iter) == member) {
+      table_remove(&set->_table, iter, NULL);
+      removed++;
+    }
+    iter = next;
+  }
+
+  return removed;
+}
+
+size_t set_intersect(struct hash_set *restrict set, struct hash_set *restrict other) {
+  return remove_if(set, other, false);
+}
+
+size_t set_difference(struct hash_set *restrict set, struct hash_set *restrict other) {
+  return remove_if(set, other, true);
+}
+
+void const *set_iter_begin(struct hash_set *set) {
+  if (!set) return NULL;
+
+  return table_iter_begin(&set->_table);
+}
+
+void const *set_iter_next(struct hash_set *set, void const *iter) {
+  if (!set) return NULL;
+
+  return table_iter_next(&set->_table, (void *)iter);
+}
@@ -1,21 +1,41 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "hash_table.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "filter.h"
+#include "hash_table_internal.h"
 #include "vec.h"
 
-#define LOAD_FACTOR 0.7
-#define TABLE_GROWTH 1
-#define TABLE_INIT_CAPACITY 32
+#ifdef DS_PTHREADS
+#include <pthread.h>
+#endif
 
-/* 'bucket' */
-struct kv_pair {
-  void *key;
-  void *value;
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
+// the number of old entries an incremental resize migrates on each operation
+#define MIGRATION_STEP 8
+// the number of keys a batched operation hashes and prefetches ahead of resolving them
+#define BATCH_WIDTH 16
+// the maximal number of threads `table_from_arrays` builds a table with
+#define BUILD_MAX_THREADS 64
+// the smallest number of keys a filter is sized for
+#define FILTER_MIN_CAPACITY 64
+
+/* 'bucket'. a single allocation: the key is placed at hash_table::_key_offset and the value at
+ * hash_table::_value_offset */
+struct kv_pair {
   struct kv_pair *next;
   struct kv_pair *prev;
+
+  // the full hash of the key. spares rehashing on resize and most cmpr calls on lookup
+  size_t hash;
 };
 
 /* entry */
@@ -24,50 +44,236 @@ struct entry {
   struct kv_pair *rehashed;
 };
 
+/* the filter in front of a table's lookups. it holds the hash of every record (a multimap key is added once per pair),
+ * and is rebuilt out of the records once it holds more than `capacity` hashes */
+struct table_filter {
+  enum table_filter_kind kind;
+  size_t capacity;
+  union {
+    struct bloom_filter bloom;
+    struct cuckoo_filter cuckoo;
+  } as;
+};
+
+/* used internally to pick a seed for the default hash. the seed doesn't have to be cryptographically secure, merely
+ * unpredictable enough to not be guessed by whoever controls the keys */
+uint64_t table_random_seed(void) {
+  // tables (and the structures built on them) may be created on several threads at once
+  static uint64_t counter = 0;
+#if defined(__GNUC__) || defined(__clang__)
+  uint64_t count = __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+  uint64_t count = (uint64_t)_InterlockedIncrement64((__int64 volatile *)&counter);
+#else
+  uint64_t count = ++counter;
+#endif
+
+  uint64_t entropy = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^ (uint64_t)(uintptr_t)&counter;
+  uint64_t seed = wy_mix(entropy ^ WY_P2, count ^ WY_P3);
+  return seed ? seed : WY_P0;
+}
+
 struct hash_table table_create(size_t key_size,
                                size_t value_size,
                                int (*cmpr)(void const *, void const *),
                                size_t (*hash)(void const *hashable, size_t size),
                                void (*destroy_key)(void *),
                                void (*destroy_value)(void *)) {
+  return table_create_ex(key_size, value_size, cmpr, hash, destroy_key, destroy_value, NULL);
+}
+
+/* used internally to get the smallest capacity (a power of 2, no smaller than `floor`) which holds `count` elements.
+ * returns 0 if there's no such capacity */
+static size_t capacity_for(struct hash_table const *table, size_t count, size_t floor) {
+  size_t capacity = floor;
+  while (table_max_elements(table, capacity) < count) {
+    if ((SIZE_MAX >> 1) >> 1 < capacity) return 0;
+    capacity <<= 1;
+  }
+
+  return capacity;
+}
+
+struct hash_table table_create_ex(size_t key_size,
+                                  size_t value_size,
+                                  int (*cmpr)(void const *, void const *),
+                                  size_t (*hash)(void const *hashable, size_t size),
+                                  void (*destroy_key)(void *),
+                                  void (*destroy_value)(void *),
+                                  struct table_options const *options) {
   if (!key_size) goto empty_table;
   if (!cmpr) goto empty_table;
 
-  struct vec entries = vec_create(sizeof(struct entry), NULL);
-  entries._n_elem = vec_resize(&entries, TABLE_INIT_CAPACITY);
+  struct table_options opts = options ? *options : (struct table_options){0};
+
+  // the growth factor must be a power of 2 so the capacity remains one
+  size_t growth = TABLE_GROWTH;
+  if (opts.growth_factor) {
+    if (opts.growth_factor < 2 || opts.growth_factor & (opts.growth_factor - 1)) goto empty_table;
+    for (growth = 0; (size_t)1 << growth < opts.growth_factor; growth++) continue;
+  }
+
+  double max_load = TABLE_CHAINED_LOAD_FACTOR;
+  if (opts.engine == TABLE_OPEN_ADDRESSING) max_load = TABLE_OPEN_LOAD_FACTOR;
+  if (opts.engine == TABLE_ORDERED) max_load = TABLE_ORDERED_LOAD_FACTOR;
+  if (opts.max_load_factor) max_load = opts.max_load_factor;
+  if (!(max_load > 0)) goto empty_table;
+  // a probed table must always keep an empty slot around
+  if ((opts.engine == TABLE_OPEN_ADDRESSING || opts.engine == TABLE_ORDERED) && !(max_load < 1)) goto empty_table;
 
-  return (struct hash_table){._cmpr = cmpr,
+  if (opts.multimap && opts.engine != TABLE_CHAINED) goto empty_table;
+
+  // otherwise a table which just grew might shrink right away
+  if (!(opts.min_load_factor >= 0) || !(opts.min_load_factor < max_load / (double)((size_t)1 << growth))) {
+    goto empty_table;
+  }
+
+  struct hash_table table = {._cmpr = cmpr,
                              ._destroy_key = destroy_key,
                              ._destroy_value = destroy_value,
-                             ._entries = entries,
+                             ._engine = opts.engine,
+                             ._growth = growth,
                              ._hash = hash,
+                             ._seed = opts.seed ? opts.seed : table_random_seed(),
+                             ._incremental = opts.incremental_resize,
                              ._key_size = key_size,
+                             ._max_load = max_load,
+                             ._min_load = opts.min_load_factor,
+                             ._multimap = opts.multimap,
                              ._n_elem = 0,
                              ._value_size = value_size};
 
+  size_t capacity = opts.initial_capacity ? capacity_for(&table, opts.initial_capacity, TABLE_MIN_CAPACITY)
+                                          : TABLE_INIT_CAPACITY;
+  if (!capacity) goto empty_table;
+  table._min_capacity = capacity;
+
+  switch (opts.engine) {
+    case TABLE_CHAINED: {
+      table._key_offset = table_align(sizeof(struct kv_pair));
+      table._value_offset = table._key_offset + table_align(key_size);
+
+      struct vec entries = vec_create(sizeof(struct entry), NULL);
+      entries._n_elem = vec_resize(&entries, capacity);
+      if (entries._n_elem != capacity) {
+        vec_destroy(&entries);
+        goto empty_table;
+      }
+      table._entries = entries;
+      break;
+    }
+    case TABLE_OPEN_ADDRESSING:
+      if (!open_table_init(&table, capacity)) goto empty_table;
+      break;
+    case TABLE_DENSE:
+      if (!dense_table_init(&table, capacity)) goto empty_table;
+      break;
+    case TABLE_ORDERED:
+      if (!ordered_table_init(&table, capacity)) goto empty_table;
+      break;
+    default:
+      goto empty_table;
+  }
+
+  return table;
+
 empty_table:
   return (struct hash_table){0};
 }
 
-void table_destroy(struct hash_table *table) {
-  if (!table || !vec_data(&table->_entries)) return;
+/* used internally to free a node, unless it lies within the slab the table was built with */
+static inline void kv_pair_destroy(struct hash_table const *table, struct kv_pair *kv_pair) {
+  // a node below the slab wraps around to a huge offset
+  if ((uintptr_t)kv_pair - (uintptr_t)table->_slab < table->_slab_size) return;
 
-  for (size_t i = 0; i < table_capacity(table); i++) {
+  free(kv_pair);
+}
+
+/* used internally to free all the buckets of a vec of entries. the destructors are called only if `destroy_elements`
+ * is set */
+static void entries_destroy(struct hash_table *table, struct vec *entries, bool destroy_elements) {
+  for (size_t i = 0; i < vec_size(entries); i++) {
     // destroy all buckets in an entry
-    struct entry *entry = vec_at(&table->_entries, i);
+    struct entry *entry = vec_at(entries, i);
     for (struct kv_pair *bucket = entry->head; bucket; entry->head = bucket) {
       bucket = bucket->next;
 
-      if (table->_destroy_key) { table->_destroy_key(entry->head->key); }
-      if (table->_destroy_value) { table->_destroy_value(entry->head->value); }
+      char *node = (char *)entry->head;
+      if (destroy_elements && table->_destroy_key) { table->_destroy_key(node + table->_key_offset); }
+      if (destroy_elements && table->_destroy_value && table->_value_size) {
+        table->_destroy_value(node + table->_value_offset);
+      }
 
-      if (entry->head->key) free(entry->head->key);
-      if (entry->head->value) free(entry->head->value);
-      free(entry->head);
+      kv_pair_destroy(table, entry->head);
     }
   }
 
-  vec_destroy(&table->_entries);
+  vec_destroy(entries);
+}
+
+/* used internally to get the record at the position `pos` of a non chained engine's storage. returns NULL if there's
+ * no record at said position */
+static inline void *record_at(struct hash_table *table, size_t pos) {
+  switch (table->_engine) {
+    case TABLE_OPEN_ADDRESSING:
+      return open_table_at(table, pos);
+    case TABLE_DENSE:
+      return dense_table_at(table, pos);
+    case TABLE_ORDERED:
+      return ordered_table_at(table, pos);
+    case TABLE_FROZEN:
+      return frozen_table_at(table, pos);
+    default:
+      return NULL;
+  }
+}
+
+/* used internally to free the storage of the table. the destructors are called only if `destroy_elements` is set */
+static void storage_destroy(struct hash_table *table, bool destroy_elements) {
+  if (table->_engine == TABLE_CHAINED) {
+    if (vec_data(&table->_old_entries)) entries_destroy(table, &table->_old_entries, destroy_elements);
+    entries_destroy(table, &table->_entries, destroy_elements);
+    free(table->_slab);
+    return;
+  }
+
+  // open addressing slots may be empty, and so may ordered records (once removed). the other records are contiguous
+  size_t end = table->_engine == TABLE_OPEN_ADDRESSING ? table_capacity(table) : vec_size(&table->_records);
+  for (size_t pos = 0; destroy_elements && pos < end; pos++) {
+    char *record = record_at(table, pos);
+    if (!record) continue;
+
+    if (table->_destroy_key) { table->_destroy_key(record + table->_key_offset); }
+    if (table->_destroy_value && table->_value_size) { table->_destroy_value(record + table->_value_offset); }
+  }
+
+  switch (table->_engine) {
+    case TABLE_OPEN_ADDRESSING:
+      open_table_destroy(table);
+      break;
+    case TABLE_DENSE:
+      dense_table_destroy(table);
+      break;
+    case TABLE_ORDERED:
+      ordered_table_destroy(table);
+      break;
+    case TABLE_FROZEN:
+      if (table->_mapping) {
+        mapped_table_unmap(table);
+      } else {
+        frozen_table_destroy(table);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void table_destroy(struct hash_table *table) {
+  if (!table || !vec_data(&table->_entries)) return;
+
+  storage_destroy(table, true);
+  table_attach_filter(table, TABLE_FILTER_NONE);
 }
 
 bool table_empty(struct hash_table const *table) {
@@ -79,77 +285,37 @@ size_t table_size(struct hash_table const *table) {
 }
 
 size_t table_capacity(struct hash_table const *table) {
-  return table ? vec_capacity(&table->_entries) : 0;
-}
+  if (!table) return 0;
 
-/* used internally to hash the keys (slightly modified djd2 by Dan Bernstein) */
-static inline size_t hash(void const *key, size_t key_size) {
-  const unsigned char *k = key;
-  size_t hash = 5381;
-  for (size_t i = 0; i < key_size; i++, k++) { hash = hash * 33 + *k; }
-  return hash;
+  // a frozen table holds exactly as many records as it has elements
+  return table->_engine == TABLE_FROZEN ? vec_size(&table->_records) : vec_capacity(&table->_entries);
 }
 
-static inline size_t hash_wrapper(struct hash_table const *table, void const *key) {
-  size_t _hash = table->_hash ? table->_hash(key, table->_key_size) : hash(key, table->_key_size);
-  return _hash % table_capacity(table);
+/* used internally to map a full hash into an entry index. the number of entries is always a power of 2 */
+static inline size_t entry_index(struct hash_table const *table, size_t hash) {
+  return hash & (table_capacity(table) - 1);
 }
 
 /* util functions */
 /* used internally to create a node and init it with a key-value pair. returns
- * a pointer to a heap allocated node which holds the copies of key and value.
- * both node::key, node::value and node must be free'd. the function assumes
- * key
- * != NULL and key_size > 0 */
-static inline struct kv_pair *kv_pair_create(void const *key, size_t key_size, void const *value, size_t value_size) {
-  void *_key = malloc(key_size);
-  if (!_key) { return NULL; }
-
-  // else - if value_size == 0: kv_pair::value will remain NULL
-  void *_value = NULL;
-  if (value_size) {
-    _value = malloc(value_size);
-    if (!_value) {
-      free(_key);
-      return NULL;
-    }
-    memcpy(_value, value, value_size);
-  }
+ * a pointer to a heap allocated node which holds the copies of key and value
+ * inline. the node is a single allocation and must be free'd. the function
+ * assumes key != NULL. if value is NULL the value bytes are left uninitialized */
+static inline struct kv_pair *kv_pair_create(struct hash_table const *table,
+                                             size_t hash,
+                                             void const *key,
+                                             void const *value) {
+  char *node = malloc(table->_value_offset + table->_value_size);
+  if (!node) return NULL;
 
-  memcpy(_key, key, key_size);
+  memcpy(node + table->_key_offset, key, table->_key_size);
+  if (value && table->_value_size) memcpy(node + table->_value_offset, value, table->_value_size);
 
-  struct kv_pair *kv_pair = malloc(sizeof *kv_pair);
-  if (!kv_pair) {
-    free(_key);
-    free(_value);
-    return NULL;
-  }
-  *kv_pair = (struct kv_pair){.key = _key, .value = _value};
+  struct kv_pair *kv_pair = (struct kv_pair *)node;
+  *kv_pair = (struct kv_pair){.hash = hash};
   return kv_pair;
 }
 
-/* used internally to replace an existing mapping for a certain key. returns a
- * pointer to the previous key which has to be free'd. the
- * function assumes the node passed in isn't NULL */
-static inline void kv_pair_replace_value(struct kv_pair *restrict kv_pair,
-                                         void const *restrict value,
-                                         size_t value_size,
-                                         void *old_value,
-                                         void (*destroy_value)(void *)) {
-  void *_old_value = kv_pair->value;
-  if (!old_value) {
-    if (destroy_value) destroy_value(_old_value);
-  } else {
-    if (value_size) memcpy(old_value, _old_value, value_size);
-  }
-
-  if (value_size) {
-    memcpy(kv_pair->value, value, value_size);
-  } else {
-    kv_pair->value = NULL;
-  }
-}
-
 /* used internally to prepend a bucket to an entry. retuns true on success,
  * NULL on failure */
 static inline bool entry_prepend(struct entry *entry, struct kv_pair *kv_pair) {
@@ -161,27 +327,84 @@ static inline bool entry_prepend(struct entry *entry, struct kv_pair *kv_pair) {
   return true;
 }
 
+/* used internally to link a bucket right after `pos`. a multimap links the pairs of a key this way, next to each other.
+ * a relinking pass (resize / migration) moves a whole entry at a time, hence it keeps such pairs adjacent */
+static inline void entry_insert_after(struct kv_pair *pos, struct kv_pair *kv_pair) {
+  kv_pair->prev = pos;
+  kv_pair->next = pos->next;
+  if (pos->next) pos->next->prev = kv_pair;
+  pos->next = kv_pair;
+}
+
 /* used internally to check whether an entry contains a mapping for a certain
  * key. returns a pointer to the node which contains the same key, or NULL if
- * no such node found */
-static inline struct kv_pair *entry_contains(struct entry *entry,
-                                             void const *key,
-                                             int (*cmpr)(void const *key, void const *other)) {
+ * no such node found. cmpr is only called on nodes with the same hash */
+static inline struct kv_pair *entry_contains(struct hash_table *table,
+                                             struct entry *entry,
+                                             size_t hash,
+                                             void const *key) {
   if (!entry->head) return NULL;
   for (struct kv_pair *tmp = entry->head; tmp; tmp = tmp->next) {
-    if (cmpr(key, tmp->key) == 0) return tmp;
+    TABLE_STATS_PROBE(table);
+    if (tmp->hash == hash && table->_cmpr(key, (char *)tmp + table->_key_offset) == 0) return tmp;
   }
   return NULL;
 }
 
-/* used internally to resize (and rehash) the table with minimum
- * allocations/frees */
-static inline bool resize_table(struct hash_table *table) {
+/* used internally to unlink a bucket from an entry. the function assumes the bucket is linked to said entry */
+static inline void entry_unlink(struct entry *entry, struct kv_pair *removed) {
+  if (!removed->next && !removed->prev) {  // the sole pair in the entry
+    entry->head = NULL;
+  } else if (!removed->next) {  // removed is entry::tail
+    removed->prev->next = NULL;
+  } else if (!removed->prev) {  // removed is entry::head
+    entry->head = entry->head->next;
+    entry->head->prev = NULL;
+  } else {
+    removed->prev->next = removed->next;
+    removed->next->prev = removed->prev;
+  }
+}
+
+/* used internally to relink every node into a fresh vec of `new_capacity` entries. used when shrinking, as shrinking
+ * the entries in place might fail after the nodes were already relinked */
+static bool relink_table(struct hash_table *table, size_t new_capacity) {
+  TABLE_STATS_CLOCK(start);
+  struct vec entries = vec_create(sizeof(struct entry), NULL);
+  if (vec_resize(&entries, new_capacity) != new_capacity) {
+    vec_destroy(&entries);
+    return false;
+  }
+  entries._n_elem = new_capacity;
+
+  for (size_t pos = 0; pos < table_capacity(table); pos++) {
+    struct entry *old_entry = vec_at(&table->_entries, pos);
+
+    for (struct kv_pair *curr_pair = old_entry->head; curr_pair; curr_pair = old_entry->head) {
+      old_entry->head = curr_pair->next;  // detach current pair
+
+      curr_pair->prev = NULL;
+      entry_prepend(vec_at(&entries, curr_pair->hash & (new_capacity - 1)), curr_pair);
+    }
+  }
+
+  vec_destroy(&table->_entries);
+  table->_entries = entries;
+  TABLE_STATS_RESIZED(table, start);
+  return true;
+}
+
+/* used internally to resize the table with minimum allocations/frees. the
+ * cached hashes make this a relinking pass, no key is hashed again */
+static inline bool resize_table(struct hash_table *table, size_t new_capacity) {
   if (!table || !vec_data(&table->_entries)) return false;
 
   size_t old_capacity = table_capacity(table);
-  size_t new_capacity = vec_resize(&table->_entries, old_capacity << TABLE_GROWTH);
-  if (new_capacity == old_capacity) return false;
+  if (new_capacity == old_capacity) return true;
+  if (new_capacity < old_capacity) return relink_table(table, new_capacity);
+
+  TABLE_STATS_CLOCK(start);
+  if (vec_resize(&table->_entries, new_capacity) != new_capacity) return false;
 
   table->_entries._n_elem = new_capacity;
 
@@ -193,7 +416,7 @@ static inline bool resize_table(struct hash_table *table) {
       curr_entry->head = curr_pair->next;  // detach current pair
       if (curr_entry->head) curr_entry->head->prev = NULL;
       // find a new position of the pair with the key 'key' and put it under entry::rehashed
-      size_t new_pos = hash_wrapper(table, curr_pair->key);
+      size_t new_pos = entry_index(table, curr_pair->hash);
       struct entry *new_entry = vec_at(&table->_entries, new_pos);
       if (!new_entry) { continue; }
 
@@ -212,115 +435,1282 @@ static inline bool resize_table(struct hash_table *table) {
     curr_entry->rehashed = NULL;
   }
 
+  TABLE_STATS_RESIZED(table, start);
   return true;
 }
 
-enum ds_error table_put(struct hash_table *restrict table, void const *key, void const *new_value, void *old_value) {
-  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
-  if (!key) return DS_ERROR;
+/* incremental resizing. instead of relinking every node at once, a resize allocates the new entries and keeps the
+ * previous ones in hash_table::_old_entries. each operation then migrates the next MIGRATION_STEP old entries. until
+ * the migration is done, a key may live either in its old entry (if said entry wasn't migrated yet) or in its new one */
+
+static inline bool migrating(struct hash_table const *table) {
+  return table->_old_entries._data != NULL;
+}
+
+/* used internally to get the old entry which may still hold `hash`. returns NULL if said entry was already migrated */
+static inline struct entry *old_entry_of(struct hash_table *table, size_t hash) {
+  size_t pos = hash & (vec_capacity(&table->_old_entries) - 1);
+  return pos < table->_migrated ? NULL : vec_at(&table->_old_entries, pos);
+}
+
+/* used internally to migrate up to `count` old entries into the new ones. returns the number of entries yet to be
+ * migrated */
+static size_t migrate_entries(struct hash_table *table, size_t count) {
+  if (!migrating(table)) return 0;
+
+  size_t old_capacity = vec_capacity(&table->_old_entries);
+  for (; count && table->_migrated < old_capacity; count--, table->_migrated++) {
+    struct entry *old_entry = vec_at(&table->_old_entries, table->_migrated);
+
+    for (struct kv_pair *curr_pair = old_entry->head; curr_pair; curr_pair = old_entry->head) {
+      old_entry->head = curr_pair->next;  // detach current pair
 
-  // load factor exceeded
-  if (table_capacity(table) * LOAD_FACTOR < table->_n_elem + 1) {
-    if (!resize_table(table)) return DS_NO_MEM;
+      struct entry *new_entry = vec_at(&table->_entries, entry_index(table, curr_pair->hash));
+      curr_pair->prev = NULL;
+      entry_prepend(new_entry, curr_pair);
+    }
   }
 
-  // get the entry index from the hash
-  size_t pos = hash_wrapper(table, key);
+  if (table->_migrated < old_capacity) return old_capacity - table->_migrated;
 
-  struct entry *entry = vec_at(&table->_entries, pos);
-  if (!entry) return DS_OUT_OF_BOUNDS;
+  vec_destroy(&table->_old_entries);
+  table->_old_entries = (struct vec){0};
+  table->_migrated = 0;
+  return 0;
+}
 
-  // there's an existing mapping for this key
-  struct kv_pair *same_key = entry_contains(entry, key, table->_cmpr);
-  if (same_key) {
-    kv_pair_replace_value(same_key, new_value, table->_value_size, old_value, table->_destroy_value);
-    if (old_value) return DS_VALUE_OK;
-    return DS_OK;
+/* used internally to start an incremental resize into `new_capacity` entries. a migration which is still in progress
+ * is completed first */
+static bool begin_migration(struct hash_table *table, size_t new_capacity) {
+  TABLE_STATS_CLOCK(start);
+  migrate_entries(table, SIZE_MAX);
+
+  struct vec entries = vec_create(sizeof(struct entry), NULL);
+  if (vec_resize(&entries, new_capacity) != new_capacity) {
+    vec_destroy(&entries);
+    return false;
   }
+  entries._n_elem = new_capacity;
 
-  // there isn't an existing mapping for this key
-  struct kv_pair *kv_pair = kv_pair_create(key, table->_key_size, new_value, table->_value_size);
-  if (!kv_pair) return DS_NO_MEM;
+  table->_old_entries = table->_entries;
+  table->_entries = entries;
+  table->_migrated = 0;
+  TABLE_STATS_RESIZED(table, start);
+  return true;
+}
 
-  // bool success = entry_prepend(entry, key, table->_key_size, new_value, table->_value_size);
-  bool success = entry_prepend(entry, kv_pair);
-  if (!success) return DS_NO_MEM;
+/* used internally to resize either engine into `new_capacity` entries right away. an incremental resize which is in
+ * progress is completed first */
+static bool rehash_table(struct hash_table *table, size_t new_capacity) {
+  if (table->_engine == TABLE_OPEN_ADDRESSING) return open_table_resize(table, new_capacity);
+  if (table->_engine == TABLE_DENSE) return dense_table_resize(table, new_capacity);
+  if (table->_engine == TABLE_ORDERED) return ordered_table_resize(table, new_capacity);
 
-  table->_n_elem++;
-  return DS_OK;
+  migrate_entries(table, SIZE_MAX);
+  return resize_table(table, new_capacity);
 }
 
-enum ds_error table_remove(struct hash_table *restrict table, void const *restrict key, void *restrict old_value) {
-  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
-  if (!key) return DS_ERROR;
+/* used internally to shrink the table once its load drops below hash_table::_min_load. a failure to shrink leaves the
+ * table as is */
+static void shrink_if_sparse(struct hash_table *table) {
+  if (!table->_min_load) return;
 
-  size_t pos = hash_wrapper(table, key);
+  size_t capacity = table_capacity(table);
+  if (capacity <= table->_min_capacity || (double)table->_n_elem >= (double)capacity * table->_min_load) return;
 
-  struct entry *entry = vec_at(&table->_entries, pos);
-  if (!entry) return DS_OUT_OF_BOUNDS;
+  size_t new_capacity = capacity_for(table, table->_n_elem, table->_min_capacity);
+  if (!new_capacity || new_capacity >= capacity) return;
 
-  struct kv_pair *removed = entry_contains(entry, key, table->_cmpr);
-  if (!removed) return DS_NOT_FOUND;  // the table doesn't contains the key `key`
+  if (table->_engine == TABLE_CHAINED && table->_incremental) {
+    begin_migration(table, new_capacity);
+  } else {
+    rehash_table(table, new_capacity);
+  }
+}
 
-  if (!removed->next && !removed->prev) {  // the sole pair in the entry
-    entry->head = NULL;
-  } else if (!removed->next) {  // removed is entry::tail
-    removed->prev->next = NULL;
-  } else if (!removed->prev) {  // removed is entry::head
-    entry->head = entry->head->next;
-    entry->head->prev = NULL;
+/* engine agnostic helpers. a 'record' is whatever the engine stores a key / value pair in: a `struct kv_pair` for
+ * TABLE_CHAINED, a slot for TABLE_OPEN_ADDRESSING, an element of hash_table::_records for the other engines */
+
+static inline void *record_key(struct hash_table const *table, void *record) {
+  return (char *)record + table->_key_offset;
+}
+
+static inline void *record_value(struct hash_table const *table, void *record) {
+  return table->_value_size ? (char *)record + table->_value_offset : NULL;
+}
+
+/* used internally to account for a lookup of `lookup` which just completed. the probes the engine counted during the
+ * lookup are attributed to it */
+static inline void stats_lookup(struct hash_table *table, enum table_lookup lookup, bool hit) {
+#ifdef DS_TABLE_STATS
+  struct table_counters *stats = &table->_stats;
+  stats->_lookups[lookup]++;
+  stats->_lookup_probes[lookup] += stats->_probes;
+  stats->_probes = 0;
+  if (hit) {
+    stats->_hits++;
   } else {
-    removed->prev->next = removed->next;
-    removed->next->prev = removed->prev;
+    stats->_misses++;
   }
+#else
+  (void)table;
+  (void)lookup;
+  (void)hit;
+#endif
+}
 
-  enum ds_error ret = DS_OK;
-  if (!old_value && table->_destroy_value) {
-    table->_destroy_value(removed->value);
-  } else if (old_value) {
-    memcpy(old_value, removed->value, table->_value_size);
-    ret = DS_VALUE_OK;
+/* filters (see `table_attach_filter`). the table adds the hash of a record to its filter once the record is inserted,
+ * and removes it (from a cuckoo filter) before the record is erased */
+
+/* used internally to get the hash of a record. chained nodes cache it, the other engines' records are rehashed */
+static inline size_t record_hash(struct hash_table const *table, void *record) {
+  return table->_engine == TABLE_CHAINED ? ((struct kv_pair *)record)->hash
+                                         : hash_wrapper(table, record_key(table, record));
+}
+
+static void filter_destroy(struct table_filter *filter) {
+  if (!filter) return;
+
+  if (filter->kind == TABLE_FILTER_BLOOM) {
+    bloom_filter_destroy(&filter->as.bloom);
+  } else {
+    cuckoo_filter_destroy(&filter->as.cuckoo);
   }
+  free(filter);
+}
 
-  if (table->_destroy_key) { table->_destroy_key(removed->key); }
-  free(removed->key);
-  free(removed->value);
-  free(removed);
-  table->_n_elem--;
+static inline size_t filter_size(struct table_filter const *filter) {
+  return filter->kind == TABLE_FILTER_BLOOM ? bloom_filter_size(&filter->as.bloom)
+                                            : cuckoo_filter_size(&filter->as.cuckoo);
+}
 
-  return ret;
+static inline bool filter_add(struct table_filter *filter, size_t hash) {
+  if (filter->kind == TABLE_FILTER_BLOOM) return bloom_filter_add(&filter->as.bloom, hash) == DS_OK;
+  return cuckoo_filter_add(&filter->as.cuckoo, hash) == DS_OK;
 }
 
-enum ds_error table_get(struct hash_table *restrict table, void const *restrict key, void *restrict value) {
+/* used internally to build a filter of the kind `kind` out of the table's records, sized for twice as many. returns
+ * NULL on failure */
+static struct table_filter *filter_build(struct hash_table *table, enum table_filter_kind kind) {
+  struct table_filter *filter = malloc(sizeof *filter);
+  if (!filter) return NULL;
+
+  filter->kind = kind;
+  filter->capacity = table->_n_elem > SIZE_MAX / 4 ? SIZE_MAX / 2 : table->_n_elem * 2;
+  if (filter->capacity < FILTER_MIN_CAPACITY) filter->capacity = FILTER_MIN_CAPACITY;
+
+  bool created;
+  if (kind == TABLE_FILTER_BLOOM) {
+    filter->as.bloom = bloom_filter_create(filter->capacity, 0);
+    created = filter->as.bloom._blocks != NULL;
+  } else {
+    filter->as.cuckoo = cuckoo_filter_create(filter->capacity);
+    created = filter->as.cuckoo._buckets != NULL;
+  }
+  if (!created) {
+    free(filter);
+    return NULL;
+  }
+
+  if (table->_engine != TABLE_CHAINED) {
+    for (void *iter = table_iter_begin(table); iter; iter = table_iter_next(table, iter)) {
+      if (!filter_add(filter, record_hash(table, iter))) goto destroy_filter;
+    }
+    return filter;
+  }
+
+  // the entries are walked as they are, rather than iterated over, which would complete an incremental resize at once.
+  // the old entries which were migrated already are empty
+  struct vec *entries[] = {&table->_old_entries, &table->_entries};
+  for (size_t e = 0; e < sizeof entries / sizeof *entries; e++) {
+    for (size_t pos = 0; pos < vec_size(entries[e]); pos++) {
+      struct entry *entry = vec_at(entries[e], pos);
+      for (struct kv_pair *curr = entry->head; curr; curr = curr->next) {
+        if (!filter_add(filter, curr->hash)) goto destroy_filter;
+      }
+    }
+  }
+  return filter;
+
+destroy_filter:
+  filter_destroy(filter);
+  return NULL;
+}
+
+/* used internally to add the hash of a record which was just inserted to the table's filter. a filter which outgrew
+ * its capacity (or a cuckoo filter which is full) is rebuilt. if rebuilding fails, a filter which missed the hash is
+ * dropped, as it would otherwise reject the record's key */
+static void filter_insert(struct hash_table *table, size_t hash) {
+  struct table_filter *filter = table->_filter;
+  if (!filter) return;
+
+  bool added = filter_add(filter, hash);
+  if (added && filter_size(filter) <= filter->capacity) return;
+
+  struct table_filter *rebuilt = filter_build(table, filter->kind);
+  if (!rebuilt && added) return;
+
+  filter_destroy(filter);
+  table->_filter = rebuilt;
+}
+
+/* used internally to remove the hash of a record which is about to be erased from the table's filter. a bloom filter
+ * can't forget it, the hash remains until the filter is rebuilt */
+static inline void filter_erase(struct hash_table *table, size_t hash) {
+  if (table->_filter && table->_filter->kind == TABLE_FILTER_CUCKOO) {
+    cuckoo_filter_remove(&table->_filter->as.cuckoo, hash);
+  }
+}
+
+/* used internally to check whether the table's filter may hold `hash`. a table without a filter may hold any hash */
+static inline bool filter_may_contain(struct hash_table const *table, size_t hash) {
+  struct table_filter const *filter = table->_filter;
+  if (!filter) return true;
+
+  return filter->kind == TABLE_FILTER_BLOOM ? bloom_filter_contains(&filter->as.bloom, hash)
+                                            : cuckoo_filter_contains(&filter->as.cuckoo, hash);
+}
+
+enum ds_error table_attach_filter(struct hash_table *table, enum table_filter_kind kind) {
   if (!table || !vec_data(&table->_entries)) return DS_ERROR;
-  if (!key || !value) return DS_ERROR;
+  if (kind != TABLE_FILTER_NONE && kind != TABLE_FILTER_BLOOM && kind != TABLE_FILTER_CUCKOO) return DS_ERROR;
 
-  size_t pos = hash_wrapper(table, key);
-  struct entry *entry = vec_at(&table->_entries, pos);
-  if (!entry) return DS_OUT_OF_BOUNDS;
+  struct table_filter *filter = NULL;
+  if (kind != TABLE_FILTER_NONE) {
+    filter = filter_build(table, kind);
+    if (!filter) return DS_NO_MEM;
+  }
 
-  struct kv_pair *looked_for = entry_contains(entry, key, table->_cmpr);
-  if (!looked_for) return DS_NOT_FOUND;
+  filter_destroy(table->_filter);
+  table->_filter = filter;
+  return DS_OK;
+}
 
-  memcpy(value, looked_for->value, table->_value_size);
-  return DS_VALUE_OK;
+/* used internally to find the record holding `key`. returns NULL if there's no such record */
+static void *table_find(struct hash_table *table, size_t hash, void const *key) {
+  // a key the filter rejects is known to be missing
+  if (!filter_may_contain(table, hash)) return NULL;
+
+  if (table->_engine == TABLE_OPEN_ADDRESSING) return open_table_find(table, hash, key);
+  if (table->_engine == TABLE_DENSE) return dense_table_find(table, hash, key);
+  if (table->_engine == TABLE_ORDERED) return ordered_table_find(table, hash, key);
+  if (table->_engine == TABLE_FROZEN) return frozen_table_find(table, hash, key);
+
+  if (migrating(table)) {
+    struct entry *old_entry = old_entry_of(table, hash);
+    struct kv_pair *found = old_entry ? entry_contains(table, old_entry, hash, key) : NULL;
+    if (found) return found;
+  }
+
+  struct entry *entry = vec_at(&table->_entries, entry_index(table, hash));
+  if (!entry) return NULL;
+
+  return entry_contains(table, entry, hash, key);
 }
 
-void print_table(struct hash_table *table, void (*print)(void const *, void const *, size_t)) {
-  for (size_t i = 0; i < table_capacity(table); i++) {
-    struct entry *entry = vec_at(&table->_entries, i);
-    if (!entry) { continue; }
+/* used internally to grow a chained table if another element would exceed its load factor */
+static bool chained_make_room(struct hash_table *table) {
+  size_t capacity = table_capacity(table);
+  if (table->_n_elem + 1 <= table_max_elements(table, capacity)) return true;
+  if ((SIZE_MAX >> 1) >> table->_growth < capacity) return false;
+
+  size_t new_capacity = capacity << table->_growth;
+  return table->_incremental ? begin_migration(table, new_capacity) : resize_table(table, new_capacity);
+}
+
+/* used internally to insert a copy of `key` and `value` into the table. the function assumes the table doesn't hold
+ * `key`. returns the new record or NULL on allocation failure */
+static void *table_insert(struct hash_table *table, size_t hash, void const *key, void const *value) {
+  if (table->_engine != TABLE_CHAINED) {
+    char *record = NULL;
+    if (table->_engine == TABLE_OPEN_ADDRESSING) record = open_table_insert(table, hash);
+    if (table->_engine == TABLE_DENSE) record = dense_table_insert(table, hash);
+    if (table->_engine == TABLE_ORDERED) record = ordered_table_insert(table, hash);
+    if (!record) return NULL;
+
+    memcpy(record + table->_key_offset, key, table->_key_size);
+    if (value && table->_value_size) memcpy(record + table->_value_offset, value, table->_value_size);
+    filter_insert(table, hash);
+    return record;
+  }
+
+  if (!chained_make_room(table)) return NULL;
+
+  struct entry *entry = vec_at(&table->_entries, entry_index(table, hash));
+  if (!entry) return NULL;
 
-    for (struct kv_pair *curr = entry->head; curr; curr = curr->next) { print(curr->key, curr->value, i); }
+  struct kv_pair *kv_pair = kv_pair_create(table, hash, key, value);
+  if (!kv_pair) return NULL;
+
+  entry_prepend(entry, kv_pair);
+  filter_insert(table, hash);
+  return kv_pair;
+}
+
+/* used internally to unlink and release a record. destructors aren't called */
+static void table_erase(struct hash_table *table, void *record) {
+  if (table->_engine == TABLE_OPEN_ADDRESSING) {
+    open_table_erase(table, record);
+    return;
+  }
+
+  if (table->_engine == TABLE_DENSE) {
+    dense_table_erase(table, record);
+    return;
+  }
+
+  if (table->_engine == TABLE_ORDERED) {
+    ordered_table_erase(table, record);
+    return;
   }
+
+  struct kv_pair *removed = record;
+  struct entry *entry = vec_at(&table->_entries, entry_index(table, removed->hash));
+
+  // only the head of an entry needs said entry to be unlinked. it might be the head of its old entry
+  if (migrating(table) && !removed->prev) {
+    struct entry *old_entry = old_entry_of(table, removed->hash);
+    if (old_entry && old_entry->head == removed) entry = old_entry;
+  }
+
+  entry_unlink(entry, removed);
+  kv_pair_destroy(table, removed);
 }
 
-bool table_contains(struct hash_table *restrict table, void const *restrict key) {
-  if (!table || !key) return false;
+/* used internally to replace the value of an existing mapping. the old value is either copied into `old_value` or
+ * destroyed */
+static inline void replace_value(struct hash_table *restrict table,
+                                 void *record,
+                                 void const *restrict value,
+                                 void *old_value) {
+  void *_old_value = record_value(table, record);
+  if (!old_value) {
+    if (table->_destroy_value) table->_destroy_value(_old_value);
+  } else {
+    if (table->_value_size) memcpy(old_value, _old_value, table->_value_size);
+  }
+
+  if (table->_value_size) memcpy(_old_value, value, table->_value_size);
+}
+
+/* used internally to add another pair of a key to a multimap, right after `first` (a pair of the same key). the pairs
+ * moved by a resize move along with `first`, hence they remain adjacent */
+static enum ds_error multimap_insert(struct hash_table *table,
+                                     struct kv_pair *first,
+                                     void const *key,
+                                     void const *value) {
+  if (!chained_make_room(table)) return DS_NO_MEM;
+
+  struct kv_pair *kv_pair = kv_pair_create(table, first->hash, key, value);
+  if (!kv_pair) return DS_NO_MEM;
+
+  entry_insert_after(first, kv_pair);
+  table->_n_elem++;
+  filter_insert(table, first->hash);
+  return DS_OK;
+}
+
+/* used internally to put a key whose hash is already known */
+static enum ds_error put_hashed(struct hash_table *restrict table,
+                               size_t hash,
+                               void const *key,
+                               void const *new_value,
+                               void *old_value) {
+  // there's an existing mapping for this key
+  void *same_key = table_find(table, hash, key);
+  stats_lookup(table, TABLE_LOOKUP_PUT, same_key != NULL);
+  if (same_key && table->_multimap) return multimap_insert(table, same_key, key, new_value);
+  if (same_key) {
+    replace_value(table, same_key, new_value, old_value);
+    if (old_value) return DS_VALUE_OK;
+    return DS_OK;
+  }
 
-  size_t pos = hash_wrapper(table, key);
-  struct entry *entry = vec_at(&table->_entries, pos);
-  if (!entry) return false;
+  // there isn't an existing mapping for this key
+  if (!table_insert(table, hash, key, new_value)) return DS_NO_MEM;
+
+  table->_n_elem++;
+  return DS_OK;
+}
+
+size_t table_hash(struct hash_table const *restrict table, void const *restrict key) {
+  if (!table || !key) return 0;
+
+  return hash_wrapper(table, key);
+}
+
+enum ds_error table_put(struct hash_table *restrict table, void const *key, void const *new_value, void *old_value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  return table_put_hashed(table, hash_wrapper(table, key), key, new_value, old_value);
+}
+
+enum ds_error table_put_hashed(struct hash_table *restrict table,
+                               size_t hash,
+                               void const *key,
+                               void const *new_value,
+                               void *old_value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (table->_engine == TABLE_FROZEN) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  return put_hashed(table, hash, key, new_value, old_value);
+}
+
+enum ds_error table_remove(struct hash_table *restrict table, void const *restrict key, void *restrict old_value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  return table_remove_hashed(table, hash_wrapper(table, key), key, old_value);
+}
+
+enum ds_error table_remove_hashed(struct hash_table *restrict table,
+                                  size_t hash,
+                                  void const *restrict key,
+                                  void *restrict old_value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (table->_engine == TABLE_FROZEN) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  void *removed = table_find(table, hash, key);
+  stats_lookup(table, TABLE_LOOKUP_REMOVE, removed != NULL);
+  if (!removed) return DS_NOT_FOUND;  // the table doesn't contains the key `key`
+
+  enum ds_error ret = DS_OK;
+  if (!old_value && table->_destroy_value) {
+    table->_destroy_value(record_value(table, removed));
+  } else if (old_value) {
+    if (table->_value_size) memcpy(old_value, record_value(table, removed), table->_value_size);
+    ret = DS_VALUE_OK;
+  }
+
+  filter_erase(table, hash);
+  if (table->_destroy_key) { table->_destroy_key(record_key(table, removed)); }
+  table_erase(table, removed);
+  table->_n_elem--;
+
+  shrink_if_sparse(table);
+  return ret;
+}
+
+enum ds_error table_get(struct hash_table *restrict table, void const *restrict key, void *restrict value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  return table_get_hashed(table, hash_wrapper(table, key), key, value);
+}
+
+enum ds_error table_get_hashed(struct hash_table *restrict table,
+                               size_t hash,
+                               void const *restrict key,
+                               void *restrict value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (!key || !value) return DS_ERROR;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  void *looked_for = table_find(table, hash, key);
+  stats_lookup(table, TABLE_LOOKUP_GET, looked_for != NULL);
+  if (!looked_for) return DS_NOT_FOUND;
+
+  if (table->_value_size) memcpy(value, record_value(table, looked_for), table->_value_size);
+  return DS_VALUE_OK;
+}
+
+void *table_get_ref(struct hash_table *restrict table, void const *restrict key) {
+  if (!table || !vec_data(&table->_entries)) return NULL;
+  if (!key) return NULL;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  char *looked_for = table_find(table, hash_wrapper(table, key), key);
+  stats_lookup(table, TABLE_LOOKUP_GET, looked_for != NULL);
+  return looked_for ? looked_for + table->_value_offset : NULL;
+}
+
+enum ds_error table_emplace(struct hash_table *restrict table, void const *restrict key, void **restrict value) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (table->_engine == TABLE_FROZEN) return DS_ERROR;
+  if (!key || !value) return DS_ERROR;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  size_t hash = hash_wrapper(table, key);
+
+  char *same_key = table_find(table, hash, key);
+  stats_lookup(table, TABLE_LOOKUP_PUT, same_key != NULL);
+  if (same_key) {
+    *value = same_key + table->_value_offset;
+    return DS_VALUE_OK;
+  }
+
+  char *inserted = table_insert(table, hash, key, NULL);
+  if (!inserted) return DS_NO_MEM;
+
+  table->_n_elem++;
+  *value = inserted + table->_value_offset;
+  return DS_OK;
+}
+
+enum ds_error table_upsert_with(struct hash_table *restrict table,
+                                void const *restrict key,
+                                void (*update)(void *value, bool exists, void *context),
+                                void *context) {
+  if (!update) return DS_ERROR;
+
+  void *value = NULL;
+  enum ds_error ret = table_emplace(table, key, &value);
+  if (ret != DS_OK && ret != DS_VALUE_OK) return ret;
+
+  update(value, ret == DS_VALUE_OK, context);
+  return ret;
+}
+
+/* batched operations. a batch is resolved in stages: first all of its keys are hashed and the memory they map to is
+ * prefetched, then (for TABLE_CHAINED) the first node of each entry is prefetched, and only then are the keys looked
+ * up. this way the cache misses of a whole batch overlap instead of being taken one after the other */
+
+/* used internally to prefetch the entry / control bytes `hash` maps to */
+static inline void prefetch_entry(struct hash_table *table, size_t hash) {
+  if (table->_engine == TABLE_OPEN_ADDRESSING) {
+    open_table_prefetch(table, hash);
+    return;
+  }
+
+  if (table->_engine == TABLE_FROZEN) {
+    frozen_table_prefetch_pilot(table, hash);
+    return;
+  }
+
+  TABLE_PREFETCH(vec_at(&table->_entries, entry_index(table, hash)));
+}
+
+/* used internally to prefetch the first node / record of the entry `hash` maps to. the entry itself should already be
+ * cached */
+static inline void prefetch_head(struct hash_table *table, size_t hash) {
+  if (table->_engine == TABLE_DENSE) dense_table_prefetch(table, hash);
+  if (table->_engine == TABLE_ORDERED) ordered_table_prefetch(table, hash);
+  if (table->_engine == TABLE_FROZEN) frozen_table_prefetch(table, hash);
+  if (table->_engine != TABLE_CHAINED) return;
+
+  struct entry *entry = vec_at(&table->_entries, entry_index(table, hash));
+  if (entry && entry->head) TABLE_PREFETCH(entry->head);
+}
+
+/* used internally to hash and prefetch a batch of keys */
+static void batch_prepare(struct hash_table *table, char const *keys, size_t count, size_t *hashes) {
+  for (size_t i = 0; i < count; i++) {
+    hashes[i] = hash_wrapper(table, keys + i * table->_key_size);
+    prefetch_entry(table, hashes[i]);
+  }
+
+  for (size_t i = 0; i < count; i++) { prefetch_head(table, hashes[i]); }
+}
+
+size_t table_get_many(struct hash_table *restrict table,
+                      void const *restrict keys,
+                      size_t count,
+                      void *restrict values,
+                      enum ds_error *restrict status) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (!keys || !values) return 0;
+
+  char const *_keys = keys;
+  char *_values = values;
+  size_t hashes[BATCH_WIDTH];
+  size_t found = 0;
+
+  for (size_t start = 0; start < count; start += BATCH_WIDTH) {
+    size_t batch = count - start < BATCH_WIDTH ? count - start : BATCH_WIDTH;
+    char const *batch_keys = _keys + start * table->_key_size;
+
+    migrate_entries(table, MIGRATION_STEP);
+    batch_prepare(table, batch_keys, batch, hashes);
+
+    for (size_t i = 0; i < batch; i++) {
+      void *looked_for = table_find(table, hashes[i], batch_keys + i * table->_key_size);
+      stats_lookup(table, TABLE_LOOKUP_GET, looked_for != NULL);
+      if (status) status[start + i] = looked_for ? DS_VALUE_OK : DS_NOT_FOUND;
+      if (!looked_for) continue;
+
+      if (table->_value_size) {
+        memcpy(_values + (start + i) * table->_value_size, record_value(table, looked_for), table->_value_size);
+      }
+      found++;
+    }
+  }
+
+  return found;
+}
+
+size_t table_put_many(struct hash_table *restrict table,
+                      void const *restrict keys,
+                      void const *restrict values,
+                      size_t count,
+                      enum ds_error *restrict status) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (!keys || (!values && table->_value_size)) return 0;
+  if (table->_engine == TABLE_FROZEN) return 0;
+
+  char const *_keys = keys;
+  char const *_values = values;
+  size_t hashes[BATCH_WIDTH];
+  size_t inserted = 0;
+
+  for (size_t start = 0; start < count; start += BATCH_WIDTH) {
+    size_t batch = count - start < BATCH_WIDTH ? count - start : BATCH_WIDTH;
+    char const *batch_keys = _keys + start * table->_key_size;
+
+    migrate_entries(table, MIGRATION_STEP);
+    batch_prepare(table, batch_keys, batch, hashes);
+
+    for (size_t i = 0; i < batch; i++) {
+      size_t prev_size = table->_n_elem;
+      void const *value = _values ? _values + (start + i) * table->_value_size : NULL;
+
+      enum ds_error ret = put_hashed(table, hashes[i], batch_keys + i * table->_key_size, value, NULL);
+      if (ret == DS_OK && table->_n_elem == prev_size) ret = DS_VALUE_OK;  // an existing value was replaced
+      if (ret == DS_OK) inserted++;
+      if (status) status[start + i] = ret;
+    }
+  }
+
+  return inserted;
+}
+
+/* bulk construction. `table_from_arrays` links every pair into a node of one slab. a parallel build first hashes the
+ * keys and sorts their indices by the range of buckets (part) they fall into, in parallel, then links each part on a
+ * thread of its own. the pairs of a part are linked in their original order, and no bucket is shared between parts */
+
+struct table_build {
+  struct hash_table *table;
+  char const *keys;
+  char const *values;
+  size_t count;
+
+  char *slab;
+  size_t stride;  // the distance between consecutive nodes of the slab
+
+  size_t n_parts;  // a power of 2. also the number of threads
+  unsigned part_shift;
+  size_t *hashes;
+  size_t *order;       // the indices of the pairs, sorted by their part
+  size_t *cursors;     // `cursors[t * n_parts + p]`, where the thread `t` sorts its next index of the part `p` into
+  size_t *part_start;  // `n_parts + 1` offsets into `order`
+};
+
+/* the work of a single build thread */
+struct build_task {
+  struct table_build *build;
+  size_t id;
+  size_t inserted;
+};
+
+/* used internally to get the first of the `count` items the `part`-th of `n_parts` (near) equal parts begins at */
+static inline size_t part_begin(size_t count, size_t n_parts, size_t part) {
+  return count / n_parts * part + (part < count % n_parts ? part : count % n_parts);
+}
+
+/* used internally to link the `i`-th pair into the table, as `table_put` would. returns whether a node was linked, or
+ * the value of an existing key was replaced instead */
+static bool build_link(struct table_build *build, size_t i, size_t hash) {
+  struct hash_table *table = build->table;
+  char const *key = build->keys + i * table->_key_size;
+  char const *value = build->values ? build->values + i * table->_value_size : NULL;
+  struct entry *entry = vec_at(&table->_entries, entry_index(table, hash));
+
+  // the stats counters aren't touched, as the parts may be linked concurrently
+  struct kv_pair *same = entry->head;
+  while (same && (same->hash != hash || table->_cmpr(key, (char *)same + table->_key_offset) != 0)) same = same->next;
+
+  if (same && !table->_multimap) {
+    replace_value(table, same, value, NULL);
+    return false;
+  }
+
+  char *node = build->slab + i * build->stride;
+  memcpy(node + table->_key_offset, key, table->_key_size);
+  if (table->_value_size) memcpy(node + table->_value_offset, value, table->_value_size);
+
+  struct kv_pair *kv_pair = (struct kv_pair *)node;
+  *kv_pair = (struct kv_pair){.hash = hash};
+  if (same) {
+    entry_insert_after(same, kv_pair);
+  } else {
+    entry_prepend(entry, kv_pair);
+  }
+  return true;
+}
+
+/* used internally to hash the keys of the task's range of pairs, counting them per part */
+static void *build_hash(void *arg) {
+  struct build_task *task = arg;
+  struct table_build *build = task->build;
+  size_t *counts = build->cursors + task->id * build->n_parts;
+
+  size_t end = part_begin(build->count, build->n_parts, task->id + 1);
+  for (size_t i = part_begin(build->count, build->n_parts, task->id); i < end; i++) {
+    build->hashes[i] = hash_wrapper(build->table, build->keys + i * build->table->_key_size);
+    counts[entry_index(build->table, build->hashes[i]) >> build->part_shift]++;
+  }
+  return NULL;
+}
+
+/* used internally to sort the indices of the task's range of pairs by their part */
+static void *build_sort(void *arg) {
+  struct build_task *task = arg;
+  struct table_build *build = task->build;
+  size_t *cursors = build->cursors + task->id * build->n_parts;
+
+  size_t end = part_begin(build->count, build->n_parts, task->id + 1);
+  for (size_t i = part_begin(build->count, build->n_parts, task->id); i < end; i++) {
+    build->order[cursors[entry_index(build->table, build->hashes[i]) >> build->part_shift]++] = i;
+  }
+  return NULL;
+}
+
+/* used internally to link the pairs of the task's part */
+static void *build_part(void *arg) {
+  struct build_task *task = arg;
+  struct table_build *build = task->build;
+
+  for (size_t k = build->part_start[task->id]; k < build->part_start[task->id + 1]; k++) {
+    size_t i = build->order[k];
+    if (build_link(build, i, build->hashes[i])) task->inserted++;
+  }
+  return NULL;
+}
+
+/* used internally to run `fn` over every task, each on a thread of its own. the calling thread runs the first task
+ * itself, as well as any task a thread couldn't be started for */
+static void build_run(void *(*fn)(void *), struct build_task *tasks, size_t n_tasks) {
+#ifdef DS_PTHREADS
+  pthread_t threads[BUILD_MAX_THREADS];
+  bool started[BUILD_MAX_THREADS];
+
+  for (size_t t = 0; t < n_tasks; t++) { started[t] = t && pthread_create(&threads[t], NULL, fn, &tasks[t]) == 0; }
+
+  for (size_t t = 0; t < n_tasks; t++) {
+    if (!started[t]) fn(&tasks[t]);
+  }
+
+  for (size_t t = 0; t < n_tasks; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+  }
+#else
+  for (size_t t = 0; t < n_tasks; t++) { fn(&tasks[t]); }
+#endif
+}
+
+/* used internally to link every pair in parallel. returns the number of nodes linked, or `SIZE_MAX` if there's no
+ * memory to sort the pairs by */
+static size_t build_parallel(struct table_build *build) {
+  size_t n_parts = build->n_parts;
+  build->hashes = malloc(build->count * sizeof *build->hashes);
+  build->order = malloc(build->count * sizeof *build->order);
+  build->cursors = calloc(n_parts * n_parts, sizeof *build->cursors);
+  build->part_start = calloc(n_parts + 1, sizeof *build->part_start);
+
+  size_t inserted = SIZE_MAX;
+  if (!build->hashes || !build->order || !build->cursors || !build->part_start) goto cleanup;
+
+  struct build_task tasks[BUILD_MAX_THREADS];
+  for (size_t t = 0; t < n_parts; t++) { tasks[t] = (struct build_task){.build = build, .id = t}; }
+
+  build_run(build_hash, tasks, n_parts);
+
+  // turn the counts into cursors: the part `p` gets the indices of thread `0` first, then those of thread `1` etc
+  size_t offset = 0;
+  for (size_t p = 0; p < n_parts; p++) {
+    build->part_start[p] = offset;
+    for (size_t t = 0; t < n_parts; t++) {
+      size_t count = build->cursors[t * n_parts + p];
+      build->cursors[t * n_parts + p] = offset;
+      offset += count;
+    }
+  }
+  build->part_start[n_parts] = offset;
+
+  build_run(build_sort, tasks, n_parts);
+  build_run(build_part, tasks, n_parts);
+
+  inserted = 0;
+  for (size_t t = 0; t < n_parts; t++) { inserted += tasks[t].inserted; }
+
+cleanup:
+  free(build->hashes);
+  free(build->order);
+  free(build->cursors);
+  free(build->part_start);
+  return inserted;
+}
+
+struct hash_table table_from_arrays(void const *keys,
+                                    void const *values,
+                                    size_t count,
+                                    size_t key_size,
+                                    size_t value_size,
+                                    int (*cmpr)(void const *, void const *),
+                                    size_t (*hash)(void const *hashable, size_t size),
+                                    void (*destroy_key)(void *),
+                                    void (*destroy_value)(void *),
+                                    struct table_options const *options,
+                                    size_t threads) {
+  if (!keys || (!values && value_size)) goto empty_table;
+
+  struct hash_table table = table_create_ex(key_size, value_size, cmpr, hash, destroy_key, destroy_value, options);
+  if (!vec_data(&table._entries)) goto empty_table;
+
+  if (table._engine != TABLE_CHAINED) {
+    table_reserve(&table, count);
+
+    enum ds_error status[BATCH_WIDTH];
+    for (size_t start = 0; start < count; start += BATCH_WIDTH) {
+      size_t batch = count - start < BATCH_WIDTH ? count - start : BATCH_WIDTH;
+      char const *batch_values = values ? (char const *)values + start * value_size : NULL;
+
+      table_put_many(&table, (char const *)keys + start * key_size, batch_values, batch, status);
+      for (size_t i = 0; i < batch; i++) {
+        if (status[i] != DS_OK && status[i] != DS_VALUE_OK) goto destroy_table;
+      }
+    }
+    return table;
+  }
+
+  // the entries are grown in place, the table being empty. no incremental migration is involved
+  size_t capacity = capacity_for(&table, count, table_capacity(&table));
+  if (!capacity || !resize_table(&table, capacity)) goto destroy_table;
+
+  struct table_build build = {.count = count, .keys = keys, .table = &table, .values = values};
+  build.stride = table_align(table._value_offset + value_size);
+  if (count > SIZE_MAX / build.stride) goto destroy_table;
+
+  build.slab = malloc(count ? count * build.stride : 1);
+  if (!build.slab) goto destroy_table;
+  table._slab = build.slab;
+  table._slab_size = count * build.stride;
+
+#ifndef DS_PTHREADS
+  threads = 1;  // there are no threads to build on
+#endif
+
+  // one part per thread, each spanning a power of 2 number of buckets
+  size_t n_parts = 1;
+  unsigned part_shift = 0;
+  for (size_t c = capacity; c > 1; c >>= 1) part_shift++;
+  while (n_parts * 2 <= threads && n_parts * 2 <= BUILD_MAX_THREADS && n_parts * 2 <= capacity) {
+    n_parts *= 2;
+    part_shift--;
+  }
+  build.n_parts = n_parts;
+  build.part_shift = part_shift;
+
+  size_t inserted = n_parts > 1 && count ? build_parallel(&build) : SIZE_MAX;
+  if (inserted == SIZE_MAX) {
+    // a batch of keys is hashed and their entries prefetched ahead of linking them, as `table_put_many` does
+    size_t hashes[BATCH_WIDTH];
+    inserted = 0;
+    for (size_t start = 0; start < count; start += BATCH_WIDTH) {
+      size_t batch = count - start < BATCH_WIDTH ? count - start : BATCH_WIDTH;
+      batch_prepare(&table, build.keys + start * key_size, batch, hashes);
+
+      for (size_t i = 0; i < batch; i++) {
+        if (build_link(&build, start + i, hashes[i])) inserted++;
+      }
+    }
+  }
+
+  table._n_elem = inserted;
+  return table;
+
+destroy_table:
+  table_destroy(&table);
+empty_table:
+  return (struct hash_table){0};
+}
+
+void print_table(struct hash_table *table, void (*print)(void const *, void const *, size_t)) {
+  if (table && table->_engine == TABLE_OPEN_ADDRESSING) {
+    for (size_t i = 0; i < table_capacity(table); i++) {
+      void *slot = open_table_at(table, i);
+      if (slot) print(record_key(table, slot), record_value(table, slot), i);
+    }
+    return;
+  }
+
+  if (table && table->_engine != TABLE_CHAINED) {
+    for (size_t i = 0; i < vec_size(&table->_records); i++) {
+      void *record = record_at(table, i);
+      if (record) print(record_key(table, record), record_value(table, record), i);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < vec_size(&table->_old_entries); i++) {
+    struct entry *entry = vec_at(&table->_old_entries, i);
+    for (struct kv_pair *curr = entry->head; curr; curr = curr->next) {
+      print(record_key(table, curr), record_value(table, curr), i);
+    }
+  }
+
+  for (size_t i = 0; i < table_capacity(table); i++) {
+    struct entry *entry = vec_at(&table->_entries, i);
+    if (!entry) { continue; }
+
+    for (struct kv_pair *curr = entry->head; curr; curr = curr->next) {
+      print(record_key(table, curr), record_value(table, curr), i);
+    }
+  }
+}
+
+/* used internally to get the first record at or after the position `pos` of the engine's storage */
+static void *first_record_from(struct hash_table *table, size_t pos) {
+  if (table->_engine == TABLE_ORDERED) {
+    // skip the removed records
+    for (; pos < vec_size(&table->_records); pos++) {
+      void *record = record_at(table, pos);
+      if (record) return record;
+    }
+    return NULL;
+  }
+
+  if (table->_engine != TABLE_CHAINED && table->_engine != TABLE_OPEN_ADDRESSING) return record_at(table, pos);
+
+  for (; pos < table_capacity(table); pos++) {
+    if (table->_engine == TABLE_OPEN_ADDRESSING) {
+      void *slot = record_at(table, pos);
+      if (slot) return slot;
+    } else {
+      struct entry *entry = vec_at(&table->_entries, pos);
+      if (entry->head) return entry->head;
+    }
+  }
+
+  return NULL;
+}
+
+void *table_iter_begin(struct hash_table *table) {
+  if (!table || !vec_data(&table->_entries)) return NULL;
+
+  // a record may otherwise be in either the old or the new entries
+  migrate_entries(table, SIZE_MAX);
+
+  return first_record_from(table, 0);
+}
+
+void *table_iter_next(struct hash_table *table, void *iter) {
+  if (!table || !iter) return NULL;
+
+  switch (table->_engine) {
+    case TABLE_CHAINED: {
+      struct kv_pair *curr = iter;
+      return curr->next ? curr->next : first_record_from(table, entry_index(table, curr->hash) + 1);
+    }
+    case TABLE_OPEN_ADDRESSING: {
+      size_t pos = (size_t)((char *)iter - (char *)table->_entries._data) / table->_entries._data_size;
+      return first_record_from(table, pos + 1);
+    }
+    case TABLE_DENSE:
+    case TABLE_ORDERED:
+    case TABLE_FROZEN: {
+      size_t pos = (size_t)((char *)iter - (char *)table->_records._data) / table->_records._data_size;
+      return first_record_from(table, pos + 1);
+    }
+  }
+
+  return NULL;
+}
+
+void const *table_iter_key(struct hash_table const *table, void *iter) {
+  if (!table || !iter) return NULL;
+
+  return record_key(table, iter);
+}
+
+void *table_iter_value(struct hash_table const *table, void *iter) {
+  if (!table || !iter) return NULL;
+
+  return record_value(table, iter);
+}
+
+void table_for_each(struct hash_table *table, void (*fn)(void const *key, void *value, void *context), void *context) {
+  if (!fn) return;
+
+  for (void *iter = table_iter_begin(table); iter; iter = table_iter_next(table, iter)) {
+    fn(record_key(table, iter), record_value(table, iter), context);
+  }
+}
+
+bool table_contains(struct hash_table *restrict table, void const *restrict key) {
+  if (!table || !key) return false;
+
+  return table_contains_hashed(table, hash_wrapper(table, key), key);
+}
+
+bool table_contains_hashed(struct hash_table *restrict table, size_t hash, void const *restrict key) {
+  if (!table || !key) return false;
+  if (!vec_data(&table->_entries)) return false;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  bool found = table_find(table, hash, key) != NULL;
+  stats_lookup(table, TABLE_LOOKUP_GET, found);
+  return found;
+}
+
+/* used internally to get the pair following `pair` if it holds the same key, i.e. the next pair of a multimap key.
+ * returns NULL otherwise */
+static inline struct kv_pair *next_of_key(struct hash_table *table, struct kv_pair *pair) {
+  struct kv_pair *next = pair->next;
+  if (!next || next->hash != pair->hash) return NULL;
+
+  return table->_cmpr(record_key(table, pair), record_key(table, next)) == 0 ? next : NULL;
+}
+
+size_t table_get_all(struct hash_table *restrict table, void const *restrict key, struct table_range *restrict range) {
+  if (!range) return 0;
+  *range = (struct table_range){0};
+
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (!key) return 0;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  void *first = table_find(table, hash_wrapper(table, key), key);
+  stats_lookup(table, TABLE_LOOKUP_GET, first != NULL);
+  if (!first) return 0;
+
+  size_t count = 1;
+  if (table->_multimap) {
+    for (struct kv_pair *pair = next_of_key(table, first); pair; pair = next_of_key(table, pair)) { count++; }
+  }
+
+  *range = (struct table_range){._next = first, ._left = count};
+  return count;
+}
+
+void *table_range_next(struct table_range *range) {
+  if (!range || !range->_left) return NULL;
+
+  // only the range of a multimap holds more than a single pair, and said pairs are adjacent
+  void *record = range->_next;
+  if (--range->_left) range->_next = ((struct kv_pair *)record)->next;
+  return record;
+}
+
+size_t table_count(struct hash_table *restrict table, void const *restrict key) {
+  struct table_range range;
+  return table_get_all(table, key, &range);
+}
+
+size_t table_remove_all(struct hash_table *restrict table, void const *restrict key) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (table->_engine == TABLE_FROZEN) return 0;
+  if (!key) return 0;
+
+  migrate_entries(table, MIGRATION_STEP);
+
+  size_t hash = hash_wrapper(table, key);
+  void *record = table_find(table, hash, key);
+  stats_lookup(table, TABLE_LOOKUP_REMOVE, record != NULL);
+
+  size_t removed = 0;
+  while (record) {
+    // the next pair is found before its key (which it's compared against) is destroyed
+    void *next = table->_multimap ? next_of_key(table, record) : NULL;
+
+    if (table->_destroy_value && table->_value_size) { table->_destroy_value(record_value(table, record)); }
+    filter_erase(table, hash);
+    if (table->_destroy_key) { table->_destroy_key(record_key(table, record)); }
+    table_erase(table, record);
+    table->_n_elem--;
+
+    removed++;
+    record = next;
+  }
+
+  if (removed) shrink_if_sparse(table);
+  return removed;
+}
+
+bool table_rehashing(struct hash_table const *table) {
+  return table ? migrating(table) : false;
+}
+
+size_t table_rehash_pending(struct hash_table const *table) {
+  if (!table || !migrating(table)) return 0;
+
+  return vec_capacity(&table->_old_entries) - table->_migrated;
+}
+
+size_t table_rehash_step(struct hash_table *table, size_t count) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+
+  return migrate_entries(table, count);
+}
+
+size_t table_reserve(struct hash_table *table, size_t count) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (table->_engine == TABLE_FROZEN) return table_capacity(table);
+
+  size_t new_capacity = capacity_for(table, count, table_capacity(table));
+  if (new_capacity > table_capacity(table)) rehash_table(table, new_capacity);
+
+  return table_capacity(table);
+}
+
+size_t table_shrink_to_fit(struct hash_table *table) {
+  if (!table || !vec_data(&table->_entries)) return 0;
+  if (table->_engine == TABLE_FROZEN) return table_capacity(table);
+
+  size_t new_capacity = capacity_for(table, table->_n_elem, TABLE_MIN_CAPACITY);
+  if (new_capacity && new_capacity < table_capacity(table)) rehash_table(table, new_capacity);
+
+  return table_capacity(table);
+}
+
+enum ds_error table_build_frozen(struct hash_table *table, struct hash_table *frozen) {
+  // a minimal perfect hash maps every key to a single record
+  if (table->_multimap) return DS_ERROR;
+
+  size_t count = table->_n_elem;
+  void **records = malloc((count ? count : 1) * sizeof *records);
+  size_t *hashes = malloc((count ? count : 1) * sizeof *hashes);
+  if (!records || !hashes) {
+    free(records);
+    free(hashes);
+    return DS_NO_MEM;
+  }
+
+  size_t n_records = 0;
+  for (void *iter = table_iter_begin(table); iter; iter = table_iter_next(table, iter), n_records++) {
+    records[n_records] = iter;
+    hashes[n_records] = hash_wrapper(table, record_key(table, iter));
+  }
+
+  *frozen = *table;
+  enum ds_error ret = frozen_table_init(frozen, table, records, hashes, n_records);
+  free(records);
+  free(hashes);
+  if (ret != DS_OK) return ret;
+
+  frozen->_engine = TABLE_FROZEN;
+  frozen->_old_entries = (struct vec){0};
+  frozen->_migrated = 0;
+  frozen->_slab = NULL;
+  frozen->_slab_size = 0;
+  frozen->_ctrl = NULL;
+  frozen->_n_deleted = 0;
+  return DS_OK;
+}
+
+enum ds_error table_freeze(struct hash_table *table) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (table->_engine == TABLE_FROZEN) return DS_OK;
+
+  struct hash_table frozen;
+  enum ds_error ret = table_build_frozen(table, &frozen);
+  if (ret != DS_OK) return ret;
+
+  // the keys and values were moved into the frozen storage
+  storage_destroy(table, false);
+  *table = frozen;
+  return DS_OK;
+}
+
+#ifdef DS_TABLE_STATS
+uint64_t table_stats_clock(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+#endif
+
+/* used internally to add a chain of `length` to the histogram of `stats` */
+static inline void count_chain(struct table_stats *stats, size_t length) {
+  stats->chain_lengths[length < TABLE_STATS_CHAINS ? length : TABLE_STATS_CHAINS - 1]++;
+  if (length > stats->max_chain_length) stats->max_chain_length = length;
+}
+
+/* used internally to add the chains of a vec of entries to the histogram of `stats` */
+static void count_entries(struct table_stats *stats, struct vec *entries) {
+  for (size_t i = 0; i < vec_size(entries); i++) {
+    size_t length = 0;
+    for (struct kv_pair *curr = ((struct entry *)vec_at(entries, i))->head; curr; curr = curr->next) { length++; }
+    count_chain(stats, length);
+  }
+}
+
+enum ds_error table_stats(struct hash_table *restrict table, struct table_stats *restrict stats) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (!stats) return DS_ERROR;
+
+  *stats = (struct table_stats){.size = table->_n_elem, .capacity = table_capacity(table)};
+
+  switch (table->_engine) {
+    case TABLE_CHAINED:
+      // every node is a separate allocation
+      stats->bytes = table->_n_elem * (table->_value_offset + table->_value_size);
+      if (migrating(table)) count_entries(stats, &table->_old_entries);
+      count_entries(stats, &table->_entries);
+      break;
+    case TABLE_OPEN_ADDRESSING:
+      stats->bytes = table_capacity(table);  // the control bytes
+      for (size_t pos = 0; pos < table_capacity(table); pos++) {
+        if (open_table_at(table, pos)) count_chain(stats, open_table_probe_length(table, pos));
+      }
+      break;
+    case TABLE_DENSE:
+      for (size_t bucket = 0; bucket < table_capacity(table); bucket++) {
+        count_chain(stats, dense_table_chain_length(table, bucket));
+      }
+      break;
+    case TABLE_ORDERED:
+      for (size_t pos = 0; pos < vec_size(&table->_records); pos++) {
+        if (ordered_table_at(table, pos)) count_chain(stats, ordered_table_probe_length(table, pos));
+      }
+      break;
+    case TABLE_FROZEN:
+      for (size_t i = 0; i < table->_n_elem; i++) { count_chain(stats, 1); }
+      break;
+  }
+
+  if (table->_mapping) {
+    stats->bytes = table->_mapping_size;
+  } else {
+    stats->bytes += vec_capacity(&table->_entries) * table->_entries._data_size;
+    stats->bytes += vec_capacity(&table->_old_entries) * table->_old_entries._data_size;
+    stats->bytes += vec_capacity(&table->_records) * table->_records._data_size;
+  }
+
+#ifdef DS_TABLE_STATS
+  struct table_counters const *counters = &table->_stats;
+  stats->gets = counters->_lookups[TABLE_LOOKUP_GET];
+  stats->puts = counters->_lookups[TABLE_LOOKUP_PUT];
+  stats->removes = counters->_lookups[TABLE_LOOKUP_REMOVE];
+  if (stats->gets) stats->avg_get_probes = (double)counters->_lookup_probes[TABLE_LOOKUP_GET] / (double)stats->gets;
+  if (stats->puts) stats->avg_put_probes = (double)counters->_lookup_probes[TABLE_LOOKUP_PUT] / (double)stats->puts;
+  if (stats->removes) {
+    stats->avg_remove_probes = (double)counters->_lookup_probes[TABLE_LOOKUP_REMOVE] / (double)stats->removes;
+  }
+  stats->hits = counters->_hits;
+  stats->misses = counters->_misses;
+  stats->resizes = counters->_resizes;
+  stats->resize_ns = counters->_resize_ns;
+#endif
+
+  return DS_OK;
+}
 
-  return entry_contains(entry, key, table->_cmpr) != NULL;
+void table_stats_reset(struct hash_table *table) {
+#ifdef DS_TABLE_STATS
+  if (table) table->_stats = (struct table_counters){0};
+#else
+  (void)table;
+#endif
 }
@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+#include "vec.h"
+
+/* dense storage. the records are kept contiguously in hash_table::_records, in no particular order. the buckets
+ * (hash_table::_entries) hold the index of the first record of their chain, and each record holds the index of the
+ * next one. indices are stored off by one, so a zeroed bucket / link means 'none'. removing a record moves the last
+ * record into its place, which keeps the records contiguous */
+
+struct dense_node {
+  size_t next;  // the index of the next record in the chain + 1
+
+  // the full hash of the key. spares rehashing on resize and most cmpr calls on lookup
+  size_t hash;
+};
+
+static inline struct dense_node *record_at(struct hash_table *table, size_t idx) {
+  return (struct dense_node *)((char *)table->_records._data + idx * table->_records._data_size);
+}
+
+static inline size_t record_index(struct hash_table *table, void const *record) {
+  return (size_t)((char const *)record - (char *)table->_records._data) / table->_records._data_size;
+}
+
+static inline size_t *bucket_of(struct hash_table *table, size_t hash) {
+  return (size_t *)table->_entries._data + (hash & (table_capacity(table) - 1));
+}
+
+/* used internally to link every record into zeroed buckets */
+static void link_records(struct hash_table *table) {
+  for (size_t idx = 0; idx < vec_size(&table->_records); idx++) {
+    struct dense_node *node = record_at(table, idx);
+    size_t *bucket = bucket_of(table, node->hash);
+
+    node->next = *bucket;
+    *bucket = idx + 1;
+  }
+}
+
+bool dense_table_init(struct hash_table *table, size_t capacity) {
+  if (!table) return false;
+  if (capacity < TABLE_MIN_CAPACITY || capacity & (capacity - 1)) return false;
+
+  struct vec buckets = vec_create(sizeof(size_t), NULL);
+  struct vec records = vec_create(table_pack_record(table, sizeof(struct dense_node), sizeof(size_t)), NULL);
+  if (!vec_data(&buckets) || !vec_data(&records) || vec_resize(&buckets, capacity) != capacity) goto failure;
+
+  size_t max_elements = table_max_elements(table, capacity);
+  if (vec_resize(&records, max_elements) < max_elements) goto failure;
+
+  buckets._n_elem = capacity;
+  table->_entries = buckets;
+  table->_records = records;
+  return true;
+
+failure:
+  vec_destroy(&buckets);
+  vec_destroy(&records);
+  return false;
+}
+
+void dense_table_destroy(struct hash_table *table) {
+  if (!table) return;
+
+  vec_destroy(&table->_entries);
+  vec_destroy(&table->_records);
+}
+
+void *dense_table_at(struct hash_table *table, size_t pos) {
+  if (!table || pos >= vec_size(&table->_records)) return NULL;
+
+  return record_at(table, pos);
+}
+
+void *dense_table_find(struct hash_table *table, size_t hash, void const *key) {
+  for (size_t idx = *bucket_of(table, hash); idx; idx = record_at(table, idx - 1)->next) {
+    struct dense_node *node = record_at(table, idx - 1);
+    TABLE_STATS_PROBE(table);
+    if (node->hash == hash && table->_cmpr(key, (char *)node + table->_key_offset) == 0) return node;
+  }
+
+  return NULL;
+}
+
+bool dense_table_resize(struct hash_table *table, size_t capacity) {
+  TABLE_STATS_CLOCK(start);
+  if (capacity < table_capacity(table)) {
+    // shrinking. a fresh vec of buckets, so a failure leaves the table as is
+    struct vec buckets = vec_create(sizeof(size_t), NULL);
+    if (vec_resize(&buckets, capacity) != capacity) {
+      vec_destroy(&buckets);
+      return false;
+    }
+    buckets._n_elem = capacity;
+
+    vec_destroy(&table->_entries);
+    table->_entries = buckets;
+
+    // return the excess records as well. shrinking an empty vec would free it altogether
+    if (vec_size(&table->_records)) vec_shrink(&table->_records);
+  } else {
+    size_t max_elements = table_max_elements(table, capacity);
+    if (vec_capacity(&table->_records) < max_elements && vec_resize(&table->_records, max_elements) < max_elements) {
+      return false;
+    }
+
+    if (vec_resize(&table->_entries, capacity) != capacity) return false;
+    table->_entries._n_elem = capacity;
+    memset(table->_entries._data, 0, capacity * sizeof(size_t));
+  }
+
+  link_records(table);
+  TABLE_STATS_RESIZED(table, start);
+  return true;
+}
+
+void *dense_table_insert(struct hash_table *table, size_t hash) {
+  size_t capacity = table_capacity(table);
+  if (table->_n_elem + 1 > table_max_elements(table, capacity)) {
+    if ((SIZE_MAX >> 1) >> table->_growth < capacity) return NULL;
+    if (!dense_table_resize(table, capacity << table->_growth)) return NULL;
+  }
+
+  // the records may have been shrunk below the max load
+  struct vec *records = &table->_records;
+  if (vec_size(records) == vec_capacity(records)) {
+    size_t needed = table_max_elements(table, table_capacity(table));
+    if (needed <= vec_size(records)) needed = vec_size(records) + 1;
+    if (vec_resize(records, needed) < needed) return NULL;
+  }
+
+  size_t idx = records->_n_elem++;
+  size_t *bucket = bucket_of(table, hash);
+
+  struct dense_node *node = record_at(table, idx);
+  *node = (struct dense_node){.next = *bucket, .hash = hash};
+  *bucket = idx + 1;
+  return node;
+}
+
+/* used internally to get the link (either a bucket or a record's `next`) which holds `idx` */
+static size_t *link_to(struct hash_table *table, size_t hash, size_t idx) {
+  size_t *link = bucket_of(table, hash);
+  while (*link != idx + 1) link = &record_at(table, *link - 1)->next;
+  return link;
+}
+
+void dense_table_erase(struct hash_table *table, void *record) {
+  struct dense_node *removed = record;
+  size_t idx = record_index(table, record);
+  *link_to(table, removed->hash, idx) = removed->next;
+
+  // fill the hole with the last record
+  size_t last = --table->_records._n_elem;
+  if (idx == last) return;
+
+  struct dense_node *moved = record_at(table, last);
+  *link_to(table, moved->hash, last) = idx + 1;
+  memcpy(removed, moved, table->_records._data_size);
+}
+
+void dense_table_prefetch(struct hash_table *table, size_t hash) {
+  size_t idx = *bucket_of(table, hash);
+  if (idx) TABLE_PREFETCH(record_at(table, idx - 1));
+}
+
+size_t dense_table_chain_length(struct hash_table *table, size_t bucket) {
+  size_t length = 0;
+  for (size_t idx = ((size_t *)table->_entries._data)[bucket]; idx; idx = record_at(table, idx - 1)->next) { length++; }
+  return length;
+}
@@ -0,0 +1,202 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+#include "vec.h"
+
+/* a frozen table is a minimal perfect hash in the spirit of CHD (hash, displace and compress). the `n` keys are split
+ * into about n / FROZEN_BUCKET_LOAD buckets by their hash. each bucket is assigned a pilot, such that hashing the keys
+ * of the bucket with said pilot maps them into distinct, yet unoccupied positions in [0, n). buckets are placed from
+ * the largest to the smallest, which keeps the large (hard to place) buckets from competing over the last free
+ * positions. single key buckets are placed directly: their pilot holds the key's position instead.
+ *
+ * the pilots live in hash_table::_entries and the records (the keys and values, packed) in hash_table::_records.
+ * a lookup is a single probe, followed by a single cmpr call */
+
+#define FROZEN_BUCKET_LOAD 4
+#define FROZEN_MAX_PILOT ((size_t)1 << 24)
+#define FROZEN_DIRECT (~(SIZE_MAX >> 1))  // a pilot holding a position rather than a displacement
+
+static inline size_t bucket_of(size_t hash, size_t n_buckets) {
+  return (size_t)(wy_mix((uint64_t)hash, WY_P3) % n_buckets);
+}
+
+static inline size_t position_of(size_t hash, size_t pilot, size_t n_records) {
+  return (size_t)(wy_mix((uint64_t)hash ^ WY_P0, (uint64_t)pilot ^ WY_P2) % n_records);
+}
+
+static inline void *record_at(struct hash_table *table, size_t pos) {
+  return (char *)table->_records._data + pos * table->_records._data_size;
+}
+
+/* used internally to try placing every key of a bucket with `pilot`. `positions` receives their positions */
+static bool try_pilot(size_t const *hashes,
+                      size_t const *members,
+                      size_t count,
+                      size_t pilot,
+                      unsigned char const *taken,
+                      size_t n_records,
+                      size_t *positions) {
+  for (size_t i = 0; i < count; i++) {
+    positions[i] = position_of(hashes[members[i]], pilot, n_records);
+    if (taken[positions[i]]) return false;
+
+    for (size_t j = 0; j < i; j++) {
+      if (positions[j] == positions[i]) return false;
+    }
+  }
+
+  return true;
+}
+
+enum ds_error frozen_table_init(struct hash_table *frozen,
+                                struct hash_table const *source,
+                                void *const *records,
+                                size_t const *hashes,
+                                size_t count) {
+  size_t n_buckets = count / FROZEN_BUCKET_LOAD + 1;
+  enum ds_error ret = DS_NO_MEM;
+
+  // the keys sorted by their bucket (a counting sort), and the buckets sorted by their size (descending)
+  size_t *bucket_start = calloc(n_buckets + 1, sizeof *bucket_start);
+  size_t *members = malloc((count ? count : 1) * sizeof *members);
+  size_t *by_size = malloc(n_buckets * sizeof *by_size);
+  size_t *positions = NULL;
+  size_t *placement = malloc((count ? count : 1) * sizeof *placement);
+  unsigned char *taken = calloc(count ? count : 1, 1);
+
+  struct vec pilots = vec_create(sizeof(size_t), NULL);
+  size_t record_size = table_pack_record(frozen, 0, 1);
+  size_t value_offset = frozen->_value_offset;
+  struct vec packed = vec_create(record_size, NULL);
+
+  if (!bucket_start || !members || !by_size || !placement || !taken || !vec_data(&pilots) || !vec_data(&packed)) {
+    goto cleanup;
+  }
+  if (vec_resize(&pilots, n_buckets) < n_buckets || vec_resize(&packed, count) < count) goto cleanup;
+
+  for (size_t i = 0; i < count; i++) { bucket_start[bucket_of(hashes[i], n_buckets) + 1]++; }
+
+  size_t max_size = 0;
+  for (size_t b = 0; b < n_buckets; b++) {
+    if (bucket_start[b + 1] > max_size) max_size = bucket_start[b + 1];
+    bucket_start[b + 1] += bucket_start[b];
+  }
+
+  // bucket_start[b] is used as the insertion cursor of the bucket `b`, and is restored right after
+  for (size_t i = 0; i < count; i++) { members[bucket_start[bucket_of(hashes[i], n_buckets)]++] = i; }
+  for (size_t b = n_buckets; b > 0; b--) { bucket_start[b] = bucket_start[b - 1]; }
+  bucket_start[0] = 0;
+
+  size_t n_sorted = 0;
+  for (size_t size = max_size; size > 0; size--) {
+    for (size_t b = 0; b < n_buckets; b++) {
+      if (bucket_start[b + 1] - bucket_start[b] == size) by_size[n_sorted++] = b;
+    }
+  }
+
+  positions = malloc((max_size ? max_size : 1) * sizeof *positions);
+  if (!positions) goto cleanup;
+
+  size_t *pilot_of = pilots._data;
+  size_t next_free = 0;
+  for (size_t i = 0; i < n_sorted; i++) {
+    size_t b = by_size[i];
+    size_t const *bucket = members + bucket_start[b];
+    size_t size = bucket_start[b + 1] - bucket_start[b];
+
+    if (size == 1) {
+      while (taken[next_free]) next_free++;
+      positions[0] = next_free;
+      pilot_of[b] = FROZEN_DIRECT | next_free;
+    } else {
+      // keys sharing their full hash can't ever be told apart
+      for (size_t k = 1; k < size; k++) {
+        for (size_t j = 0; j < k; j++) {
+          if (hashes[bucket[j]] != hashes[bucket[k]]) continue;
+
+          ret = DS_ERROR;
+          goto cleanup;
+        }
+      }
+
+      size_t pilot = 0;
+      while (!try_pilot(hashes, bucket, size, pilot, taken, count, positions)) {
+        if (++pilot == FROZEN_MAX_PILOT) {
+          ret = DS_ERROR;
+          goto cleanup;
+        }
+      }
+      pilot_of[b] = pilot;
+    }
+
+    for (size_t k = 0; k < size; k++) {
+      taken[positions[k]] = 1;
+      placement[bucket[k]] = positions[k];
+    }
+  }
+  pilots._n_elem = n_buckets;
+
+  for (size_t i = 0; i < count; i++) {
+    char *record = (char *)packed._data + placement[i] * packed._data_size;
+    memcpy(record, (char *)records[i] + source->_key_offset, source->_key_size);
+    if (source->_value_size) {
+      memcpy(record + value_offset, (char *)records[i] + source->_value_offset, source->_value_size);
+    }
+  }
+  packed._n_elem = count;
+
+  frozen->_entries = pilots;
+  frozen->_records = packed;
+  pilots = packed = (struct vec){0};
+  ret = DS_OK;
+
+cleanup:
+  vec_destroy(&pilots);
+  vec_destroy(&packed);
+  free(bucket_start);
+  free(members);
+  free(by_size);
+  free(positions);
+  free(placement);
+  free(taken);
+  return ret;
+}
+
+void frozen_table_destroy(struct hash_table *table) {
+  if (!table) return;
+
+  vec_destroy(&table->_entries);
+  vec_destroy(&table->_records);
+}
+
+void *frozen_table_at(struct hash_table *table, size_t pos) {
+  if (!table || pos >= vec_size(&table->_records)) return NULL;
+
+  return record_at(table, pos);
+}
+
+/* used internally to get the only position `hash` might be at */
+static inline size_t frozen_position(struct hash_table *table, size_t hash) {
+  size_t pilot = ((size_t *)table->_entries._data)[bucket_of(hash, vec_size(&table->_entries))];
+  return pilot & FROZEN_DIRECT ? pilot & ~FROZEN_DIRECT : position_of(hash, pilot, vec_size(&table->_records));
+}
+
+void *frozen_table_find(struct hash_table *table, size_t hash, void const *key) {
+  if (!vec_size(&table->_records)) return NULL;
+
+  void *record = record_at(table, frozen_position(table, hash));
+  TABLE_STATS_PROBE(table);
+  return table->_cmpr(key, (char *)record + table->_key_offset) == 0 ? record : NULL;
+}
+
+void frozen_table_prefetch_pilot(struct hash_table *table, size_t hash) {
+  TABLE_PREFETCH((size_t *)table->_entries._data + bucket_of(hash, vec_size(&table->_entries)));
+}
+
+void frozen_table_prefetch(struct hash_table *table, size_t hash) {
+  if (!vec_size(&table->_records)) return;
+
+  TABLE_PREFETCH(record_at(table, frozen_position(table, hash)));
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "defines.h"
+#include "hash_table.h"
+
+/**
+ * @file hash_table_internal.h
+ * @brief definitions shared between the hash table engines. not part of the public interface
+ */
+
+#define TABLE_GROWTH 1  // log2 of the default growth factor
+#define TABLE_INIT_CAPACITY 32
+#define TABLE_MIN_CAPACITY 16  // must be at least the open addressing group width
+#define TABLE_CHAINED_LOAD_FACTOR 0.7
+#define TABLE_OPEN_LOAD_FACTOR 0.875
+#define TABLE_ORDERED_LOAD_FACTOR (2.0 / 3)  // as CPython's compact dict
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TABLE_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define TABLE_PREFETCH(addr) ((void)(addr))
+#endif
+
+/* used internally to figure out the strictest fundamental alignment. the inline keys / values of separately allocated
+ * nodes are placed on such boundaries */
+union table_max_align {
+  long double ld;
+  long long ll;
+  void *ptr;
+  void (*fptr)(void);
+};
+
+struct table_align_probe {
+  char c;
+  union table_max_align u;
+};
+
+#define TABLE_ALIGNMENT (offsetof(struct table_align_probe, u))
+
+/* used internally to round `size` up to the next multiple of TABLE_ALIGNMENT */
+static inline size_t table_align(size_t size) {
+  return (size + TABLE_ALIGNMENT - 1) & ~(TABLE_ALIGNMENT - 1);
+}
+
+/* used internally to get the largest alignment an object of `size` bytes might require. an object's alignment always
+ * divides its size */
+static inline size_t size_alignment(size_t size) {
+  if (!size) return 1;
+
+  size_t alignment = size & (~size + 1);  // the lowest set bit
+  return alignment > TABLE_ALIGNMENT ? TABLE_ALIGNMENT : alignment;
+}
+
+static inline size_t align_to(size_t size, size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/* used internally to lay out the records of a table which keeps them in an array: a `header_size` bytes header
+ * (aligned on `header_alignment`), the key and the value, each at its natural alignment. sets hash_table::_key_offset
+ * and hash_table::_value_offset, and returns the size of a record, padded such that consecutive records stay aligned */
+static inline size_t table_pack_record(struct hash_table *table, size_t header_size, size_t header_alignment) {
+  size_t key_alignment = size_alignment(table->_key_size);
+  size_t value_alignment = size_alignment(table->_value_size);
+
+  size_t alignment = header_alignment;
+  if (alignment < key_alignment) alignment = key_alignment;
+  if (alignment < value_alignment) alignment = value_alignment;
+
+  table->_key_offset = align_to(header_size, key_alignment);
+  table->_value_offset = align_to(table->_key_offset + table->_key_size, value_alignment);
+  return align_to(table->_value_offset + table->_value_size, alignment);
+}
+
+/* the default hash is a word at a time hash in the spirit of wyhash (https://github.com/wangyi-fudan/wyhash). keys are
+ * read 8 bytes at a time (in the native byte order) and mixed with 64x64->128 bit multiplications */
+
+#define WY_P0 0xa0761d6478bd642fULL
+#define WY_P1 0xe7037ed1a0b428dbULL
+#define WY_P2 0x8ebc6af09c88c6e3ULL
+#define WY_P3 0x589965cc75374cc3ULL
+
+/* used internally to multiply 2 64 bit numbers into a 128 bit one. `a` is set to the low half, `b` to the high one */
+static inline void wy_mum(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 wy_u128;
+  wy_u128 r = (wy_u128)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), carry = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+  wy_mum(&a, &b);
+  return a ^ b;
+}
+
+static inline uint64_t wy_read8(unsigned char const *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof v);
+  return v;
+}
+
+static inline uint64_t wy_read4(unsigned char const *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof v);
+  return v;
+}
+
+/* used internally to hash the keys */
+static inline uint64_t default_hash(void const *key, size_t key_size, uint64_t seed) {
+  unsigned char const *p = key;
+  uint64_t a, b;
+
+  seed ^= wy_mix(seed ^ WY_P0, WY_P1);
+  if (key_size <= 16) {
+    if (key_size >= 4) {
+      size_t skip = (key_size >> 3) << 2;
+      a = (wy_read4(p) << 32) | wy_read4(p + skip);
+      b = (wy_read4(p + key_size - 4) << 32) | wy_read4(p + key_size - 4 - skip);
+    } else if (key_size > 0) {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[key_size >> 1] << 8) | p[key_size - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t left = key_size;
+    if (left > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = wy_mix(wy_read8(p) ^ WY_P1, wy_read8(p + 8) ^ seed);
+        see1 = wy_mix(wy_read8(p + 16) ^ WY_P2, wy_read8(p + 24) ^ see1);
+        see2 = wy_mix(wy_read8(p + 32) ^ WY_P3, wy_read8(p + 40) ^ see2);
+        p += 48;
+        left -= 48;
+      } while (left > 48);
+      seed ^= see1 ^ see2;
+    }
+
+    for (; left > 16; left -= 16, p += 16) { seed = wy_mix(wy_read8(p) ^ WY_P1, wy_read8(p + 8) ^ seed); }
+
+    a = wy_read8(p + left - 16);
+    b = wy_read8(p + left - 8);
+  }
+
+  a ^= WY_P1;
+  b ^= seed;
+  wy_mum(&a, &b);
+  return wy_mix(a ^ WY_P0 ^ key_size, b ^ WY_P1);
+}
+
+/* used internally to spread the bits of a user supplied hash. the engines reduce hashes with a mask (i.e. only use
+ * some of the bits), which a weak hash (e.g. the identity of an integer) would otherwise cluster on */
+static inline size_t mix_hash(size_t hash) {
+  return (size_t)wy_mix((uint64_t)hash ^ WY_P0, WY_P1);
+}
+
+/* used internally to pick a random seed for the default hash (hash_table.c) */
+uint64_t table_random_seed(void);
+
+/* used internally to get the full hash of a key. the reduction into a position is up to each engine */
+static inline size_t hash_wrapper(struct hash_table const *table, void const *key) {
+  return table->_hash ? mix_hash(table->_hash(key, table->_key_size))
+                      : (size_t)default_hash(key, table->_key_size, table->_seed);
+}
+
+/* used internally to get the number of elements a table of `capacity` entries may hold before it grows */
+static inline size_t table_max_elements(struct hash_table const *table, size_t capacity) {
+  return (size_t)((double)capacity * table->_max_load);
+}
+
+/* instrumentation (see `table_stats`). compiled out unless DS_TABLE_STATS is defined. the engines count the probes of
+ * their lookups and time their resizes, the lookups themselves are accounted for by hash_table.c */
+
+enum table_lookup {
+  TABLE_LOOKUP_GET,
+  TABLE_LOOKUP_PUT,
+  TABLE_LOOKUP_REMOVE,
+};
+
+#ifdef DS_TABLE_STATS
+/* used internally to read a monotonic clock, in nanoseconds (hash_table.c) */
+uint64_t table_stats_clock(void);
+
+#define TABLE_STATS_PROBE(table) ((table)->_stats._probes++)
+#define TABLE_STATS_CLOCK(start) uint64_t start = table_stats_clock()
+#define TABLE_STATS_RESIZED(table, start) \
+  ((table)->_stats._resizes++, (table)->_stats._resize_ns += table_stats_clock() - (start))
+#else
+#define TABLE_STATS_PROBE(table) ((void)0)
+#define TABLE_STATS_CLOCK(start) ((void)0)
+#define TABLE_STATS_RESIZED(table, start) ((void)0)
+#endif
+
+/* open addressing engine (hash_table_open.c). slots hold the key at hash_table::_key_offset (0) and the value at
+ * hash_table::_value_offset */
+bool open_table_init(struct hash_table *table, size_t capacity);
+void open_table_destroy(struct hash_table *table);
+void *open_table_at(struct hash_table *table, size_t pos);
+void *open_table_find(struct hash_table *table, size_t hash, void const *key);
+bool open_table_resize(struct hash_table *table, size_t capacity);
+void *open_table_insert(struct hash_table *table, size_t hash);
+void open_table_erase(struct hash_table *table, void *slot);
+void open_table_prefetch(struct hash_table *table, size_t hash);
+size_t open_table_probe_length(struct hash_table *table, size_t pos);
+
+/* dense engine (hash_table_dense.c). records hold their key at hash_table::_key_offset and value at
+ * hash_table::_value_offset */
+bool dense_table_init(struct hash_table *table, size_t capacity);
+void dense_table_destroy(struct hash_table *table);
+void *dense_table_at(struct hash_table *table, size_t pos);
+void *dense_table_find(struct hash_table *table, size_t hash, void const *key);
+bool dense_table_resize(struct hash_table *table, size_t capacity);
+void *dense_table_insert(struct hash_table *table, size_t hash);
+void dense_table_erase(struct hash_table *table, void *record);
+void dense_table_prefetch(struct hash_table *table, size_t hash);
+size_t dense_table_chain_length(struct hash_table *table, size_t bucket);
+
+/* ordered engine (hash_table_ordered.c). records hold their key at hash_table::_key_offset and value at
+ * hash_table::_value_offset, in insertion order. removed records remain in place (ordered_table_at returns NULL for
+ * them) until the records are compacted */
+bool ordered_table_init(struct hash_table *table, size_t capacity);
+void ordered_table_destroy(struct hash_table *table);
+void *ordered_table_at(struct hash_table *table, size_t pos);
+void *ordered_table_find(struct hash_table *table, size_t hash, void const *key);
+bool ordered_table_resize(struct hash_table *table, size_t capacity);
+void *ordered_table_insert(struct hash_table *table, size_t hash);
+void ordered_table_erase(struct hash_table *table, void *record);
+void ordered_table_prefetch(struct hash_table *table, size_t hash);
+size_t ordered_table_probe_length(struct hash_table *table, size_t pos);
+
+/* frozen engine (hash_table_frozen.c). records hold their key at offset 0 and value at hash_table::_value_offset.
+ * frozen_table_init builds the engine's storage into `frozen` out of the `count` records of `source` */
+enum ds_error frozen_table_init(struct hash_table *frozen,
+                                struct hash_table const *source,
+                                void *const *records,
+                                size_t const *hashes,
+                                size_t count);
+void frozen_table_destroy(struct hash_table *table);
+void *frozen_table_at(struct hash_table *table, size_t pos);
+void *frozen_table_find(struct hash_table *table, size_t hash, void const *key);
+void frozen_table_prefetch_pilot(struct hash_table *table, size_t hash);
+void frozen_table_prefetch(struct hash_table *table, size_t hash);
+
+/* used internally to build a frozen copy of `table` into `frozen`, leaving `table` as is. the keys and values are
+ * copied shallowly (hash_table.c) */
+enum ds_error table_build_frozen(struct hash_table *table, struct hash_table *frozen);
+
+/* used internally to release the mapping of a table opened by table_open_mapped (hash_table_mapped.c) */
+void mapped_table_unmap(struct hash_table *table);
@@ -0,0 +1,212 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hash_table_internal.h"
+#include "vec.h"
+
+/* a snapshot is a header followed by the pilots and the records of a frozen table. every section starts on a
+ * SNAPSHOT_ALIGNMENT boundary, and all the locations are offsets from the start of the snapshot. the pilots are native
+ * `size_t`s, and the header records the word size so that a snapshot isn't misread on a different platform */
+
+#define SNAPSHOT_MAGIC "libdsht"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ALIGNMENT 64
+#define SNAPSHOT_DEFAULT_HASH 0x1
+
+struct snapshot_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t word_size;
+
+  uint64_t flags;
+  uint64_t seed;
+
+  uint64_t key_size;
+  uint64_t value_size;
+  uint64_t value_offset;
+  uint64_t record_size;
+
+  uint64_t n_records;
+  uint64_t n_buckets;
+  uint64_t pilots_offset;
+  uint64_t records_offset;
+  uint64_t file_size;
+};
+
+static inline uint64_t snapshot_align(uint64_t offset) {
+  return (offset + SNAPSHOT_ALIGNMENT - 1) & ~(uint64_t)(SNAPSHOT_ALIGNMENT - 1);
+}
+
+/* used internally to write `size` bytes at the file offset `offset`, resuming after partial writes and interrupts */
+static bool write_all(int fd, void const *data, size_t size, uint64_t offset) {
+  char const *curr = data;
+  while (size) {
+    ssize_t written = pwrite(fd, curr, size, (off_t)offset);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+
+    curr += written;
+    size -= (size_t)written;
+    offset += (uint64_t)written;
+  }
+
+  return true;
+}
+
+/* used internally to pad the snapshot with zeros from `offset` up to `target` */
+static bool write_padding(int fd, uint64_t offset, uint64_t target) {
+  static char const zeros[SNAPSHOT_ALIGNMENT] = {0};
+  return write_all(fd, zeros, (size_t)(target - offset), offset);
+}
+
+enum ds_error table_save(struct hash_table *table, int fd) {
+  if (!table || !vec_data(&table->_entries)) return DS_ERROR;
+  if (fd < 0) return DS_ERROR;
+
+  // a table which isn't frozen is frozen into a temporary copy
+  struct hash_table frozen = *table;
+  if (table->_engine != TABLE_FROZEN) {
+    enum ds_error ret = table_build_frozen(table, &frozen);
+    if (ret != DS_OK) return ret;
+  }
+
+  size_t n_buckets = vec_size(&frozen._entries);
+  size_t n_records = vec_size(&frozen._records);
+  size_t record_size = frozen._records._data_size;
+
+  struct snapshot_header header = {.magic = SNAPSHOT_MAGIC,
+                                   .version = SNAPSHOT_VERSION,
+                                   .word_size = sizeof(size_t),
+                                   .flags = table->_hash ? 0 : SNAPSHOT_DEFAULT_HASH,
+                                   .seed = table->_seed,
+                                   .key_size = table->_key_size,
+                                   .value_size = table->_value_size,
+                                   .value_offset = frozen._value_offset,
+                                   .record_size = record_size,
+                                   .n_records = n_records,
+                                   .n_buckets = n_buckets};
+  header.pilots_offset = snapshot_align(sizeof header);
+  header.records_offset = snapshot_align(header.pilots_offset + n_buckets * sizeof(size_t));
+  header.file_size = header.records_offset + n_records * record_size;
+
+  // the snapshot replaces the whole file, as `table_open_mapped` maps it from its start and expects its exact size
+  bool success = ftruncate(fd, (off_t)header.file_size) == 0 && write_all(fd, &header, sizeof header, 0) &&
+                 write_padding(fd, sizeof header, header.pilots_offset) &&
+                 write_all(fd, vec_data(&frozen._entries), n_buckets * sizeof(size_t), header.pilots_offset) &&
+                 write_padding(fd, header.pilots_offset + n_buckets * sizeof(size_t), header.records_offset) &&
+                 write_all(fd, vec_data(&frozen._records), n_records * record_size, header.records_offset);
+
+  if (table->_engine != TABLE_FROZEN) frozen_table_destroy(&frozen);
+  return success ? DS_OK : DS_ERROR;
+}
+
+/* used internally to check that a header describes a snapshot this build can read, of exactly `file_size` bytes */
+static bool header_valid(struct snapshot_header const *header, uint64_t file_size) {
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof header->magic) != 0) return false;
+  if (header->version != SNAPSHOT_VERSION || header->word_size != sizeof(size_t)) return false;
+  if (header->file_size != file_size) return false;
+
+  if (!header->key_size || !header->n_buckets || !header->record_size) return false;
+  if (header->key_size > SIZE_MAX / 2 || header->value_size > SIZE_MAX / 2) return false;
+
+  // the records must be laid out as the frozen engine lays them out, or their keys / values would be misaligned
+  struct hash_table layout = {._key_size = (size_t)header->key_size, ._value_size = (size_t)header->value_size};
+  if (header->record_size != table_pack_record(&layout, 0, 1) || header->value_offset != layout._value_offset) {
+    return false;
+  }
+
+  // the sections must start on their boundaries, and fit in the file, in order, without overflowing on the way
+  if (header->pilots_offset % SNAPSHOT_ALIGNMENT || header->records_offset % SNAPSHOT_ALIGNMENT) return false;
+  if (header->pilots_offset < sizeof *header || header->pilots_offset > file_size) return false;
+  if (header->n_buckets > (file_size - header->pilots_offset) / sizeof(size_t)) return false;
+  if (header->records_offset < header->pilots_offset + header->n_buckets * sizeof(size_t)) return false;
+  if (header->records_offset > file_size) return false;
+  if (header->n_records > (file_size - header->records_offset) / header->record_size) return false;
+
+  return header->records_offset + header->n_records * header->record_size == file_size;
+}
+
+struct hash_table table_open_mapped(char const *path,
+                                    int (*cmpr)(void const *, void const *),
+                                    size_t (*hash)(void const *hashable, size_t size)) {
+  if (!path || !cmpr) goto empty_table;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) goto empty_table;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct snapshot_header)) {
+    close(fd);
+    goto empty_table;
+  }
+
+  // a private mapping lets values be modified in place without touching the file
+  size_t size = (size_t)st.st_size;
+  void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) goto empty_table;
+
+  struct snapshot_header header;
+  memcpy(&header, mapping, sizeof header);
+  if (!header_valid(&header, size)) goto unmap;
+  if (!(header.flags & SNAPSHOT_DEFAULT_HASH) != (hash != NULL)) goto unmap;
+
+  // a direct pilot must point into the records. any other pilot is reduced modulo the number of records
+  size_t *pilots = (size_t *)((char *)mapping + header.pilots_offset);
+  for (size_t b = 0; b < header.n_buckets; b++) {
+    size_t direct = ~(SIZE_MAX >> 1);
+    if (pilots[b] & direct && (pilots[b] & ~direct) >= header.n_records) goto unmap;
+  }
+
+  struct hash_table table = {._cmpr = cmpr,
+                             ._engine = TABLE_FROZEN,
+                             ._hash = hash,
+                             ._key_offset = 0,
+                             ._key_size = header.key_size,
+                             ._mapping = mapping,
+                             ._mapping_size = size,
+                             ._n_elem = header.n_records,
+                             ._seed = header.seed,
+                             ._value_offset = header.value_offset,
+                             ._value_size = header.value_size};
+
+  table._entries = (struct vec){._capacity = header.n_buckets,
+                                ._data = pilots,
+                                ._data_size = sizeof(size_t),
+                                ._n_elem = header.n_buckets};
+  table._records = (struct vec){._capacity = header.n_records,
+                                ._data = (char *)mapping + header.records_offset,
+                                ._data_size = header.record_size,
+                                ._n_elem = header.n_records};
+
+  // a hash function other than the one the table was saved with would place the keys elsewhere
+  if (header.n_records) {
+    void *first = vec_data(&table._records);
+    if (frozen_table_find(&table, hash_wrapper(&table, first), first) != first) goto unmap;
+  }
+  table_stats_reset(&table);  // the check above isn't a lookup of the caller's
+
+  return table;
+
+unmap:
+  munmap(mapping, size);
+empty_table:
+  return (struct hash_table){0};
+}
+
+void mapped_table_unmap(struct hash_table *table) {
+  if (!table || !table->_mapping) return;
+
+  munmap(table->_mapping, table->_mapping_size);
+  table->_mapping = NULL;
+  table->_mapping_size = 0;
+  table->_entries = (struct vec){0};
+  table->_records = (struct vec){0};
+}
@@ -0,0 +1,218 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+#include "vec.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPEN_TABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+/* swiss table style open addressing. each slot has a control byte. a full slot's control byte holds the low 7 bits of
+ * its hash (h2), the remaining bits (h1) pick the group the probe sequence starts at. groups of GROUP_WIDTH control
+ * bytes are matched at once */
+
+#define GROUP_WIDTH 16
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xfe
+
+static inline unsigned char h2(size_t hash) {
+  return (unsigned char)(hash & 0x7f);
+}
+
+static inline size_t h1(size_t hash) {
+  return hash >> 7;
+}
+
+#ifdef OPEN_TABLE_SSE2
+/* used internally to get a bitmask of all the control bytes in a group which equal `byte` */
+static inline uint32_t group_match(unsigned char const *group, unsigned char byte) {
+  __m128i ctrl = _mm_loadu_si128((__m128i const *)group);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+}
+
+/* used internally to get a bitmask of all the empty or deleted slots in a group (i.e. their msb is set) */
+static inline uint32_t group_match_available(unsigned char const *group) {
+  return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)group));
+}
+#else
+static inline uint32_t group_match(unsigned char const *group, unsigned char byte) {
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < GROUP_WIDTH; i++) { mask |= (uint32_t)(group[i] == byte) << i; }
+  return mask;
+}
+
+static inline uint32_t group_match_available(unsigned char const *group) {
+  uint32_t mask = 0;
+  for (unsigned i = 0; i < GROUP_WIDTH; i++) { mask |= (uint32_t)(group[i] >> 7) << i; }
+  return mask;
+}
+#endif
+
+/* used internally to get the index of the lowest set bit. the function assumes mask != 0 */
+static inline unsigned first_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctz(mask);
+#else
+  unsigned idx = 0;
+  for (; !(mask & 1); mask >>= 1) idx++;
+  return idx;
+#endif
+}
+
+static inline void *slot_at(struct hash_table *table, size_t pos) {
+  return (char *)table->_entries._data + pos * table->_entries._data_size;
+}
+
+/* used internally to find the first empty / deleted slot on the probe sequence of `hash`. the function assumes there's
+ * at least one such slot */
+static size_t find_available(unsigned char const *ctrl, size_t capacity, size_t hash) {
+  size_t groups_mask = capacity / GROUP_WIDTH - 1;
+  size_t group = h1(hash) & groups_mask;
+
+  // triangular probing visits every group exactly once when the number of groups is a power of 2
+  for (size_t step = 1;; step++) {
+    uint32_t available = group_match_available(ctrl + group * GROUP_WIDTH);
+    if (available) return group * GROUP_WIDTH + first_bit(available);
+
+    group = (group + step) & groups_mask;
+  }
+}
+
+bool open_table_init(struct hash_table *table, size_t capacity) {
+  if (!table) return false;
+  // the capacity must be a power of 2 which holds at least one group
+  if (capacity < GROUP_WIDTH) capacity = GROUP_WIDTH;
+  if (capacity & (capacity - 1)) return false;
+
+  unsigned char *ctrl = malloc(capacity);
+  if (!ctrl) return false;
+  memset(ctrl, CTRL_EMPTY, capacity);
+
+  struct vec slots = vec_create(table_pack_record(table, 0, 1), NULL);
+  if (!vec_data(&slots) || vec_resize(&slots, capacity) != capacity) {
+    free(ctrl);
+    vec_destroy(&slots);
+    return false;
+  }
+  slots._n_elem = capacity;
+
+  table->_ctrl = ctrl;
+  table->_entries = slots;
+  table->_n_deleted = 0;
+  return true;
+}
+
+void open_table_destroy(struct hash_table *table) {
+  if (!table) return;
+
+  free(table->_ctrl);
+  table->_ctrl = NULL;
+  vec_destroy(&table->_entries);
+}
+
+void *open_table_at(struct hash_table *table, size_t pos) {
+  if (!table || !table->_ctrl || pos >= table_capacity(table)) return NULL;
+
+  return table->_ctrl[pos] & CTRL_EMPTY ? NULL : slot_at(table, pos);
+}
+
+void *open_table_find(struct hash_table *table, size_t hash, void const *key) {
+  size_t groups = table_capacity(table) / GROUP_WIDTH;
+  size_t group = h1(hash) & (groups - 1);
+  unsigned char tag = h2(hash);
+
+  for (size_t step = 1; step <= groups; step++) {
+    unsigned char const *ctrl = table->_ctrl + group * GROUP_WIDTH;
+    TABLE_STATS_PROBE(table);
+
+    for (uint32_t match = group_match(ctrl, tag); match; match &= match - 1) {
+      void *slot = slot_at(table, group * GROUP_WIDTH + first_bit(match));
+      if (table->_cmpr(key, (char *)slot + table->_key_offset) == 0) return slot;
+    }
+
+    // a group with an empty slot terminates the probe sequence
+    if (group_match(ctrl, CTRL_EMPTY)) return NULL;
+
+    group = (group + step) & (groups - 1);
+  }
+
+  return NULL;
+}
+
+/* moves every full slot into a table of `new_capacity` slots. with new_capacity == capacity this simply purges the
+ * deleted slots. the caller must make sure `new_capacity` holds every full slot */
+bool open_table_resize(struct hash_table *table, size_t new_capacity) {
+  TABLE_STATS_CLOCK(start);
+  struct hash_table resized = *table;
+  if (!open_table_init(&resized, new_capacity)) return false;
+
+  size_t slot_size = table->_entries._data_size;
+  for (size_t pos = 0; pos < table_capacity(table); pos++) {
+    if (table->_ctrl[pos] & CTRL_EMPTY) continue;
+
+    void *slot = slot_at(table, pos);
+    size_t hash = hash_wrapper(table, (char *)slot + table->_key_offset);
+    size_t new_pos = find_available(resized._ctrl, new_capacity, hash);
+
+    resized._ctrl[new_pos] = h2(hash);
+    memcpy(slot_at(&resized, new_pos), slot, slot_size);
+  }
+
+  open_table_destroy(table);
+  table->_ctrl = resized._ctrl;
+  table->_entries = resized._entries;
+  table->_n_deleted = 0;
+  TABLE_STATS_RESIZED(table, start);
+  return true;
+}
+
+void *open_table_insert(struct hash_table *table, size_t hash) {
+  size_t capacity = table_capacity(table);
+
+  // the table grows once too many of its slots are either full or deleted
+  if (table->_n_elem + 1 > table_max_elements(table, capacity)) {
+    if ((SIZE_MAX >> 1) >> table->_growth < capacity) return NULL;
+    if (!open_table_resize(table, capacity << table->_growth)) return NULL;
+  } else if (table->_n_elem + table->_n_deleted + 1 > table_max_elements(table, capacity)) {
+    // mostly tombstones. rehashing in place is enough
+    if (!open_table_resize(table, capacity)) return NULL;
+  }
+
+  size_t pos = find_available(table->_ctrl, table_capacity(table), hash);
+  if (table->_ctrl[pos] == CTRL_DELETED) table->_n_deleted--;
+  table->_ctrl[pos] = h2(hash);
+
+  return slot_at(table, pos);
+}
+
+void open_table_erase(struct hash_table *table, void *slot) {
+  size_t pos = (size_t)((char *)slot - (char *)table->_entries._data) / table->_entries._data_size;
+
+  // a probe sequence never continues past a group which has an empty slot. if this group already has one - no key
+  // could have been placed beyond it on account of it, and the slot may become empty as well
+  if (group_match(table->_ctrl + (pos & ~(size_t)(GROUP_WIDTH - 1)), CTRL_EMPTY)) {
+    table->_ctrl[pos] = CTRL_EMPTY;
+  } else {
+    table->_ctrl[pos] = CTRL_DELETED;
+    table->_n_deleted++;
+  }
+}
+
+void open_table_prefetch(struct hash_table *table, size_t hash) {
+  size_t group = h1(hash) & (table_capacity(table) / GROUP_WIDTH - 1);
+
+  TABLE_PREFETCH(table->_ctrl + group * GROUP_WIDTH);
+  TABLE_PREFETCH(slot_at(table, group * GROUP_WIDTH));
+}
+
+size_t open_table_probe_length(struct hash_table *table, size_t pos) {
+  size_t groups_mask = table_capacity(table) / GROUP_WIDTH - 1;
+  size_t group = h1(hash_wrapper(table, (char *)slot_at(table, pos) + table->_key_offset)) & groups_mask;
+
+  size_t length = 1;
+  for (size_t step = 1; group != pos / GROUP_WIDTH; step++, length++) { group = (group + step) & groups_mask; }
+  return length;
+}
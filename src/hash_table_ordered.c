@@ -0,0 +1,245 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+#include "vec.h"
+
+/* insertion ordered storage, in the spirit of CPython's compact dict. the records are appended to
+ * hash_table::_records in the order their keys were inserted, and a sparse index (hash_table::_entries) maps hashes
+ * into them. the index is probed linearly, and its slots are as narrow as its capacity allows (1, 2, 4 or 8 bytes).
+ * a slot holds the index of its record + 1, 0 if it's empty, or the largest value it can hold (a 'dummy') if its record
+ * was removed.
+ *
+ * removing a record merely marks it as such, so the remaining records keep both their order and their place. the
+ * removed records (and their dummies) are compacted away once the records run out of room */
+
+struct ordered_node {
+  // the full hash of the key, less its top bit. the top bit is set once the record is removed
+  size_t hash;
+};
+
+#define ORDERED_REMOVED (~(SIZE_MAX >> 1))
+
+static inline struct ordered_node *record_at(struct hash_table *table, size_t idx) {
+  return (struct ordered_node *)((char *)table->_records._data + idx * table->_records._data_size);
+}
+
+/* used internally to get the width (in bytes) of the index slots of a table of `capacity` slots. the widest record
+ * index + 1 is below `capacity`, as the load factor is below 1 */
+static inline size_t slot_width(size_t capacity) {
+  if (capacity <= UINT8_MAX / 2 + 1) return sizeof(uint8_t);
+  if (capacity <= UINT16_MAX / 2 + 1) return sizeof(uint16_t);
+  if (capacity <= UINT32_MAX / 2 + 1) return sizeof(uint32_t);
+  return sizeof(size_t);
+}
+
+static inline size_t slot_dummy(struct hash_table *table) {
+  return SIZE_MAX >> (8 * (sizeof(size_t) - table->_entries._data_size));
+}
+
+static inline size_t slot_get(struct hash_table *table, size_t pos) {
+  void *slots = table->_entries._data;
+  switch (table->_entries._data_size) {
+    case sizeof(uint8_t):
+      return ((uint8_t *)slots)[pos];
+    case sizeof(uint16_t):
+      return ((uint16_t *)slots)[pos];
+    case sizeof(uint32_t):
+      return ((uint32_t *)slots)[pos];
+    default:
+      return ((size_t *)slots)[pos];
+  }
+}
+
+static inline void slot_set(struct hash_table *table, size_t pos, size_t value) {
+  void *slots = table->_entries._data;
+  switch (table->_entries._data_size) {
+    case sizeof(uint8_t):
+      ((uint8_t *)slots)[pos] = (uint8_t)value;
+      break;
+    case sizeof(uint16_t):
+      ((uint16_t *)slots)[pos] = (uint16_t)value;
+      break;
+    case sizeof(uint32_t):
+      ((uint32_t *)slots)[pos] = (uint32_t)value;
+      break;
+    default:
+      ((size_t *)slots)[pos] = value;
+      break;
+  }
+}
+
+/* used internally to find the first empty or dummy slot on the probe sequence of `hash`. the function assumes there's
+ * at least one such slot */
+static size_t find_available(struct hash_table *table, size_t hash) {
+  size_t mask = table_capacity(table) - 1;
+  size_t dummy = slot_dummy(table);
+
+  size_t pos = hash & mask;
+  for (size_t slot = slot_get(table, pos); slot && slot != dummy; slot = slot_get(table, pos)) {
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+/* used internally to allocate a zeroed index of `capacity` slots */
+static struct vec index_create(size_t capacity) {
+  struct vec slots = vec_create(slot_width(capacity), NULL);
+  if (!vec_data(&slots)) return slots;
+
+  if (vec_resize(&slots, capacity) != capacity) {
+    vec_destroy(&slots);
+    return (struct vec){0};
+  }
+
+  slots._n_elem = capacity;
+  return slots;
+}
+
+bool ordered_table_init(struct hash_table *table, size_t capacity) {
+  if (!table) return false;
+  if (capacity < TABLE_MIN_CAPACITY || capacity & (capacity - 1)) return false;
+
+  struct vec slots = index_create(capacity);
+  struct vec records = vec_create(table_pack_record(table, sizeof(struct ordered_node), sizeof(size_t)), NULL);
+  if (!vec_data(&slots) || !vec_data(&records)) goto failure;
+
+  size_t max_elements = table_max_elements(table, capacity);
+  if (vec_resize(&records, max_elements) < max_elements) goto failure;
+
+  table->_entries = slots;
+  table->_records = records;
+  return true;
+
+failure:
+  vec_destroy(&slots);
+  vec_destroy(&records);
+  return false;
+}
+
+void ordered_table_destroy(struct hash_table *table) {
+  if (!table) return;
+
+  vec_destroy(&table->_entries);
+  vec_destroy(&table->_records);
+}
+
+void *ordered_table_at(struct hash_table *table, size_t pos) {
+  if (!table || pos >= vec_size(&table->_records)) return NULL;
+
+  struct ordered_node *node = record_at(table, pos);
+  return node->hash & ORDERED_REMOVED ? NULL : node;
+}
+
+void *ordered_table_find(struct hash_table *table, size_t hash, void const *key) {
+  size_t mask = table_capacity(table) - 1;
+  size_t dummy = slot_dummy(table);
+
+  // a removed record has its top bit set, hence never matches
+  hash &= ~ORDERED_REMOVED;
+  for (size_t pos = hash & mask, slot; (slot = slot_get(table, pos)); pos = (pos + 1) & mask) {
+    TABLE_STATS_PROBE(table);
+    if (slot == dummy) continue;
+
+    struct ordered_node *node = record_at(table, slot - 1);
+    if (node->hash == hash && table->_cmpr(key, (char *)node + table->_key_offset) == 0) return node;
+  }
+
+  return NULL;
+}
+
+bool ordered_table_resize(struct hash_table *table, size_t capacity) {
+  TABLE_STATS_CLOCK(start);
+
+  // both allocations come first, so a failure leaves the table as is
+  struct vec slots = index_create(capacity);
+  if (!vec_data(&slots)) return false;
+
+  size_t max_elements = table_max_elements(table, capacity);
+  if (vec_capacity(&table->_records) < max_elements && vec_resize(&table->_records, max_elements) < max_elements) {
+    vec_destroy(&slots);
+    return false;
+  }
+
+  // compact the live records, in order
+  size_t live = 0;
+  for (size_t idx = 0; idx < vec_size(&table->_records); idx++) {
+    struct ordered_node *node = record_at(table, idx);
+    if (node->hash & ORDERED_REMOVED) continue;
+
+    if (live != idx) memcpy(record_at(table, live), node, table->_records._data_size);
+    live++;
+  }
+  table->_records._n_elem = live;
+
+  // return the excess records when shrinking. shrinking an empty vec would free it altogether
+  if (capacity < table_capacity(table) && live) vec_shrink(&table->_records);
+
+  vec_destroy(&table->_entries);
+  table->_entries = slots;
+  for (size_t idx = 0; idx < live; idx++) {
+    slot_set(table, find_available(table, record_at(table, idx)->hash), idx + 1);
+  }
+
+  TABLE_STATS_RESIZED(table, start);
+  return true;
+}
+
+void *ordered_table_insert(struct hash_table *table, size_t hash) {
+  // every record, removed or not, holds on to an index slot until the records are compacted
+  size_t capacity = table_capacity(table);
+  if (vec_size(&table->_records) + 1 > table_max_elements(table, capacity)) {
+    // compacting is enough if at least half of the records were removed. otherwise the table grows, which keeps
+    // compactions from following each other too closely
+    if (table->_n_elem + 1 > table_max_elements(table, capacity) / 2) {
+      if ((SIZE_MAX >> 1) >> table->_growth < capacity) return NULL;
+      capacity <<= table->_growth;
+    }
+
+    if (!ordered_table_resize(table, capacity)) return NULL;
+  }
+
+  // the records may have been shrunk below the max load
+  struct vec *records = &table->_records;
+  if (vec_size(records) == vec_capacity(records)) {
+    size_t needed = table_max_elements(table, table_capacity(table));
+    if (needed <= vec_size(records)) needed = vec_size(records) + 1;
+    if (vec_resize(records, needed) < needed) return NULL;
+  }
+
+  size_t idx = records->_n_elem++;
+  struct ordered_node *node = record_at(table, idx);
+  node->hash = hash & ~ORDERED_REMOVED;
+
+  slot_set(table, find_available(table, node->hash), idx + 1);
+  return node;
+}
+
+void ordered_table_erase(struct hash_table *table, void *record) {
+  struct ordered_node *removed = record;
+  size_t idx = (size_t)((char *)record - (char *)table->_records._data) / table->_records._data_size;
+
+  size_t mask = table_capacity(table) - 1;
+  size_t pos = removed->hash & mask;
+  while (slot_get(table, pos) != idx + 1) { pos = (pos + 1) & mask; }
+
+  // the slot must remain occupied, as it might be in the middle of another key's probe sequence
+  slot_set(table, pos, slot_dummy(table));
+  removed->hash |= ORDERED_REMOVED;
+}
+
+void ordered_table_prefetch(struct hash_table *table, size_t hash) {
+  size_t slot = slot_get(table, hash & (table_capacity(table) - 1));
+  if (slot && slot != slot_dummy(table)) TABLE_PREFETCH(record_at(table, slot - 1));
+}
+
+size_t ordered_table_probe_length(struct hash_table *table, size_t pos) {
+  size_t mask = table_capacity(table) - 1;
+
+  size_t length = 1;
+  for (size_t slot = record_at(table, pos)->hash & mask; slot_get(table, slot) != pos + 1; slot = (slot + 1) & mask) {
+    length++;
+  }
+  return length;
+}
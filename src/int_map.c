@@ -0,0 +1,273 @@
+#include "int_map.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INT_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#define INT_MAP_INIT_CAPACITY 32
+#define INT_MAP_SCAN 4                            // the number of keys compared at once
+#define INT_MAP_MULTIPLIER 0x9e3779b97f4a7c15ull  // 2^64 / phi
+
+/* used internally to get the number of keys a map of `capacity` slots may hold. linear probing degrades quickly past a
+ * load factor of 0.75 */
+static inline size_t max_elements(size_t capacity) {
+  return capacity - capacity / 4;
+}
+
+/* used internally to get the slot a key's probe sequence starts at. the top bits of the product are the well mixed
+ * ones */
+static inline size_t home_of(struct int_map const *map, uint64_t key) {
+  return (size_t)((key * INT_MAP_MULTIPLIER) >> map->_shift);
+}
+
+/* used internally to get the value of the slot `pos`. `NULL` if the values are empty (`_value_size == 0`) */
+static inline void *value_at(struct int_map const *map, size_t pos) {
+  return map->_value_size ? map->_values + pos * map->_value_size : NULL;
+}
+
+#ifdef INT_MAP_SSE2
+/* used internally to get a bitmask of the keys among `INT_MAP_SCAN` consecutive keys which equal `key` */
+static inline unsigned scan_match(uint64_t const *keys, uint64_t key) {
+  __m128i needle = _mm_set1_epi64x((long long)key);
+  __m128i low = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const *)keys), needle);
+  __m128i high = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const *)(keys + 2)), needle);
+
+  // SSE2 compares 32 bit lanes. a key matches if both of its halves do
+  low = _mm_and_si128(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+  high = _mm_and_si128(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (unsigned)_mm_movemask_pd(_mm_castsi128_pd(low)) | (unsigned)_mm_movemask_pd(_mm_castsi128_pd(high)) << 2;
+}
+#else
+static inline unsigned scan_match(uint64_t const *keys, uint64_t key) {
+  unsigned mask = 0;
+  for (unsigned i = 0; i < INT_MAP_SCAN; i++) { mask |= (unsigned)(keys[i] == key) << i; }
+  return mask;
+}
+#endif
+
+/* used internally to get the index of the lowest set bit. the function assumes mask != 0 */
+static inline unsigned first_bit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctz(mask);
+#else
+  unsigned idx = 0;
+  for (; !(mask & 1); mask >>= 1) idx++;
+  return idx;
+#endif
+}
+
+/* used internally to find the slot of `key`, or the empty slot ending its probe sequence if there's no such key (which
+ * is where the key belongs). the function assumes there's at least one empty slot */
+static inline size_t find_slot(struct int_map const *map, uint64_t key, bool *found) {
+  size_t mask = map->_capacity - 1;
+  size_t pos = home_of(map, key);
+
+  for (;;) {
+    // a scan can't wrap around the end of the keys. the last few slots are probed one by one
+    if (pos + INT_MAP_SCAN <= map->_capacity) {
+      unsigned hits = scan_match(map->_keys + pos, key);
+      unsigned empty = scan_match(map->_keys + pos, map->_empty_key);
+      if (hits | empty) {
+        unsigned idx = first_bit(hits | empty);
+        *found = hits >> idx & 1;
+        return pos + idx;
+      }
+      pos = (pos + INT_MAP_SCAN) & mask;
+    } else {
+      if (map->_keys[pos] == key || map->_keys[pos] == map->_empty_key) {
+        *found = map->_keys[pos] == key;
+        return pos;
+      }
+      pos = (pos + 1) & mask;
+    }
+  }
+}
+
+/* used internally to allocate the (empty) storage of `capacity` slots into `map` */
+static bool storage_create(struct int_map *map, size_t capacity) {
+  if (capacity > SIZE_MAX / sizeof(uint64_t)) return false;
+  if (map->_value_size && capacity > SIZE_MAX / map->_value_size) return false;
+
+  uint64_t *keys = malloc(capacity * sizeof *keys);
+  unsigned char *values = map->_value_size ? malloc(capacity * map->_value_size) : NULL;
+  if (!keys || (map->_value_size && !values)) {
+    free(keys);
+    free(values);
+    return false;
+  }
+
+  for (size_t pos = 0; pos < capacity; pos++) { keys[pos] = map->_empty_key; }
+
+  unsigned shift = 64;
+  for (size_t c = capacity; c > 1; c >>= 1) shift--;
+
+  map->_keys = keys;
+  map->_values = values;
+  map->_capacity = capacity;
+  map->_shift = shift;
+  return true;
+}
+
+/* used internally to move every key into a new storage of `capacity` slots */
+static bool resize_map(struct int_map *map, size_t capacity) {
+  struct int_map resized = *map;
+  if (!storage_create(&resized, capacity)) return false;
+
+  for (size_t pos = 0; pos < map->_capacity; pos++) {
+    if (map->_keys[pos] == map->_empty_key) continue;
+
+    bool found;
+    size_t new_pos = find_slot(&resized, map->_keys[pos], &found);
+    resized._keys[new_pos] = map->_keys[pos];
+    if (map->_value_size) memcpy(value_at(&resized, new_pos), value_at(map, pos), map->_value_size);
+  }
+
+  free(map->_keys);
+  free(map->_values);
+  *map = resized;
+  return true;
+}
+
+struct int_map int_map_create(size_t value_size, uint64_t empty_key) {
+  struct int_map map = {._empty_key = empty_key, ._value_size = value_size};
+  if (!storage_create(&map, INT_MAP_INIT_CAPACITY)) goto empty_map;
+
+  return map;
+
+empty_map:
+  return (struct int_map){0};
+}
+
+void int_map_destroy(struct int_map *map) {
+  if (!map || !map->_keys) return;
+
+  free(map->_keys);
+  free(map->_values);
+  *map = (struct int_map){0};
+}
+
+size_t int_map_size(struct int_map const *map) {
+  return map ? map->_n_elem : 0;
+}
+
+size_t int_map_capacity(struct int_map const *map) {
+  return map ? map->_capacity : 0;
+}
+
+size_t int_map_reserve(struct int_map *map, size_t count) {
+  if (!map || !map->_keys) return 0;
+
+  size_t capacity = map->_capacity;
+  while (max_elements(capacity) < count) {
+    if (capacity > SIZE_MAX / 2) return map->_capacity;
+    capacity <<= 1;
+  }
+
+  if (capacity > map->_capacity) resize_map(map, capacity);
+  return map->_capacity;
+}
+
+enum ds_error int_map_put(struct int_map *restrict map,
+                          uint64_t key,
+                          void const *restrict new_value,
+                          void *restrict old_value) {
+  if (!map || !map->_keys) return DS_ERROR;
+  if (key == map->_empty_key) return DS_ERROR;
+  if (!new_value && map->_value_size) return DS_ERROR;
+
+  bool found;
+  size_t pos = find_slot(map, key, &found);
+  if (found) {
+    enum ds_error ret = DS_OK;
+    if (old_value) {
+      if (map->_value_size) memcpy(old_value, value_at(map, pos), map->_value_size);
+      ret = DS_VALUE_OK;
+    }
+
+    if (map->_value_size) memcpy(value_at(map, pos), new_value, map->_value_size);
+    return ret;
+  }
+
+  if (map->_n_elem + 1 > max_elements(map->_capacity)) {
+    if (map->_capacity > SIZE_MAX / 2 || !resize_map(map, map->_capacity << 1)) return DS_NO_MEM;
+    pos = find_slot(map, key, &found);
+  }
+
+  map->_keys[pos] = key;
+  if (map->_value_size) memcpy(value_at(map, pos), new_value, map->_value_size);
+  map->_n_elem++;
+  return DS_OK;
+}
+
+enum ds_error int_map_get(struct int_map *restrict map, uint64_t key, void *restrict value) {
+  if (!map || !map->_keys) return DS_ERROR;
+  if (!value && map->_value_size) return DS_ERROR;
+  if (key == map->_empty_key) return DS_NOT_FOUND;
+
+  bool found;
+  size_t pos = find_slot(map, key, &found);
+  if (!found) return DS_NOT_FOUND;
+
+  if (map->_value_size) memcpy(value, value_at(map, pos), map->_value_size);
+  return DS_VALUE_OK;
+}
+
+void *int_map_get_ref(struct int_map *map, uint64_t key) {
+  if (!map || !map->_keys || key == map->_empty_key) return NULL;
+
+  bool found;
+  size_t pos = find_slot(map, key, &found);
+  return found ? value_at(map, pos) : NULL;
+}
+
+bool int_map_contains(struct int_map *map, uint64_t key) {
+  if (!map || !map->_keys || key == map->_empty_key) return false;
+
+  bool found;
+  find_slot(map, key, &found);
+  return found;
+}
+
+enum ds_error int_map_remove(struct int_map *restrict map, uint64_t key, void *restrict old_value) {
+  if (!map || !map->_keys) return DS_ERROR;
+  if (key == map->_empty_key) return DS_NOT_FOUND;
+
+  bool found;
+  size_t hole = find_slot(map, key, &found);
+  if (!found) return DS_NOT_FOUND;
+
+  enum ds_error ret = DS_OK;
+  if (old_value) {
+    if (map->_value_size) memcpy(old_value, value_at(map, hole), map->_value_size);
+    ret = DS_VALUE_OK;
+  }
+
+  // backward shift deletion: every following key of the cluster which may reside in the hole (i.e. its home isn't
+  // cyclically within (hole, pos]) is moved into it, leaving a new hole behind
+  size_t mask = map->_capacity - 1;
+  for (size_t pos = (hole + 1) & mask; map->_keys[pos] != map->_empty_key; pos = (pos + 1) & mask) {
+    size_t home = home_of(map, map->_keys[pos]);
+    if (((pos - home) & mask) < ((pos - hole) & mask)) continue;
+
+    map->_keys[hole] = map->_keys[pos];
+    if (map->_value_size) memcpy(value_at(map, hole), value_at(map, pos), map->_value_size);
+    hole = pos;
+  }
+
+  map->_keys[hole] = map->_empty_key;
+  map->_n_elem--;
+  return ret;
+}
+
+void int_map_for_each(struct int_map *map, void (*fn)(uint64_t key, void *value, void *context), void *context) {
+  if (!map || !map->_keys || !fn) return;
+
+  for (size_t pos = 0; pos < map->_capacity; pos++) {
+    if (map->_keys[pos] != map->_empty_key) fn(map->_keys[pos], value_at(map, pos), context);
+  }
+}
@@ -97,12 +97,13 @@ static intmax_t idx_vec_pop(struct l_vec *vec) {
 static bool nodes_vec_resize(struct l_vec *vec) {
   if (!vec || !vec->_data) return false;
 
+  size_t old_capacity = vec->_capacity;
   if (!l_vec_resize(vec)) return false;
 
   vec->_n_elem = vec->_capacity;
 
   // populate the new allocated space with 'empty' nodes
-  for (size_t i = vec->_n_elem; i < vec->_capacity; i++) {
+  for (size_t i = old_capacity; i < vec->_capacity; i++) {
     struct node *curr = l_vec_at(vec, i);
     if (curr) *curr = (struct node){.data = NULL, .next = -1, .prev = -1};
   }
@@ -202,34 +203,7 @@ static bool node_init(struct node *restrict node, void const *restrict data, siz
 }
 
 bool list_prepend(struct list *restrict list, void const *restrict data) {
-  if (!list) return false;
-  if (!data) return false;
-
-  if (l_vec_empty(&list->_free_idx)) {
-    if (!list_resize(list)) return false;
-  }
-
-  intmax_t idx = idx_vec_pop(&list->_free_idx);
-  if (idx < 0) return false;  // should never happen
-
-  struct node *node = l_vec_at(&list->_nodes, (size_t)idx);
-  if (!node_init(node, data, list->_data_size)) {
-    idx_vec_push(&list->_free_idx, idx);
-    return false;
-  }
-
-  node->next = list->_head_idx;
-
-  struct node *head = l_vec_at(&list->_nodes, (size_t)list->_head_idx);
-  if (head) {  // list has at least 1 element
-    head->prev = idx;
-  } else {  // list is empty
-    list->_tail_idx = idx;
-  }
-
-  list->_head_idx = idx;
-
-  return true;
+  return list_prepend_node(list, data) >= 0;
 }
 
 bool list_append(struct list *restrict list, void const *restrict data) {
@@ -360,7 +334,9 @@ void *list_remove_first(struct list *list) {
   list->_head_idx = head->next;
   head->next = -1;
 
-  return head->data;
+  void *data = head->data;
+  head->data = NULL;
+  return data;
 }
 
 void *list_remove_last(struct list *list) {
@@ -382,7 +358,9 @@ void *list_remove_last(struct list *list) {
   list->_tail_idx = tail->prev;
   tail->prev = -1;
 
-  return tail->data;
+  void *data = tail->data;
+  tail->data = NULL;
+  return data;
 }
 
 void *list_remove_at(struct list *list, size_t pos) {
@@ -422,7 +400,10 @@ void *list_remove_at(struct list *list, size_t pos) {
   curr->next = curr->prev = -1;
 
   if (curr_idx > 0) idx_vec_push(&list->_free_idx, curr_idx);
-  return curr->data;
+
+  void *data = curr->data;
+  curr->data = NULL;
+  return data;
 }
 
 void *list_replace_at(struct list *restrict list, void const *restrict data, size_t pos) {
@@ -480,3 +461,113 @@ void *list_iter_next(struct list *restrict list, void *restrict iter) {
   struct node *curr = iter;
   return l_vec_at(&list->_nodes, curr->next);
 }
+
+intmax_t list_prepend_node(struct list *restrict list, void const *restrict data) {
+  if (!list) return -1;
+  if (!data) return -1;
+
+  if (l_vec_empty(&list->_free_idx)) {
+    if (!list_resize(list)) return -1;
+  }
+
+  intmax_t idx = idx_vec_pop(&list->_free_idx);
+  if (idx < 0) return -1;  // should never happen
+
+  struct node *node = l_vec_at(&list->_nodes, (size_t)idx);
+  if (!node_init(node, data, list->_data_size)) {
+    idx_vec_push(&list->_free_idx, idx);
+    return -1;
+  }
+
+  node->next = list->_head_idx;
+
+  struct node *head = l_vec_at(&list->_nodes, (size_t)list->_head_idx);
+  if (head) {  // list has at least 1 element
+    head->prev = idx;
+  } else {  // list is empty
+    list->_tail_idx = idx;
+  }
+
+  list->_head_idx = idx;
+
+  return idx;
+}
+
+intmax_t list_first_node(struct list const *list) {
+  return list ? list->_head_idx : -1;
+}
+
+intmax_t list_last_node(struct list const *list) {
+  return list ? list->_tail_idx : -1;
+}
+
+/* used internally to get the node `idx` if it holds an element. `NULL` otherwise */
+static struct node *node_at(struct list const *list, intmax_t idx) {
+  if (!list || idx < 0) return NULL;
+
+  struct node *node = l_vec_at((struct l_vec *)&list->_nodes, (size_t)idx);
+  return node && node->data ? node : NULL;
+}
+
+intmax_t list_prev_node(struct list const *list, intmax_t node) {
+  struct node *curr = node_at(list, node);
+  return curr ? curr->prev : -1;
+}
+
+void *list_node_data(struct list const *list, intmax_t node) {
+  struct node *curr = node_at(list, node);
+  return curr ? curr->data : NULL;
+}
+
+/* used internally to detach a node from its neighbours (or from the list's head / tail) */
+static void node_unlink(struct list *list, struct node *node) {
+  struct node *before = l_vec_at(&list->_nodes, (size_t)node->prev);
+  struct node *after = l_vec_at(&list->_nodes, (size_t)node->next);
+
+  if (before) {
+    before->next = node->next;
+  } else {
+    list->_head_idx = node->next;
+  }
+
+  if (after) {
+    after->prev = node->prev;
+  } else {
+    list->_tail_idx = node->prev;
+  }
+
+  node->next = node->prev = -1;
+}
+
+bool list_move_first(struct list *list, intmax_t node) {
+  struct node *curr = node_at(list, node);
+  if (!curr) return false;
+  if (list->_head_idx == node) return true;
+
+  node_unlink(list, curr);
+
+  curr->next = list->_head_idx;
+  struct node *head = l_vec_at(&list->_nodes, (size_t)list->_head_idx);
+  if (head) {
+    head->prev = node;
+  } else {
+    list->_tail_idx = node;
+  }
+
+  list->_head_idx = node;
+  return true;
+}
+
+void *list_remove_node(struct list *list, intmax_t node) {
+  struct node *curr = node_at(list, node);
+  if (!curr) return NULL;
+
+  // 'return' the index to the list of free indices
+  if (!idx_vec_push(&list->_free_idx, node)) return NULL;
+
+  node_unlink(list, curr);
+
+  void *data = curr->data;
+  curr->data = NULL;
+  return data;
+}
@@ -0,0 +1,224 @@
+#include "lru_cache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+
+/* an entry, as held by the list. the key and the value follow it (at `_key_offset` and `_value_offset`) */
+struct cache_entry {
+  size_t weight;
+  bool referenced;  // CACHE_CLOCK only. set on every hit, cleared by eviction
+};
+
+static inline void *entry_key(struct lru_cache const *cache, struct cache_entry *entry) {
+  return (char *)entry + cache->_key_offset;
+}
+
+static inline void *entry_value(struct lru_cache const *cache, struct cache_entry *entry) {
+  return (char *)entry + cache->_value_offset;
+}
+
+/* used internally to mark the entry of `node` as the most recently used */
+static inline void touch(struct lru_cache *cache, intmax_t node, struct cache_entry *entry) {
+  if (cache->_options.policy == CACHE_CLOCK) {
+    entry->referenced = true;
+  } else {
+    list_move_first(&cache->_entries, node);
+  }
+}
+
+/* used internally to release an entry which was removed from both the table and the list. the value is either copied
+ * into `old_value` or destroyed */
+static enum ds_error release_entry(struct lru_cache *cache, struct cache_entry *entry, void *old_value) {
+  enum ds_error ret = DS_OK;
+  if (old_value) {
+    if (cache->_value_size) memcpy(old_value, entry_value(cache, entry), cache->_value_size);
+    ret = DS_VALUE_OK;
+  } else if (cache->_destroy_value) {
+    cache->_destroy_value(entry_value(cache, entry));
+  }
+
+  if (cache->_destroy_key) cache->_destroy_key(entry_key(cache, entry));
+
+  cache->_weight -= entry->weight;
+  free(entry);
+  return ret;
+}
+
+/* used internally to evict the least recently used entry other than the one of `keep` (the entry being put, which
+ * may be the least recently used one under CACHE_CLOCK). the function assumes the cache holds another entry */
+static void evict_one(struct lru_cache *cache, intmax_t keep) {
+  intmax_t node = list_last_node(&cache->_entries);
+  struct cache_entry *entry = list_node_data(&cache->_entries, node);
+
+  // every referenced entry gets a second chance. at worst the loop reaches the first entry it has cleared
+  while (node == keep || (cache->_options.policy == CACHE_CLOCK && entry->referenced)) {
+    entry->referenced = false;
+    list_move_first(&cache->_entries, node);
+
+    node = list_last_node(&cache->_entries);
+    entry = list_node_data(&cache->_entries, node);
+  }
+
+  if (cache->_options.on_evict) {
+    cache->_options.on_evict(entry_key(cache, entry), entry_value(cache, entry), cache->_options.context);
+  }
+
+  list_remove_node(&cache->_entries, node);
+  table_remove(&cache->_table, entry_key(cache, entry), NULL);
+  release_entry(cache, entry, NULL);
+}
+
+struct lru_cache lru_cache_create(size_t capacity,
+                                  size_t key_size,
+                                  size_t value_size,
+                                  int (*cmpr)(void const *, void const *),
+                                  size_t (*hash)(void const *hashable, size_t size),
+                                  void (*destroy_key)(void *),
+                                  void (*destroy_value)(void *),
+                                  struct cache_options const *options) {
+  if (!capacity) goto empty_cache;
+  if (!key_size) goto empty_cache;
+  if (!cmpr) goto empty_cache;
+
+  size_t key_offset = table_align(sizeof(struct cache_entry));
+  size_t value_offset = key_offset + table_align(key_size);
+  size_t entry_size = value_offset + value_size;
+
+  // the table holds the keys and the nodes of their entries. the entries own the keys
+  struct hash_table table = table_create(key_size, sizeof(intmax_t), cmpr, hash, NULL, NULL);
+  struct list entries = list_create(entry_size, NULL);
+  void *scratch = malloc(entry_size);
+  if (!vec_data(&table._entries) || !entries._nodes._data || !scratch) {
+    table_destroy(&table);
+    list_destroy(&entries);
+    free(scratch);
+    goto empty_cache;
+  }
+
+  return (struct lru_cache){._capacity = capacity,
+                            ._destroy_key = destroy_key,
+                            ._destroy_value = destroy_value,
+                            ._entries = entries,
+                            ._key_offset = key_offset,
+                            ._key_size = key_size,
+                            ._options = options ? *options : (struct cache_options){0},
+                            ._scratch = scratch,
+                            ._table = table,
+                            ._value_offset = value_offset,
+                            ._value_size = value_size};
+
+empty_cache:
+  return (struct lru_cache){0};
+}
+
+void lru_cache_destroy(struct lru_cache *cache) {
+  if (!cache || !cache->_scratch) return;
+
+  for (intmax_t node = list_last_node(&cache->_entries); node >= 0; node = list_last_node(&cache->_entries)) {
+    release_entry(cache, list_remove_node(&cache->_entries, node), NULL);
+  }
+
+  table_destroy(&cache->_table);
+  list_destroy(&cache->_entries);
+  free(cache->_scratch);
+  cache->_scratch = NULL;
+}
+
+size_t lru_cache_size(struct lru_cache const *cache) {
+  return cache && cache->_scratch ? table_size(&cache->_table) : 0;
+}
+
+size_t lru_cache_weight(struct lru_cache const *cache) {
+  return cache ? cache->_weight : 0;
+}
+
+enum ds_error lru_cache_put(struct lru_cache *restrict cache,
+                            void const *key,
+                            void const *new_value,
+                            void *restrict old_value) {
+  if (!cache || !cache->_scratch) return DS_ERROR;
+  if (!key || (!new_value && cache->_value_size)) return DS_ERROR;
+
+  size_t weight = cache->_options.weigh ? cache->_options.weigh(key, new_value) : 1;
+  if (weight > cache->_capacity) return DS_ERROR;
+
+  intmax_t node = -1;
+  if (table_get(&cache->_table, key, &node) == DS_VALUE_OK) {
+    struct cache_entry *entry = list_node_data(&cache->_entries, node);
+
+    enum ds_error ret = DS_OK;
+    if (old_value) {
+      if (cache->_value_size) memcpy(old_value, entry_value(cache, entry), cache->_value_size);
+      ret = DS_VALUE_OK;
+    } else if (cache->_destroy_value) {
+      cache->_destroy_value(entry_value(cache, entry));
+    }
+    if (cache->_value_size) memcpy(entry_value(cache, entry), new_value, cache->_value_size);
+
+    cache->_weight = cache->_weight - entry->weight + weight;
+    entry->weight = weight;
+    touch(cache, node, entry);
+
+    // a heavier value may push other entries out, never the entry itself (its weight is within the capacity)
+    while (cache->_weight > cache->_capacity) evict_one(cache, node);
+    return ret;
+  }
+
+  // the entry is inserted before any other is evicted for it, hence a failed insertion leaves the cache as is
+  struct cache_entry *entry = cache->_scratch;
+  *entry = (struct cache_entry){.weight = weight};
+  memcpy(entry_key(cache, entry), key, cache->_key_size);
+  if (cache->_value_size) memcpy(entry_value(cache, entry), new_value, cache->_value_size);
+
+  node = list_prepend_node(&cache->_entries, entry);
+  if (node < 0) return DS_NO_MEM;
+
+  enum ds_error ret = table_put(&cache->_table, key, &node, NULL);
+  if (ret != DS_OK) {
+    free(list_remove_node(&cache->_entries, node));
+    return ret;
+  }
+
+  cache->_weight += weight;
+  if (cache->_weight > cache->_capacity) {
+    while (cache->_weight > cache->_capacity) evict_one(cache, node);
+
+    // the eviction may have moved second chance entries ahead of the new one
+    list_move_first(&cache->_entries, node);
+  }
+  return DS_OK;
+}
+
+enum ds_error lru_cache_get(struct lru_cache *restrict cache, void const *restrict key, void *restrict value) {
+  if (!cache || !cache->_scratch) return DS_ERROR;
+  if (!key || (!value && cache->_value_size)) return DS_ERROR;
+
+  intmax_t node = -1;
+  if (table_get(&cache->_table, key, &node) != DS_VALUE_OK) return DS_NOT_FOUND;
+
+  struct cache_entry *entry = list_node_data(&cache->_entries, node);
+  if (cache->_value_size) memcpy(value, entry_value(cache, entry), cache->_value_size);
+
+  touch(cache, node, entry);
+  return DS_VALUE_OK;
+}
+
+bool lru_cache_contains(struct lru_cache *restrict cache, void const *restrict key) {
+  if (!cache || !cache->_scratch) return false;
+  if (!key) return false;
+
+  return table_contains(&cache->_table, key);
+}
+
+enum ds_error lru_cache_remove(struct lru_cache *restrict cache, void const *restrict key, void *restrict old_value) {
+  if (!cache || !cache->_scratch) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  intmax_t node = -1;
+  if (table_remove(&cache->_table, key, &node) != DS_VALUE_OK) return DS_NOT_FOUND;
+
+  return release_entry(cache, list_remove_node(&cache->_entries, node), old_value);
+}
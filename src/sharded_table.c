@@ -0,0 +1,315 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "sharded_table.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hash_table_internal.h"
+
+#define SHARDED_MAX_SHARDS 1024
+#define CACHE_LINE 64
+
+struct sharded_shard {
+  pthread_mutex_t lock;
+  struct hash_table table;
+};
+
+/* shards are padded to whole cache lines, so that shards locked by different threads don't share a line */
+struct sharded_table_shard {
+  union {
+    struct sharded_shard shard;
+    char pad[CACHE_LINE * ((sizeof(struct sharded_shard) + CACHE_LINE - 1) / CACHE_LINE)];
+  } u;
+};
+
+/* used internally to hash a key the way every shard does */
+static inline size_t sharded_hash(struct sharded_table const *table, void const *key) {
+  struct hash_table const hasher = {._hash = table->_hash, ._key_size = table->_key_size, ._seed = table->_seed};
+  return hash_wrapper(&hasher, key);
+}
+
+/* used internally to get the index of the shard of `hash`, picked by its top bits. the shards' tables use the low
+ * ones */
+static inline size_t shard_index(struct sharded_table const *table, size_t hash) {
+  return table->_shard_bits ? hash >> (sizeof(size_t) * 8 - table->_shard_bits) : 0;
+}
+
+static inline struct sharded_shard *shard_of(struct sharded_table *table, size_t hash) {
+  return &table->_shards[shard_index(table, hash)].u.shard;
+}
+
+/* used internally to pick the default number of shards */
+static size_t default_shards(void) {
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+  size_t n_shards = 1;
+  while (processors > 0 && n_shards < (size_t)processors && n_shards < SHARDED_MAX_SHARDS) n_shards <<= 1;
+  return n_shards;
+}
+
+struct sharded_table sharded_table_create(size_t n_shards,
+                                          size_t key_size,
+                                          size_t value_size,
+                                          int (*cmpr)(void const *, void const *),
+                                          size_t (*hash)(void const *hashable, size_t size),
+                                          void (*destroy_key)(void *),
+                                          void (*destroy_value)(void *),
+                                          struct table_options const *options) {
+  if (!key_size) goto empty_table;
+  if (!cmpr) goto empty_table;
+
+  if (!n_shards) n_shards = default_shards();
+  if (n_shards > SHARDED_MAX_SHARDS || n_shards & (n_shards - 1)) goto empty_table;
+
+  // the shards must hash keys identically, as a key is hashed once for both picking its shard and the lookup itself
+  struct table_options opts = options ? *options : (struct table_options){0};
+  if (!opts.seed) opts.seed = table_random_seed();
+
+  struct sharded_table_shard *shards = NULL;
+  if (posix_memalign((void **)&shards, CACHE_LINE, n_shards * sizeof *shards) != 0) goto empty_table;
+
+  for (size_t i = 0; i < n_shards; i++) {
+    struct sharded_shard *shard = &shards[i].u.shard;
+    shard->table = table_create_ex(key_size, value_size, cmpr, hash, destroy_key, destroy_value, &opts);
+    if (!vec_data(&shard->table._entries)) {
+      for (size_t j = 0; j < i; j++) {
+        table_destroy(&shards[j].u.shard.table);
+        pthread_mutex_destroy(&shards[j].u.shard.lock);
+      }
+      free(shards);
+      goto empty_table;
+    }
+
+    pthread_mutex_init(&shard->lock, NULL);
+  }
+
+  size_t shard_bits = 0;
+  while ((size_t)1 << shard_bits < n_shards) shard_bits++;
+
+  return (struct sharded_table){._hash = hash,
+                                ._key_size = key_size,
+                                ._n_shards = n_shards,
+                                ._seed = opts.seed,
+                                ._shard_bits = shard_bits,
+                                ._shards = shards,
+                                ._value_size = value_size};
+
+empty_table:
+  return (struct sharded_table){0};
+}
+
+void sharded_table_destroy(struct sharded_table *table) {
+  if (!table || !table->_shards) return;
+
+  for (size_t i = 0; i < table->_n_shards; i++) {
+    table_destroy(&table->_shards[i].u.shard.table);
+    pthread_mutex_destroy(&table->_shards[i].u.shard.lock);
+  }
+
+  free(table->_shards);
+  table->_shards = NULL;
+}
+
+size_t sharded_table_size(struct sharded_table const *table) {
+  if (!table || !table->_shards) return 0;
+
+  size_t n_elem = 0;
+  for (size_t i = 0; i < table->_n_shards; i++) {
+    struct sharded_shard *shard = &table->_shards[i].u.shard;
+
+    pthread_mutex_lock(&shard->lock);
+    n_elem += table_size(&shard->table);
+    pthread_mutex_unlock(&shard->lock);
+  }
+
+  return n_elem;
+}
+
+enum ds_error sharded_table_put(struct sharded_table *restrict table,
+                                void const *key,
+                                void const *new_value,
+                                void *restrict old_value) {
+  if (!table || !table->_shards) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  size_t hash = sharded_hash(table, key);
+  struct sharded_shard *shard = shard_of(table, hash);
+
+  pthread_mutex_lock(&shard->lock);
+  enum ds_error ret = table_put_hashed(&shard->table, hash, key, new_value, old_value);
+  pthread_mutex_unlock(&shard->lock);
+  return ret;
+}
+
+enum ds_error sharded_table_remove(struct sharded_table *restrict table,
+                                   void const *restrict key,
+                                   void *restrict old_value) {
+  if (!table || !table->_shards) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  size_t hash = sharded_hash(table, key);
+  struct sharded_shard *shard = shard_of(table, hash);
+
+  pthread_mutex_lock(&shard->lock);
+  enum ds_error ret = table_remove_hashed(&shard->table, hash, key, old_value);
+  pthread_mutex_unlock(&shard->lock);
+  return ret;
+}
+
+enum ds_error sharded_table_get(struct sharded_table *restrict table, void const *restrict key, void *restrict value) {
+  if (!table || !table->_shards) return DS_ERROR;
+  if (!key || !value) return DS_ERROR;
+
+  size_t hash = sharded_hash(table, key);
+  struct sharded_shard *shard = shard_of(table, hash);
+
+  pthread_mutex_lock(&shard->lock);
+  enum ds_error ret = table_get_hashed(&shard->table, hash, key, value);
+  pthread_mutex_unlock(&shard->lock);
+  return ret;
+}
+
+bool sharded_table_contains(struct sharded_table *restrict table, void const *restrict key) {
+  if (!table || !table->_shards) return false;
+  if (!key) return false;
+
+  size_t hash = sharded_hash(table, key);
+  struct sharded_shard *shard = shard_of(table, hash);
+
+  pthread_mutex_lock(&shard->lock);
+  bool found = table_contains_hashed(&shard->table, hash, key);
+  pthread_mutex_unlock(&shard->lock);
+  return found;
+}
+
+/* used internally to put the key `idx` of a batch into `shard`. the shard must be locked */
+static enum ds_error put_one(struct sharded_table *table,
+                             struct sharded_shard *shard,
+                             size_t hash,
+                             char const *keys,
+                             char const *values,
+                             size_t idx) {
+  size_t prev_size = table_size(&shard->table);
+  void const *value = values ? values + idx * table->_value_size : NULL;
+
+  enum ds_error ret = table_put_hashed(&shard->table, hash, keys + idx * table->_key_size, value, NULL);
+  if (ret == DS_OK && table_size(&shard->table) == prev_size) ret = DS_VALUE_OK;  // an existing value was replaced
+  return ret;
+}
+
+size_t sharded_table_put_many(struct sharded_table *restrict table,
+                              void const *restrict keys,
+                              void const *restrict values,
+                              size_t count,
+                              enum ds_error *restrict status) {
+  if (!table || !table->_shards) return 0;
+  if (!keys || (!values && table->_value_size)) return 0;
+
+  char const *_keys = keys;
+  size_t inserted = 0;
+
+  // the keys sorted by their shard (a counting sort). without the memory to sort them, the keys are put one by one
+  size_t *hashes = malloc((count ? count : 1) * sizeof *hashes);
+  size_t *order = malloc((count ? count : 1) * sizeof *order);
+  size_t *shard_start = calloc(table->_n_shards + 1, sizeof *shard_start);
+  if (!hashes || !order || !shard_start) {
+    for (size_t i = 0; i < count; i++) {
+      size_t hash = sharded_hash(table, _keys + i * table->_key_size);
+      struct sharded_shard *shard = shard_of(table, hash);
+
+      pthread_mutex_lock(&shard->lock);
+      enum ds_error ret = put_one(table, shard, hash, keys, values, i);
+      pthread_mutex_unlock(&shard->lock);
+
+      if (ret == DS_OK) inserted++;
+      if (status) status[i] = ret;
+    }
+    goto cleanup;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    hashes[i] = sharded_hash(table, _keys + i * table->_key_size);
+    shard_start[shard_index(table, hashes[i]) + 1]++;
+  }
+
+  for (size_t s = 0; s < table->_n_shards; s++) { shard_start[s + 1] += shard_start[s]; }
+
+  // shard_start[s] is used as the insertion cursor of the shard `s`, and is restored right after
+  for (size_t i = 0; i < count; i++) { order[shard_start[shard_index(table, hashes[i])]++] = i; }
+  for (size_t s = table->_n_shards; s > 0; s--) { shard_start[s] = shard_start[s - 1]; }
+  shard_start[0] = 0;
+
+  for (size_t s = 0; s < table->_n_shards; s++) {
+    if (shard_start[s] == shard_start[s + 1]) continue;
+
+    struct sharded_shard *shard = &table->_shards[s].u.shard;
+    pthread_mutex_lock(&shard->lock);
+
+    // the shard's table is grown once for the whole batch
+    size_t batch = shard_start[s + 1] - shard_start[s];
+    table_reserve(&shard->table, table_size(&shard->table) + batch);
+
+    for (size_t k = shard_start[s]; k < shard_start[s + 1]; k++) {
+      size_t i = order[k];
+      enum ds_error ret = put_one(table, shard, hashes[i], keys, values, i);
+
+      if (ret == DS_OK) inserted++;
+      if (status) status[i] = ret;
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+  }
+
+cleanup:
+  free(hashes);
+  free(order);
+  free(shard_start);
+  return inserted;
+}
+
+/* the work of a single for_each thread */
+struct shard_visit {
+  struct sharded_shard *shard;
+  void (*fn)(void const *key, void *value, void *context);
+  void *context;
+};
+
+static void *visit_shard(void *arg) {
+  struct shard_visit *visit = arg;
+
+  pthread_mutex_lock(&visit->shard->lock);
+  table_for_each(&visit->shard->table, visit->fn, visit->context);
+  pthread_mutex_unlock(&visit->shard->lock);
+  return NULL;
+}
+
+enum ds_error sharded_table_for_each(struct sharded_table *table,
+                                     void (*fn)(void const *key, void *value, void *context),
+                                     void *context) {
+  if (!table || !table->_shards) return DS_ERROR;
+  if (!fn) return DS_ERROR;
+
+  struct shard_visit visits[SHARDED_MAX_SHARDS];
+  pthread_t threads[SHARDED_MAX_SHARDS];
+  bool started[SHARDED_MAX_SHARDS];
+
+  // the calling thread visits the first shard itself
+  for (size_t s = 0; s < table->_n_shards; s++) {
+    visits[s] = (struct shard_visit){.context = context, .fn = fn, .shard = &table->_shards[s].u.shard};
+    started[s] = s && pthread_create(&threads[s], NULL, visit_shard, &visits[s]) == 0;
+  }
+
+  for (size_t s = 0; s < table->_n_shards; s++) {
+    if (!started[s]) visit_shard(&visits[s]);
+  }
+
+  for (size_t s = 0; s < table->_n_shards; s++) {
+    if (started[s]) pthread_join(threads[s], NULL);
+  }
+
+  return DS_OK;
+}
@@ -0,0 +1,228 @@
+#include "sketch.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_internal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SKETCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#define HYPERLOGLOG_DEFAULT_PRECISION 14
+
+/* used internally to count the leading zero bits of `word`. the function assumes word != 0 */
+static inline unsigned leading_zeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_clzll(word);
+#else
+  unsigned count = 0;
+  for (; !(word & (1ull << 63)); word <<= 1) count++;
+  return count;
+#endif
+}
+
+struct hyperloglog hyperloglog_create(unsigned precision, uint64_t seed) {
+  if (!precision) precision = HYPERLOGLOG_DEFAULT_PRECISION;
+  if (precision < HYPERLOGLOG_MIN_PRECISION || precision > HYPERLOGLOG_MAX_PRECISION) goto empty_sketch;
+
+  uint8_t *registers = calloc((size_t)1 << precision, sizeof *registers);
+  if (!registers) goto empty_sketch;
+
+  return (struct hyperloglog){._precision = precision, ._registers = registers, ._seed = seed};
+
+empty_sketch:
+  return (struct hyperloglog){0};
+}
+
+void hyperloglog_destroy(struct hyperloglog *hll) {
+  if (!hll) return;
+
+  free(hll->_registers);
+  *hll = (struct hyperloglog){0};
+}
+
+enum ds_error hyperloglog_add(struct hyperloglog *restrict hll, void const *restrict key, size_t key_size) {
+  if (!hll || !hll->_registers) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  return hyperloglog_add_hashed(hll, default_hash(key, key_size, hll->_seed));
+}
+
+enum ds_error hyperloglog_add_hashed(struct hyperloglog *hll, uint64_t hash) {
+  if (!hll || !hll->_registers) return DS_ERROR;
+
+  // the top bits pick the register, the rank is the position of the first set bit among the rest
+  unsigned precision = hll->_precision;
+  uint64_t rest = hash << precision;
+  uint8_t rank = (uint8_t)(rest ? leading_zeros(rest) + 1 : 64 - precision + 1);
+
+  uint8_t *reg = &hll->_registers[hash >> (64 - precision)];
+  if (*reg < rank) *reg = rank;
+  return DS_OK;
+}
+
+double hyperloglog_estimate(struct hyperloglog const *hll) {
+  if (!hll || !hll->_registers) return 0;
+
+  size_t n_registers = (size_t)1 << hll->_precision;
+  double m = (double)n_registers;
+
+  double sum = 0;
+  size_t zeros = 0;
+  for (size_t i = 0; i < n_registers; i++) {
+    sum += ldexp(1.0, -(int)hll->_registers[i]);
+    zeros += hll->_registers[i] == 0;
+  }
+
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  if (n_registers == 16) alpha = 0.673;
+  if (n_registers == 32) alpha = 0.697;
+  if (n_registers == 64) alpha = 0.709;
+
+  // small cardinalities leave registers empty, and are estimated better by linear counting. a 64 bit hash needs no
+  // large range correction
+  double estimate = alpha * m * m / sum;
+  if (estimate <= 2.5 * m && zeros) estimate = m * log(m / (double)zeros);
+  return estimate;
+}
+
+enum ds_error hyperloglog_merge(struct hyperloglog *restrict dst, struct hyperloglog const *restrict src) {
+  if (!dst || !dst->_registers) return DS_ERROR;
+  if (!src || !src->_registers) return DS_ERROR;
+  if (dst->_precision != src->_precision || dst->_seed != src->_seed) return DS_ERROR;
+
+  // the merged register is the maximum of both. there are at least `16` registers, always a multiple of `16`
+  size_t n_registers = (size_t)1 << dst->_precision;
+#ifdef SKETCH_SSE2
+  for (size_t i = 0; i < n_registers; i += 16) {
+    __m128i merged = _mm_max_epu8(_mm_loadu_si128((__m128i const *)(dst->_registers + i)),
+                                  _mm_loadu_si128((__m128i const *)(src->_registers + i)));
+    _mm_storeu_si128((__m128i *)(dst->_registers + i), merged);
+  }
+#else
+  for (size_t i = 0; i < n_registers; i++) {
+    if (dst->_registers[i] < src->_registers[i]) dst->_registers[i] = src->_registers[i];
+  }
+#endif
+
+  return DS_OK;
+}
+
+void hyperloglog_clear(struct hyperloglog *hll) {
+  if (!hll || !hll->_registers) return;
+
+  memset(hll->_registers, 0, (size_t)1 << hll->_precision);
+}
+
+struct count_min count_min_create(size_t width, size_t depth, uint64_t seed) {
+  if (!width || !depth) goto empty_sketch;
+
+  size_t power = 1;
+  while (power < width) {
+    if (power > SIZE_MAX / 2) goto empty_sketch;
+    power <<= 1;
+  }
+  if (power > SIZE_MAX / depth) goto empty_sketch;
+
+  uint64_t *counters = calloc(power * depth, sizeof *counters);
+  if (!counters) goto empty_sketch;
+
+  return (struct count_min){._counters = counters, ._depth = depth, ._seed = seed, ._width = power};
+
+empty_sketch:
+  return (struct count_min){0};
+}
+
+void count_min_destroy(struct count_min *sketch) {
+  if (!sketch) return;
+
+  free(sketch->_counters);
+  *sketch = (struct count_min){0};
+}
+
+/* used internally to get the step between the counters a hash maps to in consecutive rows. the rows are indexed by
+ * `hash + row * step` (double hashing), which spares hashing the key once per row. the step is odd, hence the indices
+ * of a hash never repeat within `width` rows */
+static inline uint64_t row_step(uint64_t hash) {
+  return wy_mix(hash ^ WY_P2, WY_P3) | 1;
+}
+
+enum ds_error count_min_add(struct count_min *restrict sketch,
+                            void const *restrict key,
+                            size_t key_size,
+                            uint64_t count) {
+  if (!sketch || !sketch->_counters) return DS_ERROR;
+  if (!key) return DS_ERROR;
+
+  return count_min_add_hashed(sketch, default_hash(key, key_size, sketch->_seed), count);
+}
+
+enum ds_error count_min_add_hashed(struct count_min *sketch, uint64_t hash, uint64_t count) {
+  if (!sketch || !sketch->_counters) return DS_ERROR;
+
+  uint64_t step = row_step(hash);
+  size_t mask = sketch->_width - 1;
+  for (size_t row = 0; row < sketch->_depth; row++, hash += step) {
+    sketch->_counters[row * sketch->_width + ((size_t)hash & mask)] += count;
+  }
+
+  sketch->_total += count;
+  return DS_OK;
+}
+
+uint64_t count_min_estimate(struct count_min const *restrict sketch, void const *restrict key, size_t key_size) {
+  if (!sketch || !sketch->_counters) return 0;
+  if (!key) return 0;
+
+  return count_min_estimate_hashed(sketch, default_hash(key, key_size, sketch->_seed));
+}
+
+uint64_t count_min_estimate_hashed(struct count_min const *sketch, uint64_t hash) {
+  if (!sketch || !sketch->_counters) return 0;
+
+  // every counter of the key holds its count, plus the counts of whichever keys collide with it
+  uint64_t step = row_step(hash);
+  size_t mask = sketch->_width - 1;
+  uint64_t estimate = UINT64_MAX;
+  for (size_t row = 0; row < sketch->_depth; row++, hash += step) {
+    uint64_t counter = sketch->_counters[row * sketch->_width + ((size_t)hash & mask)];
+    if (counter < estimate) estimate = counter;
+  }
+
+  return estimate;
+}
+
+uint64_t count_min_total(struct count_min const *sketch) {
+  return sketch ? sketch->_total : 0;
+}
+
+enum ds_error count_min_merge(struct count_min *restrict dst, struct count_min const *restrict src) {
+  if (!dst || !dst->_counters) return DS_ERROR;
+  if (!src || !src->_counters) return DS_ERROR;
+  if (dst->_width != src->_width || dst->_depth != src->_depth || dst->_seed != src->_seed) return DS_ERROR;
+
+  size_t n_counters = dst->_width * dst->_depth;
+  size_t i = 0;
+#ifdef SKETCH_SSE2
+  for (; i + 2 <= n_counters; i += 2) {
+    __m128i merged = _mm_add_epi64(_mm_loadu_si128((__m128i const *)(dst->_counters + i)),
+                                   _mm_loadu_si128((__m128i const *)(src->_counters + i)));
+    _mm_storeu_si128((__m128i *)(dst->_counters + i), merged);
+  }
+#endif
+  for (; i < n_counters; i++) { dst->_counters[i] += src->_counters[i]; }
+
+  dst->_total += src->_total;
+  return DS_OK;
+}
+
+void count_min_clear(struct count_min *sketch) {
+  if (!sketch || !sketch->_counters) return;
+
+  memset(sketch->_counters, 0, sketch->_width * sketch->_depth * sizeof *sketch->_counters);
+  sketch->_total = 0;
+}
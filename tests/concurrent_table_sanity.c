@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "concurrent_table.h"
+
+#define THREADS 8
+#define KEYS_PER_THREAD 4096
+#define ROUNDS 3
+#define TOTAL_KEYS (THREADS * KEYS_PER_THREAD)
+
+static int cmpr(void const *left, void const *right) {
+  size_t const *l = left;
+  size_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+// the number of times each key was destroyed. keys are destroyed from whichever thread reclaims them
+static unsigned destroyed[TOTAL_KEYS];
+
+static void destroy_key(void *key) {
+  size_t const *k = key;
+  __atomic_fetch_add(&destroyed[*k], 1, __ATOMIC_RELAXED);
+}
+
+static void concurrent_table_sequential_test(void) {
+  struct concurrent_table table = concurrent_table_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL);
+  assert(concurrent_table_size(&table) == 0);
+
+  for (size_t i = 0; i < 1000; i++) { assert(concurrent_table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(concurrent_table_size(&table) == 1000);
+
+  size_t key = 10;
+  size_t value = 20;
+  size_t old = 0;
+  assert(concurrent_table_put(&table, &key, &value, &old) == DS_VALUE_OK);
+  assert(old == 10);
+
+  assert(concurrent_table_get(&table, &key, &old) == DS_VALUE_OK);
+  assert(old == 20);
+
+  assert(concurrent_table_remove(&table, &key, &old) == DS_VALUE_OK);
+  assert(old == 20);
+  assert(!concurrent_table_contains(&table, &key));
+  assert(concurrent_table_remove(&table, &key, NULL) == DS_NOT_FOUND);
+  assert(concurrent_table_size(&table) == 999);
+
+  for (size_t i = 0; i < 1000; i++) { assert(concurrent_table_contains(&table, &i) == (i != 10)); }
+
+  concurrent_table_destroy(&table);
+}
+
+struct worker_args {
+  struct concurrent_table *table;
+  size_t id;
+};
+
+/* every thread writes only its own range of keys, and reads everyone's. a key maps either to key * 2 or key * 3 */
+static void *worker(void *arg) {
+  struct worker_args *args = arg;
+  size_t begin = args->id * KEYS_PER_THREAD;
+  size_t end = begin + KEYS_PER_THREAD;
+
+  for (size_t round = 0; round < ROUNDS; round++) {
+    for (size_t key = begin; key < end; key++) {
+      size_t value = key * 2;
+      size_t old = 0;
+      enum ds_error ret = concurrent_table_put(args->table, &key, &value, round == 0 ? NULL : &old);
+      assert(ret == (round == 0 ? DS_OK : DS_VALUE_OK));
+      assert(round == 0 || old == key * 2 || old == key * 3);
+
+      size_t other = (key * 7919) % TOTAL_KEYS;
+      size_t found = 0;
+      if (concurrent_table_get(args->table, &other, &found) == DS_VALUE_OK) {
+        assert(found == other * 2 || found == other * 3);
+      }
+    }
+
+    for (size_t key = begin; key < end; key += 2) {
+      size_t value = key * 3;
+      size_t old = 0;
+      assert(concurrent_table_put(args->table, &key, &value, &old) == DS_VALUE_OK);
+      assert(old == key * 2);
+    }
+
+    // the last round leaves every key which isn't a multiple of 4 in the table
+    if (round + 1 == ROUNDS) {
+      for (size_t key = begin; key < end; key += 4) { assert(concurrent_table_remove(args->table, &key, NULL) == DS_OK); }
+    }
+  }
+
+  return NULL;
+}
+
+static void concurrent_table_stress_test(void) {
+  struct concurrent_table table =
+      concurrent_table_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, destroy_key, NULL);
+
+  pthread_t threads[THREADS];
+  struct worker_args args[THREADS];
+  for (size_t i = 0; i < THREADS; i++) {
+    args[i] = (struct worker_args){.table = &table, .id = i};
+    assert(pthread_create(&threads[i], NULL, worker, &args[i]) == 0);
+  }
+
+  for (size_t i = 0; i < THREADS; i++) { pthread_join(threads[i], NULL); }
+
+  assert(concurrent_table_size(&table) == TOTAL_KEYS - TOTAL_KEYS / 4);
+  for (size_t key = 0; key < TOTAL_KEYS; key++) {
+    size_t value = 0;
+    enum ds_error ret = concurrent_table_get(&table, &key, &value);
+    if (key % 4 == 0) {
+      assert(ret == DS_NOT_FOUND);
+    } else {
+      assert(ret == DS_VALUE_OK);
+      assert(value == (key % 2 ? key * 2 : key * 3));
+    }
+  }
+
+  concurrent_table_destroy(&table);
+
+  // replaced values keep their key, so each key must have been destroyed exactly once
+  for (size_t key = 0; key < TOTAL_KEYS; key++) { assert(destroyed[key] == 1); }
+}
+
+int main(void) {
+  concurrent_table_sequential_test();
+  concurrent_table_stress_test();
+}
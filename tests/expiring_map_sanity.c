@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "expiring_map.h"
+
+#define RANDOM_KEYS 4096
+
+static int cmpr(void const *left, void const *right) {
+  size_t const *l = left;
+  size_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+static void count_expired(void const *key, void *value, void *context) {
+  size_t const *k = key;
+  size_t *v = value;
+  assert(*v == *k * 2);
+
+  (*(size_t *)context)++;
+}
+
+static void expiring_map_basic_test(void) {
+  size_t expired = 0;
+  struct expiring_map_options options = {.on_expire = count_expired, .context = &expired};
+  struct expiring_map map = expiring_map_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, 100, &options);
+  assert(expiring_map_size(&map) == 0);
+  assert(expiring_map_now(&map) == 100);
+
+  // key `i` expires at `100 + i + 1`
+  for (size_t i = 0; i < 1000; i++) { assert(expiring_map_put(&map, &i, &(size_t){i * 2}, 101 + i, NULL) == DS_OK); }
+  assert(expiring_map_size(&map) == 1000);
+
+  size_t key = 0;
+  size_t value = 0;
+  assert(expiring_map_put(&map, &key, &value, 100, NULL) == DS_ERROR);  // the deadline has passed
+
+  assert(expiring_map_advance(&map, 110) == 10);
+  assert(expired == 10);
+  assert(expiring_map_size(&map) == 990);
+  assert(expiring_map_now(&map) == 110);
+
+  for (size_t i = 0; i < 1000; i++) { assert(expiring_map_contains(&map, &i, 110) == (i >= 10)); }
+
+  // time never goes backwards
+  assert(expiring_map_advance(&map, 50) == 0);
+  assert(expiring_map_now(&map) == 110);
+
+  // lazy expiration ahead of the wheel. the map's time is left as is
+  key = 20;
+  assert(expiring_map_get(&map, &key, 120, &value) == DS_VALUE_OK);
+  assert(value == 40);
+  assert(expiring_map_get(&map, &key, 121, &value) == DS_NOT_FOUND);
+  assert(expired == 11);
+  assert(expiring_map_size(&map) == 989);
+  assert(expiring_map_now(&map) == 110);
+
+  // replacing a value reschedules its entry
+  key = 30;
+  assert(expiring_map_put(&map, &key, &(size_t){60}, 5000, &value) == DS_VALUE_OK);
+  assert(value == 60);
+
+  // removal doesn't count as an expiration
+  key = 40;
+  assert(expiring_map_remove(&map, &key, &value) == DS_VALUE_OK);
+  assert(value == 80);
+  assert(expiring_map_remove(&map, &key, NULL) == DS_NOT_FOUND);
+
+  assert(expiring_map_advance(&map, 1100) == 987);
+  assert(expired == 998);
+  assert(expiring_map_size(&map) == 1);
+
+  key = 30;
+  assert(expiring_map_contains(&map, &key, 4999));
+  assert(expiring_map_advance(&map, 4999) == 0);
+  assert(expiring_map_advance(&map, 5000) == 1);
+  assert(expiring_map_size(&map) == 0);
+
+  expiring_map_destroy(&map);
+}
+
+static void expiring_map_far_test(void) {
+  struct expiring_map map = expiring_map_create(sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, 0, NULL);
+
+  // deadlines on every level of the wheel, up to the end of time
+  uint64_t deadlines[] = {
+      1, 63, 64, 65, 4095, 4096, 1ull << 30, (1ull << 42) + 7, 1ull << 63, UINT64_MAX - 1, UINT64_MAX,
+  };
+  size_t count = sizeof deadlines / sizeof *deadlines;
+  for (size_t i = 0; i < count; i++) { assert(expiring_map_put(&map, &i, &i, deadlines[i], NULL) == DS_OK); }
+
+  for (size_t i = 0; i < count; i++) {
+    assert(expiring_map_advance(&map, deadlines[i] - 1) == 0);
+    assert(expiring_map_size(&map) == count - i);
+    assert(expiring_map_advance(&map, deadlines[i]) == 1);
+    assert(!expiring_map_contains(&map, &i, deadlines[i]));
+  }
+  assert(expiring_map_size(&map) == 0);
+  assert(expiring_map_advance(&map, UINT64_MAX) == 0);
+
+  expiring_map_destroy(&map);
+}
+
+static void free_ptr(void *ptr) {
+  free(*(size_t **)ptr);
+}
+
+static void expiring_map_random_test(void) {
+  struct expiring_map map = expiring_map_create(sizeof(size_t), sizeof(size_t *), cmpr, NULL, NULL, free_ptr, 0, NULL);
+
+  uint64_t deadlines[RANDOM_KEYS];
+  srand(17);
+  for (size_t i = 0; i < RANDOM_KEYS; i++) {
+    deadlines[i] = 1 + (uint64_t)rand() % 100000;
+    size_t *value = malloc(sizeof *value);
+    assert(expiring_map_put(&map, &i, &value, deadlines[i], NULL) == DS_OK);
+  }
+
+  // jumps of random length expire exactly the entries which are due
+  uint64_t now = 0;
+  while (now < 100000) {
+    uint64_t next = now + 1 + (uint64_t)rand() % 3000;
+    size_t due = 0;
+    for (size_t i = 0; i < RANDOM_KEYS; i++) { due += deadlines[i] > now && deadlines[i] <= next; }
+
+    assert(expiring_map_advance(&map, next) == due);
+    for (size_t i = 0; i < RANDOM_KEYS; i += 97) {
+      assert(expiring_map_contains(&map, &i, next) == (deadlines[i] > next));
+    }
+    now = next;
+  }
+  assert(expiring_map_size(&map) == 0);
+
+  // the remaining entries are destroyed along with the map
+  for (size_t i = 0; i < 100; i++) {
+    size_t *value = malloc(sizeof *value);
+    assert(expiring_map_put(&map, &i, &value, now + 1 + i * 1000, NULL) == DS_OK);
+  }
+  expiring_map_destroy(&map);
+}
+
+int main(void) {
+  expiring_map_basic_test();
+  expiring_map_far_test();
+  expiring_map_random_test();
+}
@@ -0,0 +1,90 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "filter.h"
+
+#define SIZE 20000
+
+/* any hash will do, the filters mix it further. consecutive integers are the worst case of a weak hash */
+static size_t hash_of(size_t key) {
+  return key;
+}
+
+static void bloom_filter_test(void) {
+  struct bloom_filter filter = bloom_filter_create(SIZE, 0);
+  assert(bloom_filter_size(&filter) == 0);
+  assert(!bloom_filter_contains(&filter, hash_of(1)));
+
+  for (size_t i = 0; i < SIZE; i++) { assert(bloom_filter_add(&filter, hash_of(i)) == DS_OK); }
+  assert(bloom_filter_size(&filter) == SIZE);
+
+  // no false negatives
+  for (size_t i = 0; i < SIZE; i++) { assert(bloom_filter_contains(&filter, hash_of(i))); }
+
+  // `10` bits per key yield about `1%` false positives. a blocked filter is somewhat worse than a classic one
+  size_t false_positives = 0;
+  for (size_t i = SIZE; i < SIZE * 11; i++) { false_positives += bloom_filter_contains(&filter, hash_of(i)); }
+  assert(false_positives < SIZE * 10 / 25);
+
+  bloom_filter_clear(&filter);
+  assert(bloom_filter_size(&filter) == 0);
+  for (size_t i = 0; i < SIZE; i++) { assert(!bloom_filter_contains(&filter, hash_of(i))); }
+
+  bloom_filter_destroy(&filter);
+  assert(bloom_filter_add(&filter, hash_of(1)) == DS_ERROR);
+  assert(!bloom_filter_contains(&filter, hash_of(1)));
+  assert(bloom_filter_add(NULL, hash_of(1)) == DS_ERROR);
+}
+
+static void cuckoo_filter_test(void) {
+  struct cuckoo_filter filter = cuckoo_filter_create(SIZE);
+  assert(cuckoo_filter_size(&filter) == 0);
+  assert(!cuckoo_filter_contains(&filter, hash_of(1)));
+
+  for (size_t i = 0; i < SIZE; i++) { assert(cuckoo_filter_add(&filter, hash_of(i)) == DS_OK); }
+  assert(cuckoo_filter_size(&filter) == SIZE);
+  for (size_t i = 0; i < SIZE; i++) { assert(cuckoo_filter_contains(&filter, hash_of(i))); }
+
+  size_t false_positives = 0;
+  for (size_t i = SIZE; i < SIZE * 11; i++) { false_positives += cuckoo_filter_contains(&filter, hash_of(i)); }
+  assert(false_positives < SIZE * 10 / 100);
+
+  // the removed hashes are forgotten, the others remain
+  for (size_t i = 0; i < SIZE; i += 2) { assert(cuckoo_filter_remove(&filter, hash_of(i)) == DS_OK); }
+  assert(cuckoo_filter_size(&filter) == SIZE / 2);
+  for (size_t i = 1; i < SIZE; i += 2) { assert(cuckoo_filter_contains(&filter, hash_of(i))); }
+
+  size_t remaining = 0;
+  for (size_t i = 0; i < SIZE; i += 2) { remaining += cuckoo_filter_contains(&filter, hash_of(i)); }
+  assert(remaining < SIZE / 2 / 100);
+
+  // a hash added twice is removed twice
+  assert(cuckoo_filter_add(&filter, hash_of(SIZE * 20)) == DS_OK);
+  assert(cuckoo_filter_add(&filter, hash_of(SIZE * 20)) == DS_OK);
+  assert(cuckoo_filter_remove(&filter, hash_of(SIZE * 20)) == DS_OK);
+  assert(cuckoo_filter_contains(&filter, hash_of(SIZE * 20)));
+  assert(cuckoo_filter_remove(&filter, hash_of(SIZE * 20)) == DS_OK);
+  cuckoo_filter_destroy(&filter);
+
+  // a full filter rejects more hashes and leaves the ones it holds intact
+  filter = cuckoo_filter_create(64);
+  size_t added = 0;
+  while (cuckoo_filter_add(&filter, hash_of(added)) == DS_OK) { added++; }
+  assert(added >= 64);
+  assert(cuckoo_filter_size(&filter) == added);
+  for (size_t i = 0; i < added; i++) { assert(cuckoo_filter_contains(&filter, hash_of(i))); }
+
+  // removing makes room again
+  assert(cuckoo_filter_remove(&filter, hash_of(0)) == DS_OK);
+  assert(cuckoo_filter_remove(&filter, hash_of(1)) == DS_OK);
+  assert(cuckoo_filter_add(&filter, hash_of(added)) == DS_OK);
+  for (size_t i = 2; i <= added; i++) { assert(cuckoo_filter_contains(&filter, hash_of(i))); }
+  cuckoo_filter_destroy(&filter);
+}
+
+int main(void) {
+  bloom_filter_test();
+  cuckoo_filter_test();
+}
@@ -0,0 +1,125 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ascii_str.h"
+#include "hash_set.h"
+
+static int int_cmpr(void const *left, void const *right) {
+  int const *l = left;
+  int const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+static int str_cmpr(void const *left, void const *right) {
+  return strcmp(ascii_str_c_str((void *)left), ascii_str_c_str((void *)right));
+}
+
+static void destroy_str(void *key) {
+  ascii_str_destroy(key);
+}
+
+static void set_insert_test(void) {
+  enum local_size {
+    SIZE = 1000,
+  };
+
+  struct hash_set set = set_create(sizeof(int), int_cmpr, NULL, NULL);
+  assert(set_empty(&set));
+  assert(set._table._entries._data_size == sizeof(int));  // a slot is a bare key, with no padding
+
+  for (int i = 0; i < SIZE; i++) { assert(set_insert(&set, &i) == DS_OK); }
+  for (int i = 0; i < SIZE; i += 2) { assert(set_insert(&set, &i) == DS_VALUE_OK); }
+  assert(set_size(&set) == SIZE);
+
+  for (int i = 0; i < SIZE * 2; i++) { assert(set_contains(&set, &i) == (i < SIZE)); }
+
+  for (int i = 0; i < SIZE; i += 2) { assert(set_remove(&set, &i) == DS_OK); }
+  assert(set_remove(&set, &(int){0}) == DS_NOT_FOUND);
+  assert(set_size(&set) == SIZE / 2);
+
+  size_t visited = 0;
+  for (int const *iter = set_iter_begin(&set); iter; iter = set_iter_next(&set, iter)) {
+    assert(*iter % 2 == 1);
+    visited++;
+  }
+  assert(visited == SIZE / 2);
+
+  set_destroy(&set);
+}
+
+static void set_operations_test(void) {
+  enum local_size {
+    SIZE = 600,
+  };
+
+  // evens and multiples of 3
+  struct hash_set evens = set_create(sizeof(int), int_cmpr, NULL, NULL);
+  struct hash_set threes = set_create(sizeof(int), int_cmpr, NULL, NULL);
+  for (int i = 0; i < SIZE; i++) {
+    if (i % 2 == 0) set_insert(&evens, &i);
+    if (i % 3 == 0) set_insert(&threes, &i);
+  }
+
+  struct hash_set all = set_create(sizeof(int), int_cmpr, NULL, NULL);
+  assert(set_union(&all, &evens) == DS_OK);
+  assert(set_union(&all, &threes) == DS_OK);
+  for (int i = 0; i < SIZE; i++) { assert(set_contains(&all, &i) == (i % 2 == 0 || i % 3 == 0)); }
+
+  // multiples of 6
+  assert(set_intersect(&evens, &threes) == SIZE / 2 - SIZE / 6);
+  assert(set_size(&evens) == SIZE / 6);
+  for (int i = 0; i < SIZE; i++) { assert(set_contains(&evens, &i) == (i % 6 == 0)); }
+
+  // multiples of 3 which are odd
+  assert(set_difference(&threes, &evens) == SIZE / 6);
+  for (int i = 0; i < SIZE; i++) { assert(set_contains(&threes, &i) == (i % 3 == 0 && i % 2 == 1)); }
+
+  set_destroy(&all);
+  set_destroy(&threes);
+  set_destroy(&evens);
+}
+
+static void set_destructor_test(void) {
+  enum local_size {
+    SIZE = 200,
+  };
+
+  struct hash_set set = set_create(sizeof(struct ascii_str), str_cmpr, NULL, destroy_str);
+  struct hash_set removed = set_create(sizeof(struct ascii_str), str_cmpr, NULL, destroy_str);
+
+  char buf[16];
+  for (int i = 0; i < SIZE; i++) {
+    snprintf(buf, sizeof buf, "key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+    assert(set_insert(&set, &key) == DS_OK);
+
+    // the set doesn't take ownership of a duplicate
+    struct ascii_str duplicate = ascii_str_create(buf, STR_C_STR);
+    assert(set_insert(&set, &duplicate) == DS_VALUE_OK);
+    ascii_str_destroy(&duplicate);
+
+    if (i % 4 == 0) {
+      struct ascii_str copy = ascii_str_create(buf, STR_C_STR);
+      assert(set_insert(&removed, &copy) == DS_OK);
+    }
+  }
+
+  // the removed keys are destroyed by the set
+  assert(set_difference(&set, &removed) == SIZE / 4);
+  assert(set_size(&set) == SIZE - SIZE / 4);
+
+  // the keys would be owned by both sets
+  assert(set_union(&set, &removed) == DS_ERROR);
+  assert(set_size(&set) == SIZE - SIZE / 4);
+
+  set_destroy(&removed);
+  set_destroy(&set);
+}
+
+int main(void) {
+  set_insert_test();
+  set_operations_test();
+  set_destructor_test();
+}
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table_typed.h"
+
+#define SIZE 10000
+
+HASH_TABLE_DEFINE(u64_table, uint64_t, uint64_t, typed_table_hash_u64, typed_table_eq_u64)
+
+struct point {
+  int x;
+  int y;
+};
+
+static size_t point_hash(struct point const *point) {
+  return (size_t)point->x * 31 + (size_t)point->y;
+}
+
+#define POINT_EQ(left, right) ((left)->x == (right)->x && (left)->y == (right)->y)
+
+HASH_TABLE_DEFINE(point_table, struct point, char *, point_hash, POINT_EQ)
+
+static void free_string(char **string) {
+  free(*string);
+}
+
+static void typed_table_basic_test(void) {
+  struct u64_table table = u64_table_create(NULL, NULL);
+  assert(u64_table_size(&table) == 0);
+  assert(u64_table_capacity(&table) == TYPED_TABLE_INIT_CAPACITY);
+
+  for (uint64_t i = 0; i < SIZE; i++) { assert(u64_table_put(&table, &i, &(uint64_t){i * 2}, NULL) == DS_OK); }
+  assert(u64_table_size(&table) == SIZE);
+
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint64_t value = 0;
+    assert(u64_table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == i * 2);
+  }
+
+  uint64_t key = 7;
+  uint64_t old = 0;
+  assert(u64_table_put(&table, &key, &(uint64_t){1}, &old) == DS_VALUE_OK);
+  assert(old == 14);
+  assert(*u64_table_get_ref(&table, &key) == 1);
+  *u64_table_get_ref(&table, &key) = 2;
+  assert(u64_table_get(&table, &key, &old) == DS_VALUE_OK && old == 2);
+
+  key = SIZE;
+  assert(!u64_table_contains(&table, &key));
+  assert(u64_table_get(&table, &key, &old) == DS_NOT_FOUND);
+  assert(u64_table_get_ref(&table, &key) == NULL);
+  assert(u64_table_remove(&table, &key, NULL) == DS_NOT_FOUND);
+
+  // remove every odd key, then reinsert half of them. the deleted slots are reused
+  for (uint64_t i = 1; i < SIZE; i += 2) {
+    assert(u64_table_remove(&table, &i, &old) == DS_VALUE_OK);
+    assert(old == (i == 7 ? 2 : i * 2));
+  }
+  assert(u64_table_size(&table) == SIZE / 2);
+  for (uint64_t i = 0; i < SIZE; i++) { assert(u64_table_contains(&table, &i) == !(i & 1)); }
+
+  size_t capacity = u64_table_capacity(&table);
+  for (uint64_t i = 1; i < SIZE; i += 4) { assert(u64_table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(u64_table_capacity(&table) == capacity);
+
+  // iteration visits every element once
+  size_t visited = 0;
+  uint64_t sum = 0;
+  for (struct u64_table_slot *it = u64_table_iter_begin(&table); it; it = u64_table_iter_next(&table, it)) {
+    visited++;
+    sum += it->key;
+  }
+  assert(visited == u64_table_size(&table));
+
+  uint64_t expected = 0;
+  for (uint64_t i = 0; i < SIZE; i++) { expected += (i & 1) && (i % 4 != 1) ? 0 : i; }
+  assert(sum == expected);
+
+  assert(u64_table_reserve(&table, SIZE * 8) >= SIZE * 8);
+  for (uint64_t i = 0; i < SIZE; i++) { assert(u64_table_contains(&table, &i) == (!(i & 1) || i % 4 == 1)); }
+
+  // invalid arguments
+  assert(u64_table_put(&table, NULL, &key, NULL) == DS_ERROR);
+  assert(u64_table_put(&table, &key, NULL, NULL) == DS_ERROR);
+  assert(u64_table_get(&table, &key, NULL) == DS_ERROR);
+  assert(u64_table_remove(NULL, &key, NULL) == DS_ERROR);
+
+  u64_table_destroy(&table);
+  assert(u64_table_put(&table, &key, &key, NULL) == DS_ERROR);
+  assert(u64_table_size(&table) == 0);
+}
+
+/* the same sequence of operations on a typed table and a plain array must agree */
+static void typed_table_churn_test(void) {
+  struct u64_table table = u64_table_create(NULL, NULL);
+  bool present[SIZE / 10] = {0};
+
+  uint64_t state = 88172645463325252ull;
+  for (size_t op = 0; op < SIZE * 20; op++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    uint64_t key = state % (SIZE / 10);
+    if (state >> 62) {
+      enum ds_error ret = u64_table_put(&table, &key, &key, NULL);
+      assert(ret == DS_OK);
+      present[key] = true;
+    } else {
+      assert(u64_table_remove(&table, &key, NULL) == (present[key] ? DS_OK : DS_NOT_FOUND));
+      present[key] = false;
+    }
+  }
+
+  size_t expected = 0;
+  for (uint64_t key = 0; key < SIZE / 10; key++) {
+    assert(u64_table_contains(&table, &key) == present[key]);
+    expected += present[key];
+  }
+  assert(u64_table_size(&table) == expected);
+
+  u64_table_destroy(&table);
+}
+
+static char *string_of(int n) {
+  char *string = malloc(16);
+  assert(string);
+  memset(string, 'a' + n % 26, 15);
+  string[15] = '\0';
+  return string;
+}
+
+/* struct keys and owning values: the replaced and the removed values are destroyed, unless they're returned */
+static void typed_table_destructor_test(void) {
+  struct point_table table = point_table_create(NULL, free_string);
+
+  for (int i = 0; i < 100; i++) {
+    struct point point = {i, -i};
+    assert(point_table_put(&table, &point, &(char *){string_of(i)}, NULL) == DS_OK);
+  }
+
+  struct point point = {3, -3};
+  assert(point_table_put(&table, &point, &(char *){string_of(4)}, NULL) == DS_OK);
+  assert(point_table_get_ref(&table, &point)[0][0] == 'e');
+
+  char *old = NULL;
+  assert(point_table_remove(&table, &point, &old) == DS_VALUE_OK);
+  assert(old[0] == 'e');
+  free(old);
+
+  point = (struct point){4, -4};
+  assert(point_table_remove(&table, &point, NULL) == DS_OK);
+  point = (struct point){4, 4};
+  assert(!point_table_contains(&table, &point));
+  assert(point_table_size(&table) == 98);
+
+  point_table_destroy(&table);
+}
+
+int main(void) {
+  typed_table_basic_test();
+  typed_table_churn_test();
+  typed_table_destructor_test();
+}
@@ -1,10 +1,20 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+// snapshots are only available where the table can map them (see `table_open_mapped`)
+#if defined(__unix__) || defined(__APPLE__)
+#define HAS_SNAPSHOTS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "ascii_str.h"
 #include "hash_table.h"
 
@@ -197,6 +207,1058 @@ static void table_contains_test(void) {
   after(&table, keys, replaced, SIZE);
 }
 
+static int int_cmpr(void const *left, void const *right) {
+  int const *_left = left;
+  int const *_right = right;
+  return (*_left > *_right) - (*_left < *_right);
+}
+
+static void table_open_addressing_test(void) {
+  enum local_size {
+    SIZE = 1000,
+  };
+
+  struct table_options options = {.engine = TABLE_OPEN_ADDRESSING};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(long), int_cmpr, NULL, NULL, NULL, &options);
+  assert(table_capacity(&table) > 0);
+
+  for (int i = 0; i < SIZE; i++) {
+    long value = (long)i * 3;
+    assert(table_put(&table, &i, &value, NULL) == DS_OK);
+  }
+  assert(table_size(&table) == SIZE);
+
+  // replace
+  int key = 7;
+  long value = -7;
+  long old = 0;
+  assert(table_put(&table, &key, &value, &old) == DS_VALUE_OK);
+  assert(old == 21);
+  assert(table_size(&table) == SIZE);
+
+  // remove every other key, leaving tombstones behind
+  for (int i = 0; i < SIZE; i += 2) { assert(table_remove(&table, &i, NULL) == DS_OK); }
+  assert(table_size(&table) == SIZE / 2);
+
+  for (int i = 0; i < SIZE; i++) {
+    assert(table_contains(&table, &i) == (i % 2 == 1));
+    if (i % 2 == 0 || i == key) continue;
+
+    assert(table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == (long)i * 3);
+  }
+
+  // churn through the tombstones
+  for (int i = SIZE; i < SIZE * 4; i++) {
+    value = i;
+    assert(table_put(&table, &i, &value, NULL) == DS_OK);
+    assert(table_remove(&table, &i, &old) == DS_VALUE_OK);
+    assert(old == i);
+  }
+  assert(table_size(&table) == SIZE / 2);
+  assert(table_get(&table, &key, &value) == DS_VALUE_OK);
+  assert(value == -7);
+
+  table_destroy(&table);
+}
+
+static void table_open_addressing_destructors_test(void) {
+  enum local_size {
+    SIZE = 100,
+  };
+
+  struct ascii_str keys[SIZE] = {0};
+
+  struct table_options options = {.engine = TABLE_OPEN_ADDRESSING};
+  struct hash_table table =
+    table_create_ex(sizeof(struct ascii_str), sizeof(int), cmpr, hash, destroy_key, NULL, &options);
+
+  for (int i = 0; i < SIZE; i++) {
+    keys[i] = ascii_str_from_fmt("key-%d", i);
+    assert(table_put(&table, &keys[i], &i, NULL) == DS_OK);
+  }
+
+  for (int i = 0; i < SIZE; i++) {
+    int value;
+    assert(table_get(&table, &keys[i], &value) == DS_VALUE_OK);
+    assert(value == i);
+  }
+
+  // the table owns the keys, `destroy_key` is called on removal
+  struct ascii_str removed = ascii_str_from_fmt("key-%d", 0);
+  assert(table_remove(&table, &removed, NULL) == DS_OK);
+  assert(!table_contains(&table, &removed));
+
+  table_destroy(&table);
+  ascii_str_destroy(&removed);
+}
+
+static size_t hash_calls = 0;
+
+static size_t counting_hash(void const *key, size_t size) {
+  hash_calls++;
+
+  unsigned char const *bytes = key;
+  size_t hash = 5381;
+  for (size_t i = 0; i < size; i++) { hash = hash * 33 + bytes[i]; }
+  return hash;
+}
+
+static void table_resize_without_rehash_test(void) {
+  enum local_size {
+    SIZE = 1000,
+  };
+
+  struct hash_table table = table_create(sizeof(int), sizeof(int), int_cmpr, counting_hash, NULL, NULL);
+  size_t init_capacity = table_capacity(&table);
+
+  hash_calls = 0;
+  for (int i = 0; i < SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+
+  // the table resized a few times yet every key was hashed exactly once
+  assert(table_capacity(&table) > init_capacity);
+  assert(hash_calls == SIZE);
+
+  for (int i = 0; i < SIZE; i++) {
+    int value;
+    assert(table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == i);
+  }
+
+  table_destroy(&table);
+}
+
+static void table_incremental_resize_test(void) {
+  struct table_options options = {.incremental_resize = true};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  // fill the table until a resize of at least 1024 entries starts
+  int count = 0;
+  for (; !table_rehashing(&table) || table_capacity(&table) < 2048; count++) {
+    assert(table_put(&table, &count, &count, NULL) == DS_OK);
+
+    if (table_rehashing(&table)) {
+      assert(table_rehash_pending(&table) > 0);
+
+      // both the migrated and the yet to be migrated keys are reachable
+      for (int j = 0; j <= count; j += 7) { assert(table_contains(&table, &j)); }
+    }
+  }
+  assert(table_size(&table) == (size_t)count);
+
+  // remove keys while some of them still reside in the old entries
+  for (int i = 0; i < count; i += 2) {
+    if (i == 0) assert(table_rehashing(&table));
+
+    int old;
+    assert(table_remove(&table, &i, &old) == DS_VALUE_OK);
+    assert(old == i);
+  }
+
+  table_rehash_step(&table, SIZE_MAX);
+  assert(!table_rehashing(&table));
+  assert(table_rehash_pending(&table) == 0);
+
+  for (int i = 0; i < count; i++) {
+    int value = -1;
+    assert(table_get(&table, &i, &value) == (i % 2 ? DS_VALUE_OK : DS_NOT_FOUND));
+    if (i % 2) assert(value == i);
+  }
+
+  table_destroy(&table);
+}
+
+enum order_size {
+  ORDER_SIZE = 200,
+};
+
+static int visit_order[ORDER_SIZE];
+static size_t visited = 0;
+
+static void record_order(void const *key, void const *value, size_t entry_idx) {
+  (void)value;
+  (void)entry_idx;
+
+  if (visited < ORDER_SIZE) visit_order[visited] = *(int const *)key;
+  visited++;
+}
+
+static void table_seed_test(void) {
+  int first_order[ORDER_SIZE];
+
+  // tables sharing a seed lay their keys out identically
+  for (int round = 0; round < 2; round++) {
+    struct table_options options = {.seed = 0x1234};
+    struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+    assert((table_capacity(&table) & (table_capacity(&table) - 1)) == 0);
+
+    for (int i = 0; i < ORDER_SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+    assert((table_capacity(&table) & (table_capacity(&table) - 1)) == 0);
+
+    visited = 0;
+    print_table(&table, record_order);
+    assert(visited == ORDER_SIZE);
+
+    if (round == 0) {
+      memcpy(first_order, visit_order, sizeof first_order);
+    } else {
+      assert(memcmp(first_order, visit_order, sizeof first_order) == 0);
+    }
+
+    table_destroy(&table);
+  }
+
+  // a random seed hashes just as well
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, NULL);
+  for (int i = 0; i < ORDER_SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  for (int i = 0; i < ORDER_SIZE; i++) {
+    int value;
+    assert(table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == i);
+  }
+  table_destroy(&table);
+}
+
+static void count_occurrence(void *value, bool exists, void *context) {
+  int *count = value;
+  int *inserted = context;
+
+  if (exists) {
+    (*count)++;
+  } else {
+    *count = 1;
+    (*inserted)++;
+  }
+}
+
+static void table_in_place_test(enum table_engine engine) {
+  enum local_size {
+    SIZE = 300,
+  };
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  // emplace constructs the value in the table's storage
+  for (int i = 0; i < SIZE; i++) {
+    void *value = NULL;
+    assert(table_emplace(&table, &i, &value) == DS_OK);
+    assert(value);
+    *(int *)value = i * 2;
+  }
+  assert(table_size(&table) == SIZE);
+
+  int key = 5;
+  void *existing = NULL;
+  assert(table_emplace(&table, &key, &existing) == DS_VALUE_OK);
+  assert(*(int *)existing == 10);
+  assert(table_size(&table) == SIZE);
+
+  // get_ref points at the stored value, writing through it updates the table
+  int *ref = table_get_ref(&table, &key);
+  assert(ref && *ref == 10);
+  *ref = -1;
+
+  int value;
+  assert(table_get(&table, &key, &value) == DS_VALUE_OK);
+  assert(value == -1);
+
+  int missing = SIZE;
+  assert(!table_get_ref(&table, &missing));
+
+  // upsert updates existing values and initializes new ones
+  int inserted = 0;
+  for (int i = 0; i < SIZE * 2; i++) {
+    int k = i % (SIZE + 10);
+    enum ds_error err = table_upsert_with(&table, &k, count_occurrence, &inserted);
+    assert(err == DS_OK || err == DS_VALUE_OK);
+  }
+  assert(inserted == 10);
+  assert(table_size(&table) == SIZE + 10);
+
+  missing = SIZE + 3;
+  ref = table_get_ref(&table, &missing);
+  assert(ref && *ref == 1);
+
+  key = 0;
+  ref = table_get_ref(&table, &key);
+  assert(ref && *ref == 2);
+
+  table_destroy(&table);
+}
+
+static void table_batch_test(enum table_engine engine) {
+  enum local_size {
+    SIZE = 500,
+  };
+
+  int keys[SIZE];
+  long values[SIZE];
+  for (int i = 0; i < SIZE; i++) {
+    keys[i] = i * 3;
+    values[i] = (long)i * 7;
+  }
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(long), int_cmpr, NULL, NULL, NULL, &options);
+
+  enum ds_error status[SIZE];
+  assert(table_put_many(&table, keys, values, SIZE, status) == SIZE);
+  for (int i = 0; i < SIZE; i++) { assert(status[i] == DS_OK); }
+  assert(table_size(&table) == SIZE);
+
+  // half of the keys already exist
+  int more_keys[SIZE];
+  long more_values[SIZE];
+  for (int i = 0; i < SIZE; i++) {
+    more_keys[i] = i % 2 ? keys[i] : SIZE * 3 + i;
+    more_values[i] = -i;
+  }
+  assert(table_put_many(&table, more_keys, more_values, SIZE, status) == SIZE / 2);
+  for (int i = 0; i < SIZE; i++) { assert(status[i] == (i % 2 ? DS_VALUE_OK : DS_OK)); }
+
+  // every other looked up key is missing
+  int lookup[SIZE];
+  long found[SIZE] = {0};
+  for (int i = 0; i < SIZE; i++) { lookup[i] = i % 2 ? i * 3 : i * 3 + 1; }
+  assert(table_get_many(&table, lookup, SIZE, found, status) == SIZE / 2);
+  for (int i = 0; i < SIZE; i++) {
+    if (i % 2) {
+      assert(status[i] == DS_VALUE_OK);
+      assert(found[i] == -i);
+    } else {
+      assert(status[i] == DS_NOT_FOUND);
+    }
+  }
+
+  table_destroy(&table);
+}
+
+static void table_capacity_policy_test(enum table_engine engine, bool incremental) {
+  enum local_size {
+    SIZE = 3000,
+  };
+
+  struct table_options options = {.engine = engine,
+                                  .incremental_resize = incremental,
+                                  .initial_capacity = 1000,
+                                  .min_load_factor = 0.1};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  // presized: no resize up to the initial capacity
+  size_t capacity = table_capacity(&table);
+  assert(capacity >= 1000 && !(capacity & (capacity - 1)));
+  for (int i = 0; i < 1000; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(table_capacity(&table) == capacity);
+
+  size_t reserved = table_reserve(&table, SIZE);
+  assert(reserved > capacity);
+  assert(!table_rehashing(&table));
+  for (int i = 1000; i < SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(table_capacity(&table) == reserved);
+
+  // reserving less than the current capacity is a no-op
+  assert(table_reserve(&table, 10) == reserved);
+
+  // mass removal shrinks the table, though never below its initial capacity
+  for (int i = 0; i < SIZE - 10; i++) { assert(table_remove(&table, &i, NULL) == DS_OK); }
+  while (table_rehashing(&table)) table_rehash_step(&table, SIZE_MAX);
+  assert(table_capacity(&table) == capacity);
+
+  for (int i = SIZE - 10; i < SIZE; i++) {
+    int value = 0;
+    assert(table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == i);
+  }
+
+  assert(table_shrink_to_fit(&table) < capacity);
+  assert(!table_rehashing(&table));
+  assert(table_size(&table) == 10);
+  for (int i = SIZE - 10; i < SIZE; i++) { assert(table_contains(&table, &i)); }
+
+  table_destroy(&table);
+
+  // a growth factor of 4 quadruples the capacity
+  options = (struct table_options){.engine = engine, .growth_factor = 4, .max_load_factor = 0.5};
+  table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+  capacity = table_capacity(&table);
+  for (int i = 0; (size_t)i <= capacity / 2; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(table_capacity(&table) == capacity * 4);
+  table_destroy(&table);
+
+  // invalid policies
+  struct table_options invalid[] = {
+      {.engine = engine, .growth_factor = 3},
+      {.engine = engine, .max_load_factor = -1},
+      {.engine = engine, .min_load_factor = 0.5},
+      {.engine = engine, .max_load_factor = 0.8, .growth_factor = 4, .min_load_factor = 0.2},
+  };
+  for (size_t i = 0; i < sizeof invalid / sizeof *invalid; i++) {
+    table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &invalid[i]);
+    assert(table_capacity(&table) == 0);
+  }
+
+  options = (struct table_options){.engine = engine, .max_load_factor = 1.5};
+  table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+  assert((table_capacity(&table) == 0) == (engine == TABLE_OPEN_ADDRESSING || engine == TABLE_ORDERED));
+  table_destroy(&table);
+}
+
+static void sum_values(void const *key, void *value, void *context) {
+  int const *_key = key;
+  long *_value = value;
+  long *sum = context;
+
+  assert(*_value == *_key * 2);
+  *sum += *_value;
+  *_value = -*_value;
+}
+
+static void table_iteration_test(enum table_engine engine, bool incremental) {
+  enum local_size {
+    SIZE = 2000,
+  };
+
+  struct table_options options = {.engine = engine, .incremental_resize = incremental};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(long), int_cmpr, NULL, NULL, NULL, &options);
+  assert(!table_iter_begin(&table));
+
+  for (int i = 0; i < SIZE; i++) {
+    long value = i * 2;
+    assert(table_put(&table, &i, &value, NULL) == DS_OK);
+  }
+
+  // removals leave holes which iteration must skip
+  for (int i = 0; i < SIZE; i += 3) { assert(table_remove(&table, &i, NULL) == DS_OK); }
+
+  static bool seen[SIZE];
+  memset(seen, 0, sizeof seen);
+  size_t visited = 0;
+  for (void *iter = table_iter_begin(&table); iter; iter = table_iter_next(&table, iter)) {
+    int const *key = table_iter_key(&table, iter);
+    long const *value = table_iter_value(&table, iter);
+
+    assert(*key % 3 != 0);
+    assert(*value == *key * 2);
+    assert(!seen[*key]);
+    seen[*key] = true;
+    visited++;
+  }
+  assert(visited == table_size(&table));
+
+  long sum = 0;
+  long expected = 0;
+  for (int i = 0; i < SIZE; i++) {
+    if (i % 3) expected += i * 2;
+  }
+
+  // values may be modified in place
+  table_for_each(&table, sum_values, &sum);
+  assert(sum == expected);
+  for (int i = 1; i < SIZE; i += 3) {
+    long value = 0;
+    assert(table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == -i * 2);
+  }
+
+  table_destroy(&table);
+}
+
+static void table_dense_destructors_test(void) {
+  enum local_size {
+    SIZE = 300,
+  };
+
+  struct table_options options = {.engine = TABLE_DENSE};
+  struct hash_table table =
+      table_create_ex(sizeof(struct ascii_str), sizeof(int), cmpr, hash, destroy_key, NULL, &options);
+
+  char buf[16];
+  for (int i = 0; i < SIZE; i++) {
+    snprintf(buf, sizeof buf, "key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+    assert(table_put(&table, &key, &i, NULL) == DS_OK);
+  }
+
+  // every removal moves the last record into the removed one's place
+  for (int i = 0; i < SIZE; i += 2) {
+    snprintf(buf, sizeof buf, "key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+    assert(table_remove(&table, &key, NULL) == DS_OK);
+    ascii_str_destroy(&key);
+  }
+
+  for (int i = 0; i < SIZE; i++) {
+    snprintf(buf, sizeof buf, "key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+    int value = -1;
+    assert(table_get(&table, &key, &value) == (i % 2 ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i % 2 == 0 || value == i);
+    ascii_str_destroy(&key);
+  }
+
+  assert(table_shrink_to_fit(&table) == 256);
+  assert(table_size(&table) == SIZE / 2);
+
+  table_destroy(&table);
+}
+
+static size_t constant_hash(void const *key, size_t size) {
+  (void)key;
+  (void)size;
+  return 42;
+}
+
+static void table_freeze_test(enum table_engine engine) {
+  enum local_size {
+    SIZE = 5000,
+  };
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table =
+      table_create_ex(sizeof(struct ascii_str), sizeof(int), cmpr, hash, destroy_key, NULL, &options);
+
+  char buf[32];
+  for (int i = 0; i < SIZE; i++) {
+    snprintf(buf, sizeof buf, "frozen key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+    assert(table_put(&table, &key, &i, NULL) == DS_OK);
+  }
+
+  assert(table_freeze(&table) == DS_OK);
+  assert(table_freeze(&table) == DS_OK);
+  assert(table_size(&table) == SIZE);
+  assert(table_capacity(&table) == SIZE);
+
+  for (int i = 0; i < SIZE * 2; i++) {
+    snprintf(buf, sizeof buf, "frozen key %d", i);
+    struct ascii_str key = ascii_str_create(buf, STR_C_STR);
+
+    int value = -1;
+    assert(table_get(&table, &key, &value) == (i < SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i >= SIZE || value == i);
+
+    // a frozen table is read only
+    if (i >= SIZE) assert(table_put(&table, &key, &i, NULL) == DS_ERROR);
+    if (i < SIZE) assert(table_remove(&table, &key, NULL) == DS_ERROR);
+    ascii_str_destroy(&key);
+  }
+  assert(table_size(&table) == SIZE);
+
+  size_t visited = 0;
+  for (void *iter = table_iter_begin(&table); iter; iter = table_iter_next(&table, iter)) { visited++; }
+  assert(visited == SIZE);
+
+  table_destroy(&table);
+
+  // an empty table may be frozen as well
+  table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+  assert(table_freeze(&table) == DS_OK);
+  assert(!table_contains(&table, &(int){1}));
+  table_destroy(&table);
+
+  // distinct keys sharing their hash can't be frozen. the table is left as is
+  table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, constant_hash, NULL, NULL, &options);
+  for (int i = 0; i < 10; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(table_freeze(&table) == DS_ERROR);
+  for (int i = 0; i < 10; i++) { assert(table_contains(&table, &i)); }
+  table_destroy(&table);
+}
+
+#ifdef HAS_SNAPSHOTS
+static size_t int_hash(void const *key, size_t size) {
+  (void)size;
+  return (size_t)*(int const *)key * 2654435761u;
+}
+
+/* used internally to add `delta` to the header field at `offset` of the snapshot at `path`, and check whether the
+ * snapshot is then rejected. the snapshot is restored afterwards */
+static bool corrupt_snapshot_rejected(char const *path,
+                                      off_t offset,
+                                      int delta,
+                                      size_t (*key_hash)(void const *, size_t)) {
+  int fd = open(path, O_RDWR);
+  assert(fd >= 0);
+
+  uint64_t field;
+  assert(pread(fd, &field, sizeof field, offset) == (ssize_t)sizeof field);
+  uint64_t corrupted = field + (uint64_t)(int64_t)delta;
+  assert(pwrite(fd, &corrupted, sizeof corrupted, offset) == (ssize_t)sizeof corrupted);
+
+  struct hash_table mapped = table_open_mapped(path, int_cmpr, key_hash);
+  bool rejected = table_size(&mapped) == 0;
+  table_destroy(&mapped);
+
+  assert(pwrite(fd, &field, sizeof field, offset) == (ssize_t)sizeof field);
+  close(fd);
+  return rejected;
+}
+
+static void table_snapshot_test(enum table_engine engine, size_t (*key_hash)(void const *, size_t)) {
+  enum local_size {
+    SIZE = 5000,
+  };
+
+  char path[] = "/tmp/ht_snapshot_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(long), int_cmpr, key_hash, NULL, NULL, &options);
+  for (int i = 0; i < SIZE; i++) { assert(table_put(&table, &i, &(long){i * 3L}, NULL) == DS_OK); }
+
+  // the snapshot replaces whatever the file held, wherever the descriptor's offset is
+  assert(write(fd, path, sizeof path) == (ssize_t)sizeof path);
+  assert(table_save(&table, fd) == DS_OK);
+  assert(table_size(&table) == SIZE);
+  assert(table_put(&table, &(int){SIZE}, &(long){0}, NULL) == DS_OK);  // the saved table is left writable
+  table_destroy(&table);
+  close(fd);
+
+  struct hash_table mapped = table_open_mapped(path, int_cmpr, key_hash);
+  assert(table_size(&mapped) == SIZE);
+  for (int i = 0; i < SIZE * 2; i++) {
+    long value = -1;
+    assert(table_get(&mapped, &i, &value) == (i < SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i >= SIZE || value == i * 3L);
+  }
+  assert(table_put(&mapped, &(int){SIZE}, &(long){0}, NULL) == DS_ERROR);
+  assert(table_remove(&mapped, &(int){0}, NULL) == DS_ERROR);
+
+  // values may be modified in place, privately
+  long *ref = table_get_ref(&mapped, &(int){7});
+  assert(ref && *ref == 21);
+  *ref = -21;
+  table_destroy(&mapped);
+
+  mapped = table_open_mapped(path, int_cmpr, key_hash);
+  assert(table_contains(&mapped, &(int){SIZE - 1}));
+  assert(*(long *)table_get_ref(&mapped, &(int){7}) == 21);
+  table_destroy(&mapped);
+
+  // a hash which doesn't match the saved table's is rejected
+  mapped = table_open_mapped(path, int_cmpr, key_hash ? NULL : int_hash);
+  assert(table_size(&mapped) == 0);
+  assert(!table_contains(&mapped, &(int){0}));
+  table_destroy(&mapped);
+
+  // so is a header whose sections or records are misaligned. the offsets are those of `struct snapshot_header`
+  assert(corrupt_snapshot_rejected(path, 48, -(int)sizeof(int), key_hash));  // value_offset
+  assert(corrupt_snapshot_rejected(path, 56, -(int)sizeof(int), key_hash));  // record_size
+  assert(corrupt_snapshot_rejected(path, 80, 1, key_hash));                  // pilots_offset
+  assert(corrupt_snapshot_rejected(path, 88, sizeof(long), key_hash));       // records_offset
+
+  // so is anything which isn't a snapshot
+  fd = open(path, O_WRONLY | O_TRUNC);
+  assert(fd >= 0);
+  assert(write(fd, path, sizeof path) == (ssize_t)sizeof path);
+  close(fd);
+  mapped = table_open_mapped(path, int_cmpr, key_hash);
+  assert(table_size(&mapped) == 0);
+  assert(table_open_mapped("/nonexistent/snapshot", int_cmpr, key_hash)._n_elem == 0);
+
+  unlink(path);
+}
+#endif
+
+static void table_stats_test(enum table_engine engine) {
+  enum local_size {
+    SIZE = 1000,
+  };
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+  for (int i = 0; i < SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  for (int i = 0; i < SIZE * 2; i++) { assert(table_contains(&table, &i) == (i < SIZE)); }
+  for (int i = 0; i < SIZE / 2; i++) { assert(table_remove(&table, &i, NULL) == DS_OK); }
+
+  struct table_stats stats;
+  assert(table_stats(&table, &stats) == DS_OK);
+  assert(stats.size == SIZE / 2);
+  assert(stats.capacity == table_capacity(&table));
+  assert(stats.bytes >= stats.size * 2 * sizeof(int));
+
+  // every element is accounted for by exactly one chain. probed engines count a chain per element
+  bool probed = engine == TABLE_OPEN_ADDRESSING || engine == TABLE_ORDERED;
+  size_t elements = 0;
+  for (size_t i = 0; i < TABLE_STATS_CHAINS; i++) { elements += stats.chain_lengths[i] * (probed ? 1 : i); }
+  if (stats.max_chain_length < TABLE_STATS_CHAINS) assert(elements == stats.size);
+  assert(stats.max_chain_length >= 1);
+
+#ifdef DS_TABLE_STATS
+  assert(stats.puts == SIZE && stats.gets == SIZE * 2 && stats.removes == SIZE / 2);
+  assert(stats.hits == SIZE + SIZE / 2 && stats.misses == SIZE + SIZE);
+  assert(stats.avg_get_probes > 0 && stats.avg_remove_probes >= 1);
+  assert(stats.resizes > 0);
+
+  table_stats_reset(&table);
+  assert(table_stats(&table, &stats) == DS_OK);
+  assert(!stats.gets && !stats.puts && !stats.removes && !stats.resizes && stats.size == SIZE / 2);
+#else
+  assert(!stats.gets && !stats.puts && !stats.removes && !stats.hits && !stats.resizes);
+#endif
+
+  assert(table_stats(NULL, &stats) == DS_ERROR);
+  table_destroy(&table);
+}
+
+static void table_prehashed_test(void) {
+  enum local_size {
+    SIZE = 2000,
+  };
+
+  // tables sharing a seed (or a hash function) hash keys identically, whatever their engine
+  struct table_options chained = {.seed = 0x5eed};
+  struct table_options open = {.engine = TABLE_OPEN_ADDRESSING, .seed = 0x5eed};
+  struct hash_table first = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &chained);
+  struct hash_table second = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &open);
+
+  for (int i = 0; i < SIZE; i++) {
+    size_t key_hash = table_hash(&first, &i);
+    assert(key_hash == table_hash(&second, &i));
+
+    assert(table_put_hashed(&first, key_hash, &i, &i, NULL) == DS_OK);
+    assert(table_put_hashed(&second, key_hash, &i, &(int){-i}, NULL) == DS_OK);
+  }
+
+  for (int i = 0; i < SIZE * 2; i++) {
+    size_t key_hash = table_hash(&first, &i);
+    int value = 0;
+
+    // the prehashed and regular operations are interchangeable
+    assert(table_contains_hashed(&first, key_hash, &i) == (i < SIZE));
+    assert(table_get_hashed(&second, key_hash, &i, &value) == (i < SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i >= SIZE || value == -i);
+    assert(table_get(&first, &i, &value) == (i < SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i >= SIZE || value == i);
+  }
+
+  for (int i = 0; i < SIZE; i += 2) {
+    size_t key_hash = table_hash(&first, &i);
+    int old = 0;
+    assert(table_remove_hashed(&first, key_hash, &i, &old) == DS_VALUE_OK && old == i);
+    assert(table_remove_hashed(&second, key_hash, &i, NULL) == DS_OK);
+    assert(table_remove_hashed(&second, key_hash, &i, NULL) == DS_NOT_FOUND);
+  }
+  assert(table_size(&first) == SIZE / 2 && table_size(&second) == SIZE / 2);
+  for (int i = 0; i < SIZE; i++) { assert(table_contains(&second, &i) == (i % 2 == 1)); }
+
+  assert(table_hash(NULL, &(int){0}) == 0);
+  assert(table_put_hashed(NULL, 0, &(int){0}, &(int){0}, NULL) == DS_ERROR);
+  assert(table_get_hashed(&first, 0, NULL, &(int){0}) == DS_ERROR);
+
+  table_destroy(&first);
+  table_destroy(&second);
+}
+
+static void table_ordered_test(void) {
+  enum local_size {
+    SIZE = 40000,  // enough for the index to go through every slot width
+  };
+
+  struct table_options options = {.engine = TABLE_ORDERED};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  // inserted in a scrambled order, iterated over in the same order
+  for (int i = 0; i < SIZE; i++) {
+    int key = (int)(((unsigned)i * 7919u) % SIZE);
+    assert(table_put(&table, &key, &i, NULL) == DS_OK);
+  }
+
+  int expected = 0;
+  for (void *iter = table_iter_begin(&table); iter; iter = table_iter_next(&table, iter), expected++) {
+    assert(*(int const *)table_iter_key(&table, iter) == (int)(((unsigned)expected * 7919u) % SIZE));
+    assert(*(int *)table_iter_value(&table, iter) == expected);
+  }
+  assert(expected == SIZE);
+
+  // removing keeps the order of the rest, and reinserting a key appends it. the removed records are compacted away
+  // by the following insertions
+  for (int i = 0; i < SIZE; i++) {
+    if (i % 3) assert(table_remove(&table, &i, NULL) == DS_OK);
+  }
+  assert(table_remove(&table, &(int){0}, NULL) == DS_OK);
+  assert(table_put(&table, &(int){0}, &(int){SIZE}, NULL) == DS_OK);
+  for (int i = SIZE; i < SIZE * 2; i++) { assert(table_put(&table, &i, &(int){i + 1}, NULL) == DS_OK); }
+  assert(table_size(&table) == (SIZE - 1) / 3 + 1 + SIZE);
+
+  int prev = -1;
+  size_t visited = 0;
+  for (void *iter = table_iter_begin(&table); iter; iter = table_iter_next(&table, iter), visited++) {
+    int key = *(int const *)table_iter_key(&table, iter);
+    int value = *(int *)table_iter_value(&table, iter);
+    assert(key % 3 == 0 || key >= SIZE);
+    assert(value > prev);  // the values were assigned in insertion order
+    assert(key != 0 || value == SIZE);
+    prev = value;
+  }
+  assert(visited == table_size(&table));
+
+  for (int i = 0; i < SIZE * 2; i++) {
+    int value = -1;
+    assert(table_get(&table, &i, &value) == (i % 3 == 0 || i >= SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+  }
+
+  table_destroy(&table);
+
+  // a max load factor of 1 would leave no empty slot to end the probe sequences
+  options.max_load_factor = 1;
+  assert(!table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options)._entries._data);
+}
+
+/* every key k < KEYS is put k % 4 + 1 times, with the values k * 100 + 0, 1, ... */
+static void table_multimap_test(bool incremental) {
+  enum local_size {
+    KEYS = 1000,
+  };
+
+  struct table_options options = {.incremental_resize = incremental, .multimap = true};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  size_t pairs = 0;
+  for (int round = 0; round < 4; round++) {
+    for (int k = 0; k < KEYS; k++) {
+      if (k % 4 < round) continue;
+
+      int old = -1;
+      assert(table_put(&table, &k, &(int){k * 100 + round}, &old) == DS_OK);
+      assert(old == -1);  // a multimap never replaces a value
+      pairs++;
+    }
+  }
+  assert(table_size(&table) == pairs);
+
+  for (int k = 0; k < KEYS; k++) {
+    assert(table_count(&table, &k) == (size_t)(k % 4 + 1));
+
+    // every value of the key, each exactly once
+    struct table_range range;
+    size_t count = table_get_all(&table, &k, &range);
+    unsigned seen = 0;
+    for (void *it = table_range_next(&range); it; it = table_range_next(&range), count--) {
+      assert(*(int const *)table_iter_key(&table, it) == k);
+      int value = *(int *)table_iter_value(&table, it);
+      assert(value / 100 == k && !(seen & 1u << value % 100));
+      seen |= 1u << value % 100;
+    }
+    assert(count == 0);
+    assert(seen == (1u << (k % 4 + 1)) - 1);
+  }
+
+  int missing = KEYS;
+  struct table_range range;
+  assert(table_get_all(&table, &missing, &range) == 0 && table_range_next(&range) == NULL);
+  assert(table_count(&table, &missing) == 0);
+
+  // removing a single pair, then all of them
+  for (int k = 0; k < KEYS; k += 2) {
+    assert(table_remove(&table, &k, NULL) == DS_OK);
+    assert(table_count(&table, &k) == (size_t)(k % 4));
+  }
+  for (int k = 0; k < KEYS; k += 4) {
+    assert(table_remove_all(&table, &k) == 0);  // k % 4 == 0 had a single pair
+    assert(table_remove_all(&table, &(int){k + 1}) == 2);
+    assert(table_remove_all(&table, &(int){k + 2}) == 2);
+  }
+  for (int k = 0; k < KEYS; k++) { assert(table_count(&table, &k) == (k % 4 == 3 ? 4 : 0)); }
+  assert(table_size(&table) == KEYS);
+
+  // a multimap can't be frozen, and only the chained engine may be one
+  assert(table_freeze(&table) == DS_ERROR);
+  table_destroy(&table);
+
+  options.engine = TABLE_OPEN_ADDRESSING;
+  table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+  assert(table_put(&table, &missing, &missing, NULL) == DS_ERROR);
+
+  // a regular table has a single pair per key
+  table = table_create(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL);
+  assert(table_put(&table, &missing, &missing, NULL) == DS_OK);
+  assert(table_put(&table, &missing, &missing, NULL) == DS_OK);
+  assert(table_count(&table, &missing) == 1);
+  assert(table_remove_all(&table, &missing) == 1 && table_empty(&table));
+  table_destroy(&table);
+}
+
+/* the values of `table_from_arrays_test` are distinct indices. every value is destroyed at most once, hence marking
+ * it needs no synchronization even when the table is built on several threads */
+static bool from_arrays_destroyed[20000];
+
+static void count_destroyed(void *value) {
+  from_arrays_destroyed[*(int *)value] = true;
+}
+
+static size_t destroyed_count(void) {
+  size_t count = 0;
+  for (size_t i = 0; i < sizeof from_arrays_destroyed / sizeof *from_arrays_destroyed; i++) {
+    count += from_arrays_destroyed[i];
+  }
+  return count;
+}
+
+static void table_from_arrays_test(enum table_engine engine, size_t threads) {
+  enum local_size {
+    SIZE = 20000,
+    DISTINCT = 15000,
+  };
+
+  // the last `SIZE - DISTINCT` keys repeat earlier ones, whose values they replace
+  int *keys = malloc(SIZE * sizeof *keys);
+  int *values = malloc(SIZE * sizeof *values);
+  for (int i = 0; i < SIZE; i++) {
+    keys[i] = (i % DISTINCT) * 3;
+    values[i] = i;
+  }
+
+  memset(from_arrays_destroyed, 0, sizeof from_arrays_destroyed);
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_from_arrays(keys, values, SIZE, sizeof(int), sizeof(int), int_cmpr, NULL, NULL,
+                                              count_destroyed, &options, threads);
+  assert(table_size(&table) == DISTINCT);
+  assert(destroyed_count() == SIZE - DISTINCT);
+  assert(table_capacity(&table) >= SIZE);  // sized once for all the pairs
+
+  for (int k = 0; k < DISTINCT; k++) {
+    int value = -1;
+    assert(table_get(&table, &(int){k * 3}, &value) == DS_VALUE_OK);
+    assert(value == (k < SIZE - DISTINCT ? k + DISTINCT : k));
+    assert(!table_contains(&table, &(int){k * 3 + 1}));
+  }
+
+  // the nodes of the slab are unlinked, not freed. the nodes put afterwards are on their own, and grow the table
+  for (int k = 0; k < DISTINCT; k += 2) { assert(table_remove(&table, &(int){k * 3}, NULL) == DS_OK); }
+  for (int k = 0; k < DISTINCT; k++) { assert(table_put(&table, &(int){k * 3 + 1}, &k, NULL) == DS_OK); }
+  assert(table_size(&table) == DISTINCT / 2 + DISTINCT);
+  for (int k = 0; k < DISTINCT; k++) { assert(table_contains(&table, &(int){k * 3}) == (k % 2 == 1)); }
+
+  // the slab is released by the table it was frozen into
+  assert(table_freeze(&table) == DS_OK);
+  for (int k = 0; k < DISTINCT; k++) { assert(table_contains(&table, &(int){k * 3 + 1})); }
+  table_destroy(&table);
+
+  if (engine == TABLE_CHAINED) {
+    // a multimap keeps every pair
+    options.multimap = true;
+    table = table_from_arrays(keys, values, SIZE, sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options,
+                              threads);
+    assert(table_size(&table) == SIZE);
+    for (int k = 0; k < DISTINCT; k++) {
+      assert(table_count(&table, &(int){k * 3}) == (k < SIZE - DISTINCT ? 2u : 1u));
+    }
+    table_destroy(&table);
+  }
+
+  // an empty table
+  table = table_from_arrays(keys, values, 0, sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options, threads);
+  assert(vec_data(&table._entries) && table_empty(&table));
+  assert(table_put(&table, &keys[0], &values[0], NULL) == DS_OK);
+  table_destroy(&table);
+
+  free(keys);
+  free(values);
+}
+
+static void table_filter_test(enum table_engine engine, enum table_filter_kind kind) {
+  enum local_size {
+    SIZE = 10000,
+  };
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+
+  // the filter is built out of the keys the table already holds, and grows along with the table
+  for (int i = 0; i < SIZE / 10; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(table_attach_filter(&table, kind) == DS_OK);
+  for (int i = SIZE / 10; i < SIZE; i++) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+
+  for (int i = 0; i < SIZE * 2; i++) {
+    int value = -1;
+    assert(table_get(&table, &i, &value) == (i < SIZE ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i >= SIZE || value == i);
+  }
+
+  // removed keys are missing, whether the filter forgets them or not. keys put back are found again
+  for (int i = 0; i < SIZE; i += 2) { assert(table_remove(&table, &i, NULL) == DS_OK); }
+  for (int i = 0; i < SIZE; i++) { assert(table_contains(&table, &i) == (i % 2 == 1)); }
+  for (int i = 0; i < SIZE; i += 4) { assert(table_put(&table, &i, &i, NULL) == DS_OK); }
+  for (int i = 0; i < SIZE; i++) { assert(table_contains(&table, &i) == (i % 2 == 1 || i % 4 == 0)); }
+
+  // the filter is carried over into a frozen table
+  assert(table_freeze(&table) == DS_OK);
+  for (int i = 0; i < SIZE * 2; i++) { assert(table_contains(&table, &i) == (i < SIZE && (i % 2 == 1 || i % 4 == 0))); }
+
+  assert(table_attach_filter(&table, TABLE_FILTER_NONE) == DS_OK);
+  assert(table_contains(&table, &(int){1}));
+  assert(table_attach_filter(&table, (enum table_filter_kind)42) == DS_ERROR);
+  assert(table_attach_filter(NULL, kind) == DS_ERROR);
+  table_destroy(&table);
+
+  if (engine == TABLE_CHAINED) {
+    // building the filter leaves an incremental resize in progress, while accounting for the keys of both entries
+    options.incremental_resize = true;
+    table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+    int count = 0;
+    while (!table_rehashing(&table) || table_rehash_pending(&table) < 16) {
+      assert(table_put(&table, &count, &count, NULL) == DS_OK);
+      count++;
+    }
+    assert(table_attach_filter(&table, kind) == DS_OK);
+    assert(table_rehashing(&table));
+    for (int i = 0; i < count * 2; i++) { assert(table_contains(&table, &i) == (i < count)); }
+    table_destroy(&table);
+    options.incremental_resize = false;
+
+    // every pair of a multimap key is accounted for
+    options.multimap = true;
+    table = table_create_ex(sizeof(int), sizeof(int), int_cmpr, NULL, NULL, NULL, &options);
+    assert(table_attach_filter(&table, kind) == DS_OK);
+    for (int i = 0; i < SIZE; i++) { assert(table_put(&table, &(int){i % 100}, &i, NULL) == DS_OK); }
+    assert(table_remove(&table, &(int){7}, NULL) == DS_OK);
+    assert(table_count(&table, &(int){7}) == SIZE / 100 - 1);
+    assert(table_remove_all(&table, &(int){8}) == SIZE / 100);
+    assert(!table_contains(&table, &(int){8}));
+    assert(table_count(&table, &(int){9}) == SIZE / 100);
+    table_destroy(&table);
+  }
+}
+
+static int u64_cmpr(void const *left, void const *right) {
+  uint64_t const *_left = left;
+  uint64_t const *_right = right;
+  return (*_left > *_right) - (*_left < *_right);
+}
+
+/* the engines which keep their records in an array pack them at their natural alignment. `record_size` is the size
+ * of a `uint64_t -> uint64_t` record */
+static void table_layout_test(enum table_engine engine, size_t record_size) {
+  enum local_size {
+    SIZE = 1000,
+  };
+
+  struct table_options options = {.engine = engine};
+  struct hash_table table = table_create_ex(sizeof(uint64_t), sizeof(uint64_t), u64_cmpr, NULL, NULL, NULL, &options);
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint64_t value = i * 3;
+    assert(table_put(&table, &i, &value, NULL) == DS_OK);
+  }
+
+  struct vec const *records = engine == TABLE_OPEN_ADDRESSING ? &table._entries : &table._records;
+  assert(records->_data_size == record_size);
+
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint64_t *value = table_get_ref(&table, &i);
+    assert(value && *value == i * 3);
+  }
+  table_destroy(&table);
+
+  // a narrower key is followed by padding up to the alignment of its value, not to the strictest alignment
+  table = table_create_ex(sizeof(uint32_t), sizeof(uint64_t), int_cmpr, NULL, NULL, NULL, &options);
+  records = engine == TABLE_OPEN_ADDRESSING ? &table._entries : &table._records;
+  assert(records->_data_size == record_size);
+  assert(table._value_offset % sizeof(uint64_t) == 0);
+  table_destroy(&table);
+}
+
 int main(void) {
   srand(time(NULL));
 
@@ -204,4 +1266,61 @@ int main(void) {
   table_remove_test();
   table_get_test();
   table_contains_test();
+  table_open_addressing_test();
+  table_open_addressing_destructors_test();
+  table_resize_without_rehash_test();
+  table_incremental_resize_test();
+  table_seed_test();
+  table_in_place_test(TABLE_CHAINED);
+  table_in_place_test(TABLE_OPEN_ADDRESSING);
+  table_batch_test(TABLE_CHAINED);
+  table_batch_test(TABLE_OPEN_ADDRESSING);
+  table_capacity_policy_test(TABLE_CHAINED, false);
+  table_capacity_policy_test(TABLE_CHAINED, true);
+  table_capacity_policy_test(TABLE_OPEN_ADDRESSING, false);
+  table_capacity_policy_test(TABLE_DENSE, false);
+  table_in_place_test(TABLE_DENSE);
+  table_batch_test(TABLE_DENSE);
+  table_iteration_test(TABLE_CHAINED, false);
+  table_iteration_test(TABLE_CHAINED, true);
+  table_iteration_test(TABLE_OPEN_ADDRESSING, false);
+  table_iteration_test(TABLE_DENSE, false);
+  table_dense_destructors_test();
+  table_freeze_test(TABLE_CHAINED);
+  table_freeze_test(TABLE_OPEN_ADDRESSING);
+  table_freeze_test(TABLE_DENSE);
+#ifdef HAS_SNAPSHOTS
+  table_snapshot_test(TABLE_CHAINED, NULL);
+  table_snapshot_test(TABLE_OPEN_ADDRESSING, int_hash);
+  table_snapshot_test(TABLE_DENSE, NULL);
+#endif
+  table_stats_test(TABLE_CHAINED);
+  table_stats_test(TABLE_OPEN_ADDRESSING);
+  table_stats_test(TABLE_DENSE);
+  table_prehashed_test();
+  table_in_place_test(TABLE_ORDERED);
+  table_batch_test(TABLE_ORDERED);
+  table_capacity_policy_test(TABLE_ORDERED, false);
+  table_iteration_test(TABLE_ORDERED, false);
+  table_freeze_test(TABLE_ORDERED);
+#ifdef HAS_SNAPSHOTS
+  table_snapshot_test(TABLE_ORDERED, int_hash);
+#endif
+  table_stats_test(TABLE_ORDERED);
+  table_ordered_test();
+  table_multimap_test(false);
+  table_multimap_test(true);
+  table_from_arrays_test(TABLE_CHAINED, 1);
+  table_from_arrays_test(TABLE_CHAINED, 4);
+  table_from_arrays_test(TABLE_CHAINED, 6);
+  table_from_arrays_test(TABLE_OPEN_ADDRESSING, 1);
+  table_from_arrays_test(TABLE_DENSE, 4);
+  table_filter_test(TABLE_CHAINED, TABLE_FILTER_BLOOM);
+  table_filter_test(TABLE_CHAINED, TABLE_FILTER_CUCKOO);
+  table_filter_test(TABLE_OPEN_ADDRESSING, TABLE_FILTER_CUCKOO);
+  table_filter_test(TABLE_DENSE, TABLE_FILTER_BLOOM);
+  table_filter_test(TABLE_ORDERED, TABLE_FILTER_CUCKOO);
+  table_layout_test(TABLE_OPEN_ADDRESSING, 2 * sizeof(uint64_t));
+  table_layout_test(TABLE_DENSE, 4 * sizeof(uint64_t));
+  table_layout_test(TABLE_ORDERED, 3 * sizeof(uint64_t));
 }
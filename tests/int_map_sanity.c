@@ -0,0 +1,122 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "int_map.h"
+
+#define SIZE 10000
+
+static void int_map_basic_test(void) {
+  struct int_map map = int_map_create(sizeof(uint32_t), UINT64_MAX);
+  assert(int_map_size(&map) == 0);
+
+  for (uint64_t i = 0; i < SIZE; i++) { assert(int_map_put(&map, i, &(uint32_t){(uint32_t)i * 3}, NULL) == DS_OK); }
+  assert(int_map_size(&map) == SIZE);
+
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint32_t value = 0;
+    assert(int_map_get(&map, i, &value) == DS_VALUE_OK);
+    assert(value == i * 3);
+  }
+
+  uint32_t old = 0;
+  assert(int_map_put(&map, 5, &(uint32_t){1}, &old) == DS_VALUE_OK);
+  assert(old == 15);
+  assert(*(uint32_t *)int_map_get_ref(&map, 5) == 1);
+  assert(int_map_put(&map, 5, &(uint32_t){15}, NULL) == DS_OK);
+  assert(int_map_size(&map) == SIZE);
+
+  // the sentinel is never a key
+  assert(int_map_put(&map, UINT64_MAX, &old, NULL) == DS_ERROR);
+  assert(!int_map_contains(&map, UINT64_MAX));
+  assert(int_map_get(&map, UINT64_MAX, &old) == DS_NOT_FOUND);
+  assert(int_map_remove(&map, UINT64_MAX, NULL) == DS_NOT_FOUND);
+
+  assert(!int_map_contains(&map, SIZE));
+  assert(int_map_get_ref(&map, SIZE) == NULL);
+  assert(int_map_remove(&map, SIZE, NULL) == DS_NOT_FOUND);
+
+  // removing every third key shifts the clusters back. the rest must remain reachable
+  for (uint64_t i = 0; i < SIZE; i += 3) {
+    assert(int_map_remove(&map, i, &old) == DS_VALUE_OK);
+    assert(old == i * 3);
+  }
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint32_t value = 0;
+    assert(int_map_get(&map, i, &value) == (i % 3 ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(i % 3 == 0 || value == i * 3);
+  }
+  assert(int_map_size(&map) == SIZE - (SIZE + 2) / 3);
+
+  assert(int_map_reserve(&map, SIZE * 4) >= SIZE * 4);
+  for (uint64_t i = 0; i < SIZE; i++) { assert(int_map_contains(&map, i) == (i % 3 != 0)); }
+
+  int_map_destroy(&map);
+  assert(int_map_put(&map, 1, &old, NULL) == DS_ERROR);
+}
+
+static void sum_keys(uint64_t key, void *value, void *context) {
+  assert(value == NULL);
+  *(uint64_t *)context += key;
+}
+
+/* a map of empty values is a set of integers. the keys are large and spread, and the sentinel is `0` */
+static void int_map_set_test(void) {
+  struct int_map set = int_map_create(0, 0);
+
+  uint64_t expected = 0;
+  for (uint64_t i = 1; i <= SIZE; i++) {
+    assert(int_map_put(&set, i << 40, NULL, NULL) == DS_OK);
+    expected += i << 40;
+  }
+  assert(int_map_put(&set, 1ull << 40, NULL, NULL) == DS_OK);
+  assert(int_map_put(&set, 1ull << 40, NULL, &(char){0}) == DS_VALUE_OK);
+  assert(int_map_size(&set) == SIZE);
+  assert(int_map_put(&set, 0, NULL, NULL) == DS_ERROR);
+
+  uint64_t sum = 0;
+  int_map_for_each(&set, sum_keys, &sum);
+  assert(sum == expected);
+
+  int_map_destroy(&set);
+}
+
+/* random puts and removes over a small range of keys, checked against a plain array */
+static void int_map_churn_test(void) {
+  struct int_map map = int_map_create(sizeof(uint64_t), UINT64_MAX);
+  bool present[SIZE / 10] = {0};
+
+  uint64_t state = 88172645463325252ull;
+  for (size_t op = 0; op < SIZE * 20; op++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    uint64_t key = state % (SIZE / 10);
+    if (state >> 62) {
+      assert(int_map_put(&map, key, &key, NULL) == DS_OK);
+      present[key] = true;
+    } else {
+      assert(int_map_remove(&map, key, NULL) == (present[key] ? DS_OK : DS_NOT_FOUND));
+      present[key] = false;
+    }
+  }
+
+  size_t expected = 0;
+  for (uint64_t key = 0; key < SIZE / 10; key++) {
+    uint64_t value = 0;
+    assert(int_map_get(&map, key, &value) == (present[key] ? DS_VALUE_OK : DS_NOT_FOUND));
+    assert(!present[key] || value == key);
+    expected += present[key];
+  }
+  assert(int_map_size(&map) == expected);
+
+  int_map_destroy(&map);
+}
+
+int main(void) {
+  int_map_basic_test();
+  int_map_set_test();
+  int_map_churn_test();
+}
@@ -522,6 +522,50 @@ static void list_iterator_test(struct ascii_str *strings, size_t size) {
   after(&list);
 }
 
+static void list_node_test(void) {
+  enum { COUNT = 100 };
+  struct list list = list_create(sizeof(int), NULL);
+  assert(list_first_node(&list) == -1 && list_last_node(&list) == -1);
+
+  intmax_t nodes[COUNT];
+  for (int i = 0; i < COUNT; i++) {
+    nodes[i] = list_prepend_node(&list, &i);
+    assert(nodes[i] >= 0);
+  }
+  assert(list_size(&list) == COUNT);
+  assert(list_first_node(&list) == nodes[COUNT - 1] && list_last_node(&list) == nodes[0]);
+  assert(list_prev_node(&list, nodes[0]) == nodes[1]);
+
+  // the nodes are stable while the list grows
+  for (int i = 0; i < COUNT; i++) { assert(*(int *)list_node_data(&list, nodes[i]) == i); }
+
+  assert(list_move_first(&list, nodes[0]));
+  assert(list_first_node(&list) == nodes[0] && list_last_node(&list) == nodes[1]);
+  assert(*(int *)list_peek_first(&list) == 0);
+
+  assert(list_move_first(&list, nodes[50]));
+  assert(*(int *)list_at(&list, 0) == 50 && *(int *)list_at(&list, 1) == 0);
+
+  int *removed = list_remove_node(&list, nodes[50]);
+  assert(removed && *removed == 50);
+  free(removed);
+  assert(list_node_data(&list, nodes[50]) == NULL);
+  assert(list_remove_node(&list, nodes[50]) == NULL);
+  assert(list_size(&list) == COUNT - 1);
+  assert(*(int *)list_peek_first(&list) == 0);
+
+  intmax_t node = list_prepend_node(&list, &(int){COUNT});
+  assert(node >= 0 && *(int *)list_node_data(&list, node) == COUNT);
+
+  for (node = list_last_node(&list); node >= 0; node = list_last_node(&list)) {
+    free(list_remove_node(&list, node));
+  }
+  assert(list_empty(&list));
+  assert(list_first_node(&list) == -1);
+
+  list_destroy(&list);
+}
+
 int main(void) {
   enum local_sizes {
     SMALL = 2,
@@ -588,4 +632,6 @@ int main(void) {
 
   list_iterator_test(strings_large, LARGE);
   list_iterator_test(strings_small, SMALL);
+
+  list_node_test();
 }
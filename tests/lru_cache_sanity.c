@@ -0,0 +1,200 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lru_cache.h"
+
+static int cmpr(void const *left, void const *right) {
+  size_t const *l = left;
+  size_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+struct evictions {
+  size_t count;
+  size_t last_key;
+};
+
+static void count_eviction(void const *key, void *value, void *context) {
+  struct evictions *evictions = context;
+  assert(*(size_t const *)key * 10 == *(size_t *)value);
+
+  evictions->count++;
+  evictions->last_key = *(size_t const *)key;
+}
+
+static void lru_cache_lru_test(void) {
+  struct evictions evictions = {0};
+  struct cache_options options = {.context = &evictions, .on_evict = count_eviction};
+  struct lru_cache cache = lru_cache_create(4, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, &options);
+
+  for (size_t i = 0; i < 4; i++) { assert(lru_cache_put(&cache, &i, &(size_t){i * 10}, NULL) == DS_OK); }
+  assert(lru_cache_size(&cache) == 4);
+  assert(evictions.count == 0);
+
+  // 0 becomes the most recently used, hence 1 is evicted first
+  size_t value = 0;
+  assert(lru_cache_get(&cache, &(size_t){0}, &value) == DS_VALUE_OK && value == 0);
+  assert(lru_cache_put(&cache, &(size_t){4}, &(size_t){40}, NULL) == DS_OK);
+  assert(evictions.count == 1 && evictions.last_key == 1);
+  assert(!lru_cache_contains(&cache, &(size_t){1}));
+  assert(lru_cache_size(&cache) == 4);
+
+  // replacing a value refreshes its entry as well
+  size_t old = 0;
+  assert(lru_cache_put(&cache, &(size_t){2}, &(size_t){20}, &old) == DS_VALUE_OK && old == 20);
+  assert(lru_cache_put(&cache, &(size_t){5}, &(size_t){50}, NULL) == DS_OK);
+  assert(evictions.last_key == 3);
+
+  // contains doesn't touch the recency of an entry
+  assert(lru_cache_contains(&cache, &(size_t){0}));
+  assert(lru_cache_put(&cache, &(size_t){6}, &(size_t){60}, NULL) == DS_OK);
+  assert(evictions.last_key == 0);
+
+  // an explicit removal isn't an eviction
+  assert(lru_cache_remove(&cache, &(size_t){4}, &old) == DS_VALUE_OK && old == 40);
+  assert(lru_cache_remove(&cache, &(size_t){4}, NULL) == DS_NOT_FOUND);
+  assert(evictions.count == 3);
+  assert(lru_cache_size(&cache) == 3);
+
+  lru_cache_destroy(&cache);
+  assert(evictions.count == 3);
+}
+
+static void lru_cache_clock_test(void) {
+  struct evictions evictions = {0};
+  struct cache_options options = {.context = &evictions, .on_evict = count_eviction, .policy = CACHE_CLOCK};
+  struct lru_cache cache = lru_cache_create(4, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, &options);
+
+  for (size_t i = 0; i < 4; i++) { assert(lru_cache_put(&cache, &i, &(size_t){i * 10}, NULL) == DS_OK); }
+
+  // 0 and 1 are referenced, they get a second chance
+  size_t value = 0;
+  assert(lru_cache_get(&cache, &(size_t){0}, &value) == DS_VALUE_OK);
+  assert(lru_cache_get(&cache, &(size_t){1}, &value) == DS_VALUE_OK);
+  assert(lru_cache_put(&cache, &(size_t){4}, &(size_t){40}, NULL) == DS_OK);
+  assert(evictions.last_key == 2);
+  assert(lru_cache_put(&cache, &(size_t){5}, &(size_t){50}, NULL) == DS_OK);
+  assert(evictions.last_key == 3);
+
+  // their second chance is used up
+  assert(lru_cache_put(&cache, &(size_t){6}, &(size_t){60}, NULL) == DS_OK);
+  assert(evictions.last_key == 0);
+  assert(lru_cache_put(&cache, &(size_t){7}, &(size_t){70}, NULL) == DS_OK);
+  assert(evictions.last_key == 1);
+
+  // once every entry is referenced, eviction goes around and falls back to the oldest entry
+  for (size_t i = 4; i < 8; i++) { assert(lru_cache_get(&cache, &i, &value) == DS_VALUE_OK); }
+  assert(lru_cache_put(&cache, &(size_t){8}, &(size_t){80}, NULL) == DS_OK);
+  assert(evictions.last_key == 4);
+  assert(evictions.count == 5);
+
+  lru_cache_destroy(&cache);
+}
+
+/* the weight of an entry is the length of its string value */
+static size_t weigh_string(void const *key, void const *value) {
+  (void)key;
+  return strlen(*(char *const *)value) + 1;
+}
+
+static void free_string(void *value) {
+  free(*(char **)value);
+}
+
+static char *string_of(size_t length) {
+  char *string = malloc(length + 1);
+  assert(string);
+  memset(string, 'x', length);
+  string[length] = '\0';
+  return string;
+}
+
+static void lru_cache_weight_test(void) {
+  struct cache_options options = {.weigh = weigh_string};
+  struct lru_cache cache =
+      lru_cache_create(100, sizeof(size_t), sizeof(char *), cmpr, NULL, NULL, free_string, &options);
+
+  for (size_t i = 0; i < 10; i++) { assert(lru_cache_put(&cache, &i, &(char *){string_of(9)}, NULL) == DS_OK); }
+  assert(lru_cache_weight(&cache) == 100);
+  assert(lru_cache_size(&cache) == 10);
+
+  // a heavy entry pushes out as many of the oldest entries as it needs
+  assert(lru_cache_put(&cache, &(size_t){10}, &(char *){string_of(29)}, NULL) == DS_OK);
+  assert(lru_cache_weight(&cache) == 100);
+  assert(lru_cache_size(&cache) == 8);
+  assert(!lru_cache_contains(&cache, &(size_t){0}) && !lru_cache_contains(&cache, &(size_t){2}));
+  assert(lru_cache_contains(&cache, &(size_t){3}));
+
+  // growing an existing value evicts others, never the value itself
+  assert(lru_cache_put(&cache, &(size_t){3}, &(char *){string_of(59)}, NULL) == DS_OK);
+  assert(lru_cache_contains(&cache, &(size_t){3}) && lru_cache_contains(&cache, &(size_t){10}));
+  assert(lru_cache_weight(&cache) <= 100);
+  assert(lru_cache_size(&cache) == 3);
+
+  // an entry heavier than the whole cache is refused
+  char *huge = string_of(100);
+  assert(lru_cache_put(&cache, &(size_t){11}, &huge, NULL) == DS_ERROR);
+  free(huge);
+
+  lru_cache_destroy(&cache);
+}
+
+/* the weight of an entry is its value */
+static size_t weigh_value(void const *key, void const *value) {
+  (void)key;
+  return *(size_t const *)value;
+}
+
+static void lru_cache_clock_weight_test(void) {
+  struct cache_options options = {.policy = CACHE_CLOCK, .weigh = weigh_value};
+  struct lru_cache cache = lru_cache_create(10, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, &options);
+
+  assert(lru_cache_put(&cache, &(size_t){1}, &(size_t){3}, NULL) == DS_OK);
+  assert(lru_cache_put(&cache, &(size_t){2}, &(size_t){3}, NULL) == DS_OK);
+
+  size_t value = 0;
+  assert(lru_cache_get(&cache, &(size_t){1}, &value) == DS_VALUE_OK);
+  assert(lru_cache_get(&cache, &(size_t){2}, &value) == DS_VALUE_OK);
+
+  // growing an existing value evicts others, never the value itself, even once the clock hand comes around to it
+  assert(lru_cache_put(&cache, &(size_t){1}, &(size_t){8}, NULL) == DS_OK);
+  assert(lru_cache_contains(&cache, &(size_t){1}) && !lru_cache_contains(&cache, &(size_t){2}));
+  assert(lru_cache_weight(&cache) == 8);
+
+  // neither is a new entry evicted to make room for itself
+  assert(lru_cache_put(&cache, &(size_t){3}, &(size_t){9}, NULL) == DS_OK);
+  assert(lru_cache_contains(&cache, &(size_t){3}) && !lru_cache_contains(&cache, &(size_t){1}));
+  assert(lru_cache_weight(&cache) == 9);
+
+  lru_cache_destroy(&cache);
+}
+
+/* a larger workload. the list's pool of nodes grows and recycles nodes */
+static void lru_cache_churn_test(void) {
+  struct lru_cache cache = lru_cache_create(100, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, NULL);
+
+  for (size_t i = 0; i < 10000; i++) {
+    assert(lru_cache_put(&cache, &i, &i, NULL) == DS_OK);
+    if (i % 3 == 0) assert(lru_cache_remove(&cache, &(size_t){i / 2}, NULL) != DS_ERROR);
+  }
+  assert(lru_cache_size(&cache) <= 100);
+
+  for (size_t i = 9900; i < 10000; i++) {
+    size_t value = 0;
+    if (lru_cache_get(&cache, &i, &value) == DS_VALUE_OK) assert(value == i);
+  }
+  assert(lru_cache_contains(&cache, &(size_t){9999}));
+
+  lru_cache_destroy(&cache);
+}
+
+int main(void) {
+  lru_cache_lru_test();
+  lru_cache_clock_test();
+  lru_cache_weight_test();
+  lru_cache_clock_weight_test();
+  lru_cache_churn_test();
+}
@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sharded_table.h"
+
+#define THREADS 8
+#define KEYS_PER_THREAD 4096
+#define TOTAL_KEYS (THREADS * KEYS_PER_THREAD)
+
+static int cmpr(void const *left, void const *right) {
+  size_t const *l = left;
+  size_t const *r = right;
+  return (*l > *r) - (*l < *r);
+}
+
+static void sharded_table_sequential_test(void) {
+  struct sharded_table table =
+      sharded_table_create(4, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, NULL);
+  assert(sharded_table_size(&table) == 0);
+
+  for (size_t i = 0; i < 1000; i++) { assert(sharded_table_put(&table, &i, &i, NULL) == DS_OK); }
+  assert(sharded_table_size(&table) == 1000);
+
+  size_t key = 10;
+  size_t value = 20;
+  size_t old = 0;
+  assert(sharded_table_put(&table, &key, &value, &old) == DS_VALUE_OK);
+  assert(old == 10);
+
+  assert(sharded_table_get(&table, &key, &old) == DS_VALUE_OK);
+  assert(old == 20);
+
+  assert(sharded_table_remove(&table, &key, &old) == DS_VALUE_OK);
+  assert(old == 20);
+  assert(!sharded_table_contains(&table, &key));
+  assert(sharded_table_remove(&table, &key, NULL) == DS_NOT_FOUND);
+  assert(sharded_table_size(&table) == 999);
+
+  for (size_t i = 0; i < 1000; i++) { assert(sharded_table_contains(&table, &i) == (i != 10)); }
+
+  sharded_table_destroy(&table);
+
+  // the number of shards must be a power of 2. `0` picks one
+  table = sharded_table_create(3, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, NULL);
+  assert(sharded_table_put(&table, &key, &value, NULL) == DS_ERROR);
+  table = sharded_table_create(0, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, NULL);
+  assert(sharded_table_put(&table, &key, &value, NULL) == DS_OK);
+  sharded_table_destroy(&table);
+}
+
+struct worker_args {
+  struct sharded_table *table;
+  size_t id;
+};
+
+/* each thread ingests its own range of keys, half one by one and half as a batch */
+static void *ingest(void *arg) {
+  struct worker_args *args = arg;
+  size_t first = args->id * KEYS_PER_THREAD;
+
+  for (size_t i = first; i < first + KEYS_PER_THREAD / 2; i++) {
+    assert(sharded_table_put(args->table, &i, &(size_t){i * 2}, NULL) == DS_OK);
+  }
+
+  size_t keys[KEYS_PER_THREAD / 2];
+  size_t values[KEYS_PER_THREAD / 2];
+  enum ds_error status[KEYS_PER_THREAD / 2];
+  for (size_t i = 0; i < KEYS_PER_THREAD / 2; i++) {
+    keys[i] = first + KEYS_PER_THREAD / 2 + i;
+    values[i] = keys[i] * 2;
+  }
+
+  size_t count = KEYS_PER_THREAD / 2;
+  assert(sharded_table_put_many(args->table, keys, values, count, status) == count);
+  for (size_t i = 0; i < count; i++) { assert(status[i] == DS_OK); }
+
+  // the batch replaces existing values as well
+  assert(sharded_table_put_many(args->table, keys, values, count, status) == 0);
+  for (size_t i = 0; i < count; i++) { assert(status[i] == DS_VALUE_OK); }
+
+  for (size_t i = first; i < first + KEYS_PER_THREAD; i++) {
+    size_t value = 0;
+    assert(sharded_table_get(args->table, &i, &value) == DS_VALUE_OK);
+    assert(value == i * 2);
+  }
+
+  return NULL;
+}
+
+static void sum_keys(void const *key, void *value, void *context) {
+  size_t const *k = key;
+  size_t *v = value;
+  assert(*v == *k * 2);
+
+  *v = *k;  // the visiting thread holds its shard's lock, values may be modified
+  __atomic_fetch_add((size_t *)context, *k, __ATOMIC_RELAXED);
+}
+
+static void sharded_table_parallel_test(void) {
+  struct table_options options = {.engine = TABLE_DENSE};
+  struct sharded_table table =
+      sharded_table_create(16, sizeof(size_t), sizeof(size_t), cmpr, NULL, NULL, NULL, &options);
+
+  pthread_t threads[THREADS];
+  struct worker_args args[THREADS];
+  for (size_t i = 0; i < THREADS; i++) {
+    args[i] = (struct worker_args){.table = &table, .id = i};
+    assert(pthread_create(&threads[i], NULL, ingest, &args[i]) == 0);
+  }
+  for (size_t i = 0; i < THREADS; i++) { pthread_join(threads[i], NULL); }
+
+  assert(sharded_table_size(&table) == TOTAL_KEYS);
+
+  size_t sum = 0;
+  assert(sharded_table_for_each(&table, sum_keys, &sum) == DS_OK);
+  assert(sum == (size_t)TOTAL_KEYS * (TOTAL_KEYS - 1) / 2);
+
+  for (size_t i = 0; i < TOTAL_KEYS; i++) {
+    size_t value = 0;
+    assert(sharded_table_get(&table, &i, &value) == DS_VALUE_OK);
+    assert(value == i);
+  }
+
+  sharded_table_destroy(&table);
+}
+
+int main(void) {
+  sharded_table_sequential_test();
+  sharded_table_parallel_test();
+}
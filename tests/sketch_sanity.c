@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sketch.h"
+
+#define SIZE 100000
+
+static void hyperloglog_test(void) {
+  struct hyperloglog hll = hyperloglog_create(0, 42);
+  assert(hyperloglog_estimate(&hll) == 0);
+
+  // repeated keys don't count
+  for (int round = 0; round < 3; round++) {
+    for (uint64_t i = 0; i < SIZE; i++) { assert(hyperloglog_add(&hll, &i, sizeof i) == DS_OK); }
+  }
+  assert(fabs(hyperloglog_estimate(&hll) - SIZE) < SIZE * 0.05);
+
+  // small cardinalities are estimated almost exactly
+  struct hyperloglog small = hyperloglog_create(0, 42);
+  for (uint64_t i = 0; i < 100; i++) { assert(hyperloglog_add(&small, &i, sizeof i) == DS_OK); }
+  assert(fabs(hyperloglog_estimate(&small) - 100) < 3);
+
+  // per thread sketches of overlapping streams merge into the sketch of their union
+  struct hyperloglog other = hyperloglog_create(0, 42);
+  for (uint64_t i = SIZE / 2; i < SIZE * 2; i++) { assert(hyperloglog_add(&other, &i, sizeof i) == DS_OK); }
+  assert(hyperloglog_merge(&hll, &other) == DS_OK);
+  assert(fabs(hyperloglog_estimate(&hll) - SIZE * 2) < SIZE * 2 * 0.05);
+
+  // only sketches of the same precision and seed merge
+  struct hyperloglog coarse = hyperloglog_create(HYPERLOGLOG_MIN_PRECISION, 42);
+  struct hyperloglog reseeded = hyperloglog_create(0, 7);
+  assert(hyperloglog_merge(&hll, &coarse) == DS_ERROR);
+  assert(hyperloglog_merge(&hll, &reseeded) == DS_ERROR);
+
+  assert(hyperloglog_create(HYPERLOGLOG_MAX_PRECISION + 1, 0)._registers == NULL);
+  assert(hyperloglog_create(HYPERLOGLOG_MIN_PRECISION - 1, 0)._registers == NULL);
+
+  hyperloglog_clear(&hll);
+  assert(hyperloglog_estimate(&hll) == 0);
+
+  hyperloglog_destroy(&hll);
+  hyperloglog_destroy(&small);
+  hyperloglog_destroy(&other);
+  hyperloglog_destroy(&coarse);
+  hyperloglog_destroy(&reseeded);
+  assert(hyperloglog_add_hashed(&hll, 1) == DS_ERROR);
+}
+
+static void count_min_test(void) {
+  struct count_min sketch = count_min_create(2000, 5, 42);
+  assert(sketch._width == 2048);
+
+  // key `i` occurs `i % 10 + 1` times, the heavy hitter `SIZE` occurs `SIZE` times
+  uint64_t total = 0;
+  for (uint64_t i = 0; i < SIZE; i++) {
+    assert(count_min_add(&sketch, &i, sizeof i, i % 10 + 1) == DS_OK);
+    total += i % 10 + 1;
+  }
+  assert(count_min_add(&sketch, &(uint64_t){SIZE}, sizeof(uint64_t), SIZE) == DS_OK);
+  total += SIZE;
+  assert(count_min_total(&sketch) == total);
+
+  // never below the true count, and rarely above it by more than `e / width` of the total
+  size_t outliers = 0;
+  for (uint64_t i = 0; i < SIZE; i++) {
+    uint64_t estimate = count_min_estimate(&sketch, &i, sizeof i);
+    assert(estimate >= i % 10 + 1);
+    outliers += estimate > i % 10 + 1 + (uint64_t)(2.72 * (double)total / 2048);
+  }
+  assert(outliers < SIZE / 100);
+
+  uint64_t heavy = count_min_estimate(&sketch, &(uint64_t){SIZE}, sizeof(uint64_t));
+  assert(heavy >= SIZE && heavy < SIZE + total / 100);
+
+  // merging adds the counts up
+  struct count_min other = count_min_create(2048, 5, 42);
+  assert(count_min_add(&other, &(uint64_t){SIZE}, sizeof(uint64_t), 5) == DS_OK);
+  assert(count_min_merge(&sketch, &other) == DS_OK);
+  assert(count_min_total(&sketch) == total + 5);
+  assert(count_min_estimate(&sketch, &(uint64_t){SIZE}, sizeof(uint64_t)) == heavy + 5);
+
+  struct count_min shallow = count_min_create(2048, 4, 42);
+  assert(count_min_merge(&sketch, &shallow) == DS_ERROR);
+
+  count_min_clear(&sketch);
+  assert(count_min_total(&sketch) == 0);
+  assert(count_min_estimate(&sketch, &(uint64_t){SIZE}, sizeof(uint64_t)) == 0);
+
+  count_min_destroy(&sketch);
+  count_min_destroy(&other);
+  count_min_destroy(&shallow);
+  assert(count_min_add_hashed(&sketch, 1, 1) == DS_ERROR);
+  assert(count_min_create(0, 5, 0)._counters == NULL);
+}
+
+int main(void) {
+  hyperloglog_test();
+  count_min_test();
+}